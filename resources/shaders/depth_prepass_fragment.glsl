@@ -0,0 +1,6 @@
+#version 450 core
+
+void main()
+{
+    // Depth only, no colour targets are bound
+}
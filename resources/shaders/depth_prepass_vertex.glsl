@@ -0,0 +1,36 @@
+#version 450 core
+
+layout(std140, binding = 0) uniform TransformBlock {
+    mat4 projection;
+    mat4 view;
+};
+
+struct Instance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint bucket;
+    uint flags;
+};
+
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
+
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 3) in uint instanceIndex;
+
+// Must match mesh_deferred_vertex.glsl exactly, so the G-buffer's GL_EQUAL depth test passes
+invariant gl_Position;
+
+void main()
+{
+    Instance instance = instances[instanceIndex];
+    gl_Position = projection * view * instance.model * vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,60 @@
+#version 430 core
+
+#define WORKGROUP_SIZE 8
+
+// One invocation per destination texel
+layout(local_size_x = WORKGROUP_SIZE, local_size_y = WORKGROUP_SIZE) in;
+
+// The depth image for level 0, otherwise the pyramid itself
+layout(binding = 0) uniform sampler2D sourceTexture;
+
+layout(r32f, binding = 0) writeonly uniform image2D destinationImage;
+
+layout(std140, binding = 9) uniform HiZBlock {
+    ivec2 sourceSize;
+    ivec2 destinationSize;
+    // -1 copies level 0 of the depth image
+    int sourceLevel;
+};
+
+float fetchSource(ivec2 texel)
+{
+    return texelFetch(sourceTexture, min(texel, sourceSize - 1), max(sourceLevel, 0)).r;
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, destinationSize)))
+    {
+        return;
+    }
+
+    if (sourceLevel < 0)
+    {
+        imageStore(destinationImage, texel, vec4(fetchSource(texel)));
+        return;
+    }
+
+    ivec2 base = texel * 2;
+    float depth = max(max(fetchSource(base), fetchSource(base + ivec2(1, 0))),
+                      max(fetchSource(base + ivec2(0, 1)), fetchSource(base + ivec2(1, 1))));
+
+    // An odd source leaves a row or column with no texel of its own below, so the last texel takes it in
+    bool extraColumn = (sourceSize.x & 1) != 0 && texel.x == destinationSize.x - 1;
+    bool extraRow = (sourceSize.y & 1) != 0 && texel.y == destinationSize.y - 1;
+    if (extraColumn)
+    {
+        depth = max(depth, max(fetchSource(base + ivec2(2, 0)), fetchSource(base + ivec2(2, 1))));
+    }
+    if (extraRow)
+    {
+        depth = max(depth, max(fetchSource(base + ivec2(0, 2)), fetchSource(base + ivec2(1, 2))));
+    }
+    if (extraColumn && extraRow)
+    {
+        depth = max(depth, fetchSource(base + ivec2(2, 2)));
+    }
+
+    imageStore(destinationImage, texel, vec4(depth));
+}
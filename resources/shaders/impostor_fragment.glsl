@@ -0,0 +1,69 @@
+#version 450 core
+
+in vec2 fragmentFrameUV;
+in vec3 fragmentNearPosition;
+flat in vec3 fragmentDepthSpan;
+flat in vec2 fragmentFrame;
+flat in mat3 fragmentNormalMatrix;
+
+layout(location = 0) out vec4 fragColour;
+layout(location = 1) out vec2 fragNormal;
+
+layout(binding = 0) uniform sampler2D colorAtlas;
+layout(binding = 1) uniform sampler2D normalAtlas;
+layout(binding = 2) uniform sampler2D depthAtlas;
+
+layout(std140, binding = 0) uniform ImpostorBlock {
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    vec4 boundingSphere;
+    int frameCount;
+    int firstInstance;
+};
+
+// Unfolds an octahedral encoded normal, matching decodeNormal in mesh_deferred_vertex.glsl
+vec3 decodeNormal(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if(n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+// Matches encodeNormal in mesh_deferred_fragment.glsl
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    if(n.z < 0.0)
+    {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+
+    return n.xy * 0.5 + 0.5;
+}
+
+void main()
+{
+    vec2 atlasUV = (fragmentFrame + clamp(fragmentFrameUV, 0.0, 1.0)) / float(frameCount);
+
+    // Nothing was baked here, the frame is cleared to the far plane
+    float depth = texture(depthAtlas, atlasUV).r;
+    if(depth >= 1.0)
+    {
+        discard;
+    }
+
+    fragColour = texture(colorAtlas, atlasUV);
+
+    // Baked in model space, so the instance turns it into world space like a mesh normal
+    vec3 normal = decodeNormal(texture(normalAtlas, atlasUV).rg * 2.0 - 1.0);
+    fragNormal = encodeNormal(normalize(fragmentNormalMatrix * normal));
+
+    // The baked depth is linear across the sphere, so it places the surface along the frame's view direction.
+    // Lighting rebuilds positions from the depth buffer, so it must be the surface's and not the quad's
+    vec4 clip = viewProjection * vec4(fragmentNearPosition + fragmentDepthSpan * depth, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+}
@@ -0,0 +1,73 @@
+#version 450 core
+
+layout(std140, binding = 0) uniform ImpostorBlock {
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    // Model space, centre and radius
+    vec4 boundingSphere;
+    int frameCount;
+    int firstInstance;
+};
+
+struct ImpostorInstance
+{
+    mat4 model;
+    mat4 normalMatrix;
+};
+
+layout(std430, binding = 3) readonly buffer ImpostorBuffer {
+    ImpostorInstance impostors[];
+};
+
+// Position within the frame, [0, 1] across the quad
+out vec2 fragmentFrameUV;
+// World position of the quad on the near side of the sphere, where the baked depth is 0
+out vec3 fragmentNearPosition;
+// World offset from there to the far side of the sphere, where the baked depth is 1
+flat out vec3 fragmentDepthSpan;
+flat out vec2 fragmentFrame;
+flat out mat3 fragmentNormalMatrix;
+
+// Direction towards the viewer of the frame in the given cell of the hemi-octahedral grid.
+// Must match impostorFrameDirection in ImpostorBaker.cpp
+vec3 frameDirection(vec2 frame)
+{
+    vec2 cell = (frame + 0.5) / float(frameCount) * 2.0 - 1.0;
+    float x = 0.5 * (cell.x + cell.y);
+    float z = 0.5 * (cell.x - cell.y);
+    return normalize(vec3(x, 1.0 - abs(x) - abs(z), z));
+}
+
+void main()
+{
+    ImpostorInstance impostor = impostors[firstInstance + gl_InstanceID];
+    vec3 centre = boundingSphere.xyz;
+    float radius = boundingSphere.w;
+
+    // The transposed normal matrix is the inverse model matrix, which brings the camera into model space.
+    // Views from below the horizon fall back to the frames around it
+    vec3 worldCentre = vec3(impostor.model * vec4(centre, 1.0));
+    vec3 toCamera = transpose(mat3(impostor.normalMatrix)) * (cameraPosition.xyz - worldCentre);
+    toCamera.y = max(toCamera.y, 0.0);
+    toCamera /= max(abs(toCamera.x) + abs(toCamera.y) + abs(toCamera.z), 1e-6);
+
+    vec2 gridUV = vec2(toCamera.x + toCamera.z, toCamera.x - toCamera.z) * 0.5 + 0.5;
+    vec2 frame = min(floor(gridUV * float(frameCount)), vec2(frameCount - 1));
+
+    // The basis glm::lookAt built when the frame was baked
+    vec3 direction = frameDirection(frame);
+    vec3 right = normalize(cross(-direction, vec3(0.0, 1.0, 0.0)));
+    vec3 up = cross(right, -direction);
+
+    // Strip order, bottom left, bottom right, top left, top right
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 nearPosition = centre + direction * radius + (right * corner.x + up * corner.y) * radius;
+
+    fragmentFrameUV = corner * 0.5 + 0.5;
+    fragmentNearPosition = vec3(impostor.model * vec4(nearPosition, 1.0));
+    fragmentDepthSpan = mat3(impostor.model) * (-direction * 2.0 * radius);
+    fragmentFrame = frame;
+    fragmentNormalMatrix = mat3(impostor.normalMatrix);
+
+    gl_Position = viewProjection * vec4(fragmentNearPosition, 1.0);
+}
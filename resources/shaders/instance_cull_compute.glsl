@@ -0,0 +1,196 @@
+#version 430 core
+
+#define WORKGROUP_SIZE 64
+#define MAX_VIEWS 4
+
+// Must match GpuCuller::OcclusionTest
+#define OCCLUSION_NONE 0
+#define OCCLUSION_TEST 1
+#define OCCLUSION_RETEST 2
+
+// Must match the GpuInstance flags in InstanceBuffer.h
+#define INSTANCE_HIDDEN_FROM_CAMERA 1u
+#define INSTANCE_SPLIT_INTO_MESHLETS 2u
+
+// Marks an instance the occlusion test rejected, so the retest knows which instances are still undrawn
+#define OCCLUDED_BIT 0x80000000u
+
+// One invocation per instance
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+struct Instance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint bucket;
+    uint flags;
+};
+
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
+
+layout(std430, binding = 4) buffer ViewMaskBuffer {
+    uint viewMasks[];
+};
+
+layout(std430, binding = 5) readonly buffer BucketBuffer {
+    uint bucketFirstCommands[];
+};
+
+layout(std430, binding = 6) writeonly buffer CommandBuffer {
+    DrawCommand commands[];
+};
+
+layout(std430, binding = 7) buffer CounterBuffer {
+    uint bucketCounts[];
+};
+
+layout(std140, binding = 8) uniform CullBlock {
+    vec4 planes[MAX_VIEWS * 6];
+    mat4 occlusionViewProjection;
+    // Width, height and level count
+    vec4 hiZSize;
+    // w is 1 when meshlet cones are tested
+    vec4 viewerPosition;
+    uint viewCount;
+    uint instanceCount;
+    uint occlusionTest;
+    uint skipHiddenFromCamera;
+};
+
+// Farthest depth under each texel, level 0 matches the depth image
+layout(binding = 0) uniform sampler2D hiZTexture;
+
+bool sphereInFrustum(vec4 sphere, uint view)
+{
+    for (uint i = 0; i < 6; ++i)
+    {
+        vec4 plane = planes[view * 6 + i];
+        if (dot(plane.xyz, sphere.xyz) + plane.w < -sphere.w)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tests the sphere's bounding box against the pyramid level where it covers at most 2x2 texels
+bool sphereOccluded(vec4 sphere)
+{
+    vec2 minUV = vec2(1.0);
+    vec2 maxUV = vec2(0.0);
+    float nearestDepth = 1.0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = sphere.xyz + sphere.w * vec3((i & 1) != 0 ? 1.0 : -1.0,
+                                                   (i & 2) != 0 ? 1.0 : -1.0,
+                                                   (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = occlusionViewProjection * vec4(corner, 1.0);
+
+        // Bounds crossing the near plane have no finite screen rectangle
+        if (clip.w <= 0.0 || clip.z < -clip.w)
+        {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+        maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+        nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+    }
+
+    minUV = clamp(minUV, 0.0, 1.0);
+    maxUV = clamp(maxUV, 0.0, 1.0);
+
+    ivec2 minPixel = ivec2(minUV * hiZSize.xy);
+    ivec2 maxPixel = ivec2(maxUV * hiZSize.xy);
+    int extent = max(maxPixel.x - minPixel.x, maxPixel.y - minPixel.y);
+    int level = min(int(ceil(log2(float(max(extent, 1))))), int(hiZSize.z) - 1);
+
+    // Pixels past the last whole texel were folded into it when the level was built
+    ivec2 levelSize = max(ivec2(hiZSize.xy) >> level, ivec2(1));
+    ivec2 minTexel = min(minPixel >> level, levelSize - 1);
+    ivec2 maxTexel = min(maxPixel >> level, levelSize - 1);
+
+    float farthestDepth = max(max(texelFetch(hiZTexture, minTexel, level).r,
+                                  texelFetch(hiZTexture, ivec2(maxTexel.x, minTexel.y), level).r),
+                              max(texelFetch(hiZTexture, ivec2(minTexel.x, maxTexel.y), level).r,
+                                  texelFetch(hiZTexture, maxTexel, level).r));
+
+    return nearestDepth > farthestDepth;
+}
+
+void main()
+{
+    uint instanceIndex = gl_GlobalInvocationID.x;
+    if (instanceIndex >= instanceCount)
+    {
+        return;
+    }
+
+    // Instances the test let through were drawn already
+    if (occlusionTest == OCCLUSION_RETEST && (viewMasks[instanceIndex] & OCCLUDED_BIT) == 0)
+    {
+        return;
+    }
+
+    Instance instance = instances[instanceIndex];
+
+    uint mask = 0;
+    // Split meshes are drawn through their meshlets, which follow the draw commands' instances
+    bool hidden = (instance.flags & INSTANCE_SPLIT_INTO_MESHLETS) != 0
+                  || (skipHiddenFromCamera != 0 && (instance.flags & INSTANCE_HIDDEN_FROM_CAMERA) != 0);
+    for (uint view = 0; !hidden && view < viewCount; ++view)
+    {
+        if (sphereInFrustum(instance.boundingSphere, view))
+        {
+            mask |= 1u << view;
+        }
+    }
+
+    // Meshlets whose every triangle faces away from the viewer. Whole meshes have a cutoff no dot product reaches
+    if (mask != 0 && viewerPosition.w != 0.0
+        && dot(normalize(instance.coneApex.xyz - viewerPosition.xyz), instance.coneAxisCutoff.xyz) >= instance.coneAxisCutoff.w)
+    {
+        mask = 0;
+    }
+
+    if (mask != 0 && occlusionTest != OCCLUSION_NONE && sphereOccluded(instance.boundingSphere))
+    {
+        mask = occlusionTest == OCCLUSION_TEST ? OCCLUDED_BIT : 0;
+    }
+
+    viewMasks[instanceIndex] = mask;
+    if ((mask & ~OCCLUDED_BIT) == 0)
+    {
+        return;
+    }
+
+    // Survivors are packed to the front of their bucket's range, the rest of it stays zeroed
+    uint slot = atomicAdd(bucketCounts[instance.bucket], 1);
+
+    DrawCommand command;
+    command.count = instance.indexCount;
+    command.instanceCount = 1;
+    command.firstIndex = instance.firstIndex;
+    command.baseVertex = instance.baseVertex;
+    command.baseInstance = instanceIndex;
+    commands[bucketFirstCommands[instance.bucket] + slot] = command;
+}
@@ -0,0 +1,118 @@
+#version 430 core
+
+#define MAX_LIGHTS_PER_CLUSTER 256
+#define WORKGROUP_SIZE 128
+
+// One invocation per cluster, each workgroup shares the lights it tests through shared memory
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+struct PointLight
+{
+    vec4 positionAndRadius;
+    vec4 colorAndRange;
+    int shadowIndex;
+};
+
+layout(std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+layout(std430, binding = 1) writeonly buffer LightGridBuffer {
+    uint clusterLightCounts[];
+};
+
+layout(std430, binding = 2) writeonly buffer LightIndexBuffer {
+    uint clusterLightIndices[];
+};
+
+layout(std140, binding = 3) uniform ClusterBlock {
+    mat4 viewMatrix;
+    mat4 inverseProjection;
+    uvec4 gridSize;
+    vec4 screenSize;
+    float nearPlane;
+    float farPlane;
+    float sliceScale;
+    float sliceBias;
+    uint lightCount;
+};
+
+// View space position and range of the current batch of lights
+shared vec4 sharedLights[WORKGROUP_SIZE];
+
+vec3 screenToView(vec2 screenPosition)
+{
+    vec2 ndc = (screenPosition / screenSize.xy) * 2.0 - 1.0;
+    vec4 view = inverseProjection * vec4(ndc, -1.0, 1.0);
+    return view.xyz / view.w;
+}
+
+// Point along the ray from the eye through a point, at the given view space depth
+vec3 pointAtDepth(vec3 point, float depth)
+{
+    return point * (depth / point.z);
+}
+
+bool sphereIntersectsBox(vec3 center, float radius, vec3 boxMin, vec3 boxMax)
+{
+    vec3 closestPoint = clamp(center, boxMin, boxMax);
+    vec3 offset = closestPoint - center;
+    return dot(offset, offset) <= radius * radius;
+}
+
+void main()
+{
+    uint clusterIndex = gl_GlobalInvocationID.x;
+    uint clusterCount = gridSize.x * gridSize.y * gridSize.z;
+    bool isCluster = clusterIndex < clusterCount;
+
+    uint x = clusterIndex % gridSize.x;
+    uint y = (clusterIndex / gridSize.x) % gridSize.y;
+    uint z = clusterIndex / (gridSize.x * gridSize.y);
+
+    // Build the view space bounds of this froxel from its screen tile and exponential depth slice
+    vec2 tileSize = screenSize.xy / vec2(gridSize.xy);
+    vec3 tileMin = screenToView(vec2(x, y) * tileSize);
+    vec3 tileMax = screenToView(vec2(x + 1, y + 1) * tileSize);
+
+    float sliceNear = -nearPlane * pow(farPlane / nearPlane, float(z) / float(gridSize.z));
+    float sliceFar = -nearPlane * pow(farPlane / nearPlane, float(z + 1) / float(gridSize.z));
+
+    vec3 minNear = pointAtDepth(tileMin, sliceNear);
+    vec3 minFar = pointAtDepth(tileMin, sliceFar);
+    vec3 maxNear = pointAtDepth(tileMax, sliceNear);
+    vec3 maxFar = pointAtDepth(tileMax, sliceFar);
+
+    vec3 boxMin = min(min(minNear, minFar), min(maxNear, maxFar));
+    vec3 boxMax = max(max(minNear, minFar), max(maxNear, maxFar));
+
+    uint count = 0;
+    for (uint batchStart = 0; batchStart < lightCount; batchStart += WORKGROUP_SIZE)
+    {
+        uint lightIndex = batchStart + gl_LocalInvocationIndex;
+        if (lightIndex < lightCount)
+        {
+            vec4 viewPosition = viewMatrix * vec4(lights[lightIndex].positionAndRadius.xyz, 1.0);
+            sharedLights[gl_LocalInvocationIndex] = vec4(viewPosition.xyz, lights[lightIndex].colorAndRange.w);
+        }
+
+        barrier();
+
+        uint batchSize = min(uint(WORKGROUP_SIZE), lightCount - batchStart);
+        for (uint i = 0; isCluster && i < batchSize && count < MAX_LIGHTS_PER_CLUSTER; ++i)
+        {
+            if (sphereIntersectsBox(sharedLights[i].xyz, sharedLights[i].w, boxMin, boxMax))
+            {
+                clusterLightIndices[clusterIndex * MAX_LIGHTS_PER_CLUSTER + count] = batchStart + i;
+                ++count;
+            }
+        }
+
+        barrier();
+    }
+
+    if (isCluster)
+    {
+        clusterLightCounts[clusterIndex] = count;
+    }
+}
@@ -2,37 +2,78 @@
 
 struct PointLight
 {
-    vec3 position;
-    vec3 color;
-    float radius;
+    vec4 positionAndRadius;
+    vec4 colorAndRange;
+    int shadowIndex;
 };
 
 in vec2 fragmentTextureUV;
 
 layout(binding = 0) uniform sampler2D colorTexture;
 layout(binding = 1) uniform sampler2D normalTexture;
-layout(binding = 2) uniform sampler2D positionTexture;
-layout(binding = 3) uniform sampler2DShadow directionalShadowMap;
+layout(binding = 2) uniform sampler2D depthTexture;
+layout(binding = 3) uniform sampler2DArrayShadow directionalShadowMap;
 layout(binding = 4) uniform samplerCubeArray pointLightShadowMap;
 
+#define CASCADE_COUNT 4
 layout(std140, binding = 5) uniform DirectionalLightBlock {
     vec3 dirLightDirection;
+    int shadePointLights;
     vec4 dirLightDiffuseColor;
-    mat4 dirLightSpaceMatrix;
+    mat4 cascadeLightSpaceMatrices[CASCADE_COUNT];
+    vec4 cascadeSplitDepths;
+    vec4 cascadeDepthBiases;
+    vec4 cameraPosition;
+    vec4 cameraFront;
 };
 
-layout(std140, binding = 6) uniform FarPlaneBlock {
+layout(std140, binding = 6) uniform ClusterBlock {
+    mat4 viewMatrix;
+    mat4 inverseProjection;
+    uvec4 gridSize;
+    vec4 screenSize;
+    float nearPlane;
     float farPlane;
+    float sliceScale;
+    float sliceBias;
+    uint lightCount;
 };
 
-#define MAX_POINT_LIGHTS 32
-layout(std140, binding = 7) uniform PointLightBlock {
-    int numberOfPointLights;
-    PointLight pointLights[MAX_POINT_LIGHTS];
+#define MAX_LIGHTS_PER_CLUSTER 256
+layout(std430, binding = 0) readonly buffer LightBuffer {
+    PointLight pointLights[];
+};
+
+layout(std430, binding = 1) readonly buffer LightGridBuffer {
+    uint clusterLightCounts[];
+};
+
+layout(std430, binding = 2) readonly buffer LightIndexBuffer {
+    uint clusterLightIndices[];
+};
+
+layout(std140, binding = 7) uniform CameraBlock {
+    mat4 inverseViewProjection;
 };
 
 out vec4 FragColor;
 
+// Inverse of encodeNormal in mesh_deferred_fragment.glsl
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+vec3 reconstructWorldPosition(vec2 textureUV, float depth)
+{
+    vec4 worldPosition = inverseViewProjection * vec4(vec3(textureUV, depth) * 2.0 - 1.0, 1.0);
+    return worldPosition.xyz / worldPosition.w;
+}
+
 void main()
 {
     // Sample the G-buffer textures
@@ -45,37 +86,59 @@ void main()
     }
 
     vec3 color = texels.rgb;
-    vec3 normal = normalize(texture(normalTexture, fragmentTextureUV).rgb);
-
-    // Normalize the normal vector
+    vec3 normal = decodeNormal(texture(normalTexture, fragmentTextureUV).rg);
 
     // Calculate diffuse lighting
     vec3 lightDir = normalize(-dirLightDirection);
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = diff * dirLightDiffuseColor.rgb * color;
 
-    // Calculate directional light shadows
-    // Convert fragment position into light space
-    vec3 fragmentWorldPos = texture(positionTexture, fragmentTextureUV).xyz;
-    vec4 fragmentPositionInLightSpace = dirLightSpaceMatrix * vec4(fragmentWorldPos, 1.0);
-
-    // Project light space fragment position into UV coordinates ([0, 1]) to lookup on shadow map texture
-    vec3 projectedCoords = fragmentPositionInLightSpace.xyz / fragmentPositionInLightSpace.w;
-    projectedCoords = projectedCoords * 0.5 + 0.5;
-    float bias = max(0.005 * (1.0 - dot(normal, lightDir)), 0.005);
-    projectedCoords.z -= bias;
-    
-    float shadow = texture(directionalShadowMap, projectedCoords.xyz);
+    // Calculate directional light shadows, from the first cascade whose slice of the view contains the fragment
+    vec3 fragmentWorldPos = reconstructWorldPosition(fragmentTextureUV, texture(depthTexture, fragmentTextureUV).r);
+    float viewDepth = dot(fragmentWorldPos - cameraPosition.xyz, cameraFront.xyz);
+
+    float shadow = 1.0;
+    for(int cascade = 0; cascade < CASCADE_COUNT; ++cascade)
+    {
+        if(viewDepth > cascadeSplitDepths[cascade])
+        {
+            continue;
+        }
+
+        // Convert fragment position into light space
+        vec4 fragmentPositionInLightSpace = cascadeLightSpaceMatrices[cascade] * vec4(fragmentWorldPos, 1.0);
+
+        // Project light space fragment position into UV coordinates ([0, 1]) to lookup on shadow map texture
+        vec3 projectedCoords = fragmentPositionInLightSpace.xyz / fragmentPositionInLightSpace.w;
+        projectedCoords = projectedCoords * 0.5 + 0.5;
+        float bias = cascadeDepthBiases[cascade] * (1.0 + 2.0 * (1.0 - dot(normal, lightDir)));
+        projectedCoords.z -= bias;
+
+        shadow = texture(directionalShadowMap, vec4(projectedCoords.xy, cascade, projectedCoords.z));
+        break;
+    }
     diffuse *= shadow;
 
-    // Calculate point light contributions
+    // Find the cluster of this pixel, from its screen tile and exponential depth slice
+    float clusterDepth = -(viewMatrix * vec4(fragmentWorldPos, 1.0)).z;
+    uint slice = uint(max(log(clusterDepth) * sliceScale - sliceBias, 0.0));
+    slice = min(slice, gridSize.z - 1);
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / (screenSize.xy / vec2(gridSize.xy))), gridSize.xy - 1);
+    uint clusterIndex = tile.x + gridSize.x * (tile.y + gridSize.y * slice);
+
+    // Calculate point light contributions, from only the lights assigned to this cluster.
+    // Skipped when the point lights are added afterwards by their light volumes instead
     vec3 totalPointLightColor = vec3(0.0);
 
-    for(int i = 0; i < numberOfPointLights; ++i)
+    uint clusterLightCount = (shadePointLights != 0) ? clusterLightCounts[clusterIndex] : 0;
+    for(uint lightSlot = 0; lightSlot < clusterLightCount; ++lightSlot)
     {
-        vec3 lightPos = pointLights[i].position;
-        vec3 lightColor = pointLights[i].color;
-        float lightRadius = pointLights[i].radius;
+        uint i = clusterLightIndices[clusterIndex * MAX_LIGHTS_PER_CLUSTER + lightSlot];
+
+        vec3 lightPos = pointLights[i].positionAndRadius.xyz;
+        vec3 lightColor = pointLights[i].colorAndRange.rgb;
+        float lightRadius = pointLights[i].positionAndRadius.w;
+        float lightRange = pointLights[i].colorAndRange.w;
 
         // Direction from fragment to the light
         vec3 fragmentToLight = normalize(lightPos - fragmentWorldPos);
@@ -84,22 +147,27 @@ void main()
         float lightFactor = max(dot(normal, fragmentToLight), 0.0);
         vec3 pointLightDiffuse = lightFactor * lightColor * color;
 
-        // Calculate fall-off (decrease intensity with distance by inverse square law) up to the lights radius
-        float attenuation = 1.0 / (1.0 + (distanceToLight / lightRadius) * (distanceToLight / lightRadius));
-
-        // Calculate shadow
-        vec3 lightToFragment = normalize(fragmentWorldPos - lightPos);
-        float lightDepth = length(fragmentWorldPos - lightPos);
-
-        // Sample the shadow cube map
-        float closestDepth = texture(pointLightShadowMap, vec4(lightToFragment, i)).r * farPlane;
-
-        // Adjust bias based on angle
-        float pointlightBias = max(0.05 * (1.0 - dot(normal, lightToFragment)), 0.005);
-        float pointLightShadow = 1.0; //(lightDepth - pointlightBias > closestDepth) ? 1.0 : 0.0;
-
-        //totalPointLightColor += (1.0 - pointLightShadow) * pointLightDiffuse * attenuation;
-        totalPointLightColor += pointLightDiffuse * attenuation;
+        // Calculate fall-off (decrease intensity with distance by inverse square law) up to the lights radius,
+        // windowed so it reaches zero at the light's range and lights outside a cluster contribute nothing
+        float rangeFraction = distanceToLight / lightRange;
+        float window = clamp(1.0 - rangeFraction * rangeFraction * rangeFraction * rangeFraction, 0.0, 1.0);
+        float attenuation = (window * window) / (1.0 + (distanceToLight / lightRadius) * (distanceToLight / lightRadius));
+
+        // Calculate shadow, for lights that have a shadow cube and fragments within its range
+        float pointLightShadow = 0.0;
+        int shadowIndex = pointLights[i].shadowIndex;
+        if(shadowIndex >= 0 && distanceToLight < lightRange)
+        {
+            // Sample the shadow cube map
+            vec3 lightToFragment = -fragmentToLight;
+            float closestDepth = texture(pointLightShadowMap, vec4(lightToFragment, shadowIndex)).r * lightRange;
+
+            // Adjust bias based on angle
+            float pointlightBias = max(0.05 * (1.0 - dot(normal, fragmentToLight)), 0.005);
+            pointLightShadow = (distanceToLight - pointlightBias > closestDepth) ? 1.0 : 0.0;
+        }
+
+        totalPointLightColor += (1.0 - pointLightShadow) * pointLightDiffuse * attenuation;
     }
 
     // Final color calculation
@@ -0,0 +1,96 @@
+#version 430 core
+
+struct PointLight
+{
+    vec4 positionAndRadius;
+    vec4 colorAndRange;
+    int shadowIndex;
+};
+
+flat in int lightIndex;
+
+layout(binding = 0) uniform sampler2D colorTexture;
+layout(binding = 1) uniform sampler2D normalTexture;
+layout(binding = 2) uniform sampler2D depthTexture;
+layout(binding = 3) uniform samplerCubeArray pointLightShadowMap;
+
+layout(std140, binding = 4) uniform VolumeBlock {
+    mat4 projection;
+    mat4 view;
+    mat4 inverseViewProjection;
+    vec4 screenSize;
+};
+
+layout(std430, binding = 0) readonly buffer LightBuffer {
+    PointLight pointLights[];
+};
+
+out vec4 FragColor;
+
+// Inverse of encodeNormal in mesh_deferred_fragment.glsl
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+vec3 reconstructWorldPosition(vec2 textureUV, float depth)
+{
+    vec4 worldPosition = inverseViewProjection * vec4(vec3(textureUV, depth) * 2.0 - 1.0, 1.0);
+    return worldPosition.xyz / worldPosition.w;
+}
+
+void main()
+{
+    // The volume is drawn over the G-buffer, so look it up at this pixel
+    vec2 textureUV = gl_FragCoord.xy / screenSize.xy;
+
+    vec4 texels = texture(colorTexture, textureUV);
+    if(texels.a < 0.1)
+    {
+        discard;
+    }
+
+    vec3 fragmentWorldPos = reconstructWorldPosition(textureUV, texture(depthTexture, textureUV).r);
+
+    vec3 lightPos = pointLights[lightIndex].positionAndRadius.xyz;
+    float lightRadius = pointLights[lightIndex].positionAndRadius.w;
+    vec3 lightColor = pointLights[lightIndex].colorAndRange.rgb;
+    float lightRange = pointLights[lightIndex].colorAndRange.w;
+
+    // The volume's faces lie a little outside the sphere, so the stencil lets through a thin shell beyond the range
+    float distanceToLight = length(lightPos - fragmentWorldPos);
+    if(distanceToLight >= lightRange)
+    {
+        discard;
+    }
+
+    vec3 color = texels.rgb;
+    vec3 normal = decodeNormal(texture(normalTexture, textureUV).rg);
+    vec3 fragmentToLight = normalize(lightPos - fragmentWorldPos);
+
+    float lightFactor = max(dot(normal, fragmentToLight), 0.0);
+    vec3 pointLightDiffuse = lightFactor * lightColor * color;
+
+    // Same windowed fall-off as the clustered path in lighting_deferred_fragment.glsl
+    float rangeFraction = distanceToLight / lightRange;
+    float window = clamp(1.0 - rangeFraction * rangeFraction * rangeFraction * rangeFraction, 0.0, 1.0);
+    float attenuation = (window * window) / (1.0 + (distanceToLight / lightRadius) * (distanceToLight / lightRadius));
+
+    float pointLightShadow = 0.0;
+    int shadowIndex = pointLights[lightIndex].shadowIndex;
+    if(shadowIndex >= 0)
+    {
+        vec3 lightToFragment = -fragmentToLight;
+        float closestDepth = texture(pointLightShadowMap, vec4(lightToFragment, shadowIndex)).r * lightRange;
+
+        float pointlightBias = max(0.05 * (1.0 - dot(normal, fragmentToLight)), 0.005);
+        pointLightShadow = (distanceToLight - pointlightBias > closestDepth) ? 1.0 : 0.0;
+    }
+
+    // Added to the directional lighting already in the scene colour, leaving its alpha for the skybox
+    FragColor = vec4((1.0 - pointLightShadow) * pointLightDiffuse * attenuation, 0.0);
+}
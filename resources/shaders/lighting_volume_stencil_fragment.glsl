@@ -0,0 +1,6 @@
+#version 430 core
+
+void main()
+{
+    // Only the stencil is written while marking the light volumes
+}
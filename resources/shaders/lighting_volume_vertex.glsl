@@ -0,0 +1,35 @@
+#version 430 core
+
+struct PointLight
+{
+    vec4 positionAndRadius;
+    vec4 colorAndRange;
+    int shadowIndex;
+};
+
+layout(location = 0) in vec3 vertexPosition;
+// The light's index, each volume is drawn on its own with its light as the base instance
+layout(location = 1) in uint instanceLightIndex;
+
+layout(std140, binding = 4) uniform VolumeBlock {
+    mat4 projection;
+    mat4 view;
+    mat4 inverseViewProjection;
+    vec4 screenSize;
+};
+
+layout(std430, binding = 0) readonly buffer LightBuffer {
+    PointLight pointLights[];
+};
+
+flat out int lightIndex;
+
+void main()
+{
+    // The unit sphere scaled to cover the light's range
+    vec3 lightPos = pointLights[instanceLightIndex].positionAndRadius.xyz;
+    float lightRange = pointLights[instanceLightIndex].colorAndRange.w;
+
+    lightIndex = int(instanceLightIndex);
+    gl_Position = projection * view * vec4(lightPos + vertexPosition * lightRange, 1.0);
+}
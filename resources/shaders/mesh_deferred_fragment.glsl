@@ -1,13 +1,15 @@
 #version 430 core
 
-in vec3 fragmentPosition;
 in vec2 fragmentTextureUV;
 in vec3 fragmentNormal;
 
 layout(location = 0) out vec4 fragColour;
-layout(location = 1) out vec3 fragNormal;
-layout(location = 2) out vec3 fragPosition;
-out float fragDepth;
+layout(location = 1) out vec2 fragNormal;
+
+#ifdef COUNT_OVERDRAW
+// Blended additively, so each pixel ends up holding the number of fragments shaded there
+layout(location = 2) out float fragOverdraw;
+#endif
 
 layout(binding = 1) uniform sampler2D diffuseTexture;
 
@@ -16,6 +18,20 @@ layout(std140, binding = 2) uniform MaterialBlock {
     vec4 diffuseColour;      // offset 16
 } material;
 
+// Octahedral encoding, folding the unit sphere onto a square so a normal fits in two channels.
+// Must match decodeNormal in the lighting shaders
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    if(n.z < 0.0)
+    {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+
+    // Stored in an unsigned normalised target
+    return n.xy * 0.5 + 0.5;
+}
 
 void main()
 {
@@ -28,11 +44,10 @@ void main()
         fragColour = material.diffuseColour;
     }
 
-    // Output the normal (in view space)
-    fragNormal = normalize(fragmentNormal);
-
-    // Output the depth (using the built-in gl_FragCoord.z)
-    fragDepth = gl_FragCoord.z;
+    // Output the world space normal. The position is not stored, lighting rebuilds it from the depth buffer
+    fragNormal = encodeNormal(normalize(fragmentNormal));
 
-    fragPosition = fragmentPosition;
+#ifdef COUNT_OVERDRAW
+    fragOverdraw = 1.0;
+#endif
 }
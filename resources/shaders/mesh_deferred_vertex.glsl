@@ -3,25 +3,57 @@
 layout(std140, binding = 0) uniform TransformBlock {
     mat4 projection;
     mat4 view;
+    int octahedralNormals;
+};
+
+struct Instance
+{
     mat4 model;
+    mat4 normalMatrix;
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint bucket;
+    uint flags;
+};
+
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    Instance instances[];
 };
 
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec2 vertexTextureUV;
 layout (location = 2) in vec3 vertexNormal;
+// Index of the draw's instance, fed by InstanceBuffer
+layout (location = 3) in uint instanceIndex;
 
-out vec3 fragmentPosition;
 out vec2 fragmentTextureUV;
 out vec3 fragmentNormal;
 
-void main()
+// Must match depth_prepass_vertex.glsl exactly, so the GL_EQUAL depth test passes after a pre-pass
+invariant gl_Position;
+
+// Unfolds an octahedral encoded normal, matching encodeOctahedral in MeshBuffer.cpp
+vec3 decodeNormal(vec2 encoded)
 {
-    // Calculate the fragment position in world space
-    fragmentPosition = vec3(model * vec4(vertexPosition, 1.0));
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
 
-    gl_Position = projection * view * model * vec4(vertexPosition, 1.0);
+void main()
+{
+    Instance instance = instances[instanceIndex];
+    gl_Position = projection * view * instance.model * vec4(vertexPosition, 1.0);
 
     // Pass normal and texture coordinates to fragment shader
-    fragmentNormal = mat3(transpose(inverse(model))) * vertexNormal;
+    vec3 normal = octahedralNormals != 0 ? decodeNormal(vertexNormal.xy) : vertexNormal;
+    fragmentNormal = mat3(instance.normalMatrix) * normal;
     fragmentTextureUV = vertexTextureUV;
 }
@@ -1,18 +1,26 @@
 #version 430 core
 
-in vec4 fragmentPositionLightSpace;
+#define MAX_SHADOW_LIGHTS_PER_BATCH 16
+
 in vec3 fragmentPositionWorld;
+flat in int fragmentLightIndex;
 
-layout(std140, binding = 1) uniform LightPositionBlock {
-    vec3 lightPosition;
+struct ShadowLight {
+    vec4 positionAndFarPlane;
+    mat4 faceMatrices[6];
+    int cubeIndex;
+    int faceMask;
 };
 
-layout(std140, binding = 2) uniform FarPlaneBlock {
-    float farPlane;
+layout(std140, binding = 1) uniform PointLightShadowBlock {
+    ShadowLight lights[MAX_SHADOW_LIGHTS_PER_BATCH];
 };
 
 void main()
 {
+    vec3 lightPosition = lights[fragmentLightIndex].positionAndFarPlane.xyz;
+    float farPlane = lights[fragmentLightIndex].positionAndFarPlane.w;
+
     float lightDistance = length(fragmentPositionWorld - lightPosition);
     lightDistance = lightDistance / farPlane;
     gl_FragDepth = lightDistance;  // Store radial depth in depth buffer
@@ -0,0 +1,71 @@
+#version 430 core
+
+#define MAX_SHADOW_LIGHTS_PER_BATCH 16
+
+// One invocation per cube face
+layout(triangles, invocations = 6) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+struct ShadowLight {
+    vec4 positionAndFarPlane;
+    mat4 faceMatrices[6];
+    int cubeIndex;
+    int faceMask;
+};
+
+layout(std140, binding = 1) uniform PointLightShadowBlock {
+    ShadowLight lights[MAX_SHADOW_LIGHTS_PER_BATCH];
+};
+
+flat in int vertexLightIndex[];
+
+out vec3 fragmentPositionWorld;
+flat out int fragmentLightIndex;
+
+void main()
+{
+    int lightIndex = vertexLightIndex[0];
+    int face = gl_InvocationID;
+
+    // Faces not scheduled this frame keep their previous contents
+    if ((lights[lightIndex].faceMask & (1 << face)) == 0)
+    {
+        return;
+    }
+
+    vec4 clipPositions[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        clipPositions[i] = lights[lightIndex].faceMatrices[face] * gl_in[i].gl_Position;
+    }
+
+    // Skip triangles entirely outside one of this face's frustum planes
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (clipPositions[0][axis] > clipPositions[0].w &&
+            clipPositions[1][axis] > clipPositions[1].w &&
+            clipPositions[2][axis] > clipPositions[2].w)
+        {
+            return;
+        }
+
+        if (clipPositions[0][axis] < -clipPositions[0].w &&
+            clipPositions[1][axis] < -clipPositions[1].w &&
+            clipPositions[2][axis] < -clipPositions[2].w)
+        {
+            return;
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        // Cube map array layers are addressed as (6 * cube) + face
+        gl_Layer = (6 * lights[lightIndex].cubeIndex) + face;
+        gl_Position = clipPositions[i];
+        fragmentPositionWorld = gl_in[i].gl_Position.xyz;
+        fragmentLightIndex = lightIndex;
+        EmitVertex();
+    }
+
+    EndPrimitive();
+}
@@ -1,20 +1,32 @@
 #version 430 core
 
 layout (location = 0) in vec3 vertexPosition;
+// Constant across a draw's instances, which are the lights rather than copies of the mesh
+layout (location = 3) in uint instanceIndex;
 
-layout(std140, binding = 0) uniform LightTransformBlock {
-    mat4 lightSpaceMatrix;
-    mat4 modelMatrix;
+struct Instance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint bucket;
+    uint flags;
 };
 
-out vec4 fragmentPositionLightSpace;
-out vec3 fragmentPositionWorld;
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
 
+// One instance is drawn per light being rendered
+flat out int vertexLightIndex;
 
 void main()
 {
-    fragmentPositionLightSpace = lightSpaceMatrix * modelMatrix * vec4(vertexPosition, 1.0);
-    gl_Position = fragmentPositionLightSpace;
-
-    fragmentPositionWorld = (modelMatrix * vec4(vertexPosition, 1.0)).xyz;
+    gl_Position = instances[instanceIndex].model * vec4(vertexPosition, 1.0);
+    vertexLightIndex = gl_InstanceID;
 }
@@ -0,0 +1,38 @@
+#version 430 core
+
+#define CASCADE_COUNT 4
+
+// One invocation per cascade
+layout(triangles, invocations = CASCADE_COUNT) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+// Bit per cascade for each instance, set by the CPU or the culling shader
+layout(std430, binding = 4) readonly buffer ViewMaskBuffer {
+    uint cascadeMasks[];
+};
+
+flat in uint vertexInstanceIndex[];
+
+layout(std140, binding = 1) uniform CascadeBlock {
+    mat4 lightSpaceMatrices[CASCADE_COUNT];
+};
+
+void main()
+{
+    int cascade = gl_InvocationID;
+
+    // Casters were culled per cascade before drawing
+    if ((cascadeMasks[vertexInstanceIndex[0]] & (1u << cascade)) == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        gl_Layer = cascade;
+        gl_Position = lightSpaceMatrices[cascade] * gl_in[i].gl_Position;
+        EmitVertex();
+    }
+
+    EndPrimitive();
+}
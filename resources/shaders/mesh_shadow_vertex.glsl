@@ -1,13 +1,30 @@
 #version 430 core
 
 layout (location = 0) in vec3 vertexPosition;
+layout (location = 3) in uint instanceIndex;
 
-layout(std140, binding = 0) uniform LightTransformBlock {
-    mat4 lightSpaceMatrix;
-    mat4 modelMatrix;
+struct Instance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 boundingSphere;
+    vec4 coneApex;
+    vec4 coneAxisCutoff;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint bucket;
+    uint flags;
+};
+
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    Instance instances[];
 };
 
+flat out uint vertexInstanceIndex;
+
 void main()
 {
-    gl_Position = lightSpaceMatrix * modelMatrix * vec4(vertexPosition, 1.0);
+    gl_Position = instances[instanceIndex].model * vec4(vertexPosition, 1.0);
+    vertexInstanceIndex = instanceIndex;
 }
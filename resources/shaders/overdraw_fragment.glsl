@@ -0,0 +1,27 @@
+#version 430 core
+
+in vec2 fragmentTextureUV;
+
+layout(binding = 0) uniform sampler2D overdrawTexture;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Number of G-buffer fragments shaded at this pixel
+    float count = texture(overdrawTexture, fragmentTextureUV).r;
+    if(count < 0.5)
+    {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    // Blue for a single shade, through green and yellow, to red at 4 or more
+    const vec3 heat[4] = vec3[](vec3(0.0, 0.2, 1.0), vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+
+    float level = clamp(count - 1.0, 0.0, 3.0);
+    int lower = int(floor(level));
+    int upper = min(lower + 1, 3);
+
+    FragColor = vec4(mix(heat[lower], heat[upper], level - float(lower)), 1.0);
+}
@@ -3,15 +3,20 @@
 
 #include "Application.h"
 
+#include "application/LightingBenchmark.h"
+#include "application/SubmissionBenchmark.h"
 #include "application/Window.h"
 #include "core/FileSystem.h"
 #include "input/InputHandler.h"
 #include "loaders/SceneLoader.h"
+#include "rendering/GlStateCache.h"
 #include "rendering/Renderer.h"
+#include "rendering/ShadowScheduler.h"
 #include "scripting/LuaState.h"
 #include "world/systems/BehaviourSystem.h"
 #include "world/systems/LightingSystem.h"
 #include "world/systems/RenderSystem.h"
+#include "world/systems/TerrainSystem.h"
 #include "world/World.h"
 
 #include <glad/gl.h>
@@ -44,11 +49,22 @@ Application::Application()
     m_renderSystem = std::make_unique<RenderSystem>(*m_renderer, *m_world);
     m_behaviourSystem = std::make_unique<BehaviourSystem>(*m_inputHandler, *m_world);
     m_lightingSystem = std::make_unique<LightingSystem>(*m_renderer, *m_world);
+    m_terrainSystem = std::make_unique<TerrainSystem>(*m_renderer, *m_world);
+    m_lightingBenchmark = std::make_unique<LightingBenchmark>(*m_renderer);
+    m_submissionBenchmark = std::make_unique<SubmissionBenchmark>(*m_renderer);
 
     // Demo scene
-    loadScene(GetResourceDir() / "scenes/demo.json", m_assetDb, *m_world, *m_lua);
-    m_renderer->setAssets(m_assetDb);
+    loadScene(GetResourceDir() / "scenes/demo.json", m_assetDb, *m_world, *m_lua, m_sceneSettings);
+    m_renderer->setAssets(m_assetDb, m_sceneSettings.quantiseVertices ? VertexFormat::Quantised : VertexFormat::Float);
+    m_renderer->setDepthPrePass(m_sceneSettings.depthPrePass);
+    m_renderer->setGpuCulling(m_sceneSettings.gpuCulling);
+    m_renderer->setOcclusionCulling(m_sceneSettings.occlusionCulling);
+    m_renderSystem->setOcclusionCulling(m_sceneSettings.cpuOcclusionCulling);
+    m_renderSystem->setImpostorScreenSize(m_sceneSettings.impostorScreenSize);
+    m_renderSystem->setHlodDistance(m_sceneSettings.hlodDistance);
     m_behaviourSystem->init();
+
+    std::cout << m_renderer->renderGraphDump();
 }
 
 Application::~Application() = default;
@@ -74,6 +90,11 @@ void Application::run()
             const auto fps = framesSinceLastFpsUpdate / deltaTimeSinceLastFpsUpdate;
             m_window->setFpsCounter(fps);
 
+            if(m_printFrameStats)
+            {
+                printFrameStats();
+            }
+
             framesSinceLastFpsUpdate = 0;
             lastFpsUpdate = frameStartTime;
         }
@@ -85,8 +106,11 @@ void Application::run()
         m_renderer->beginFrame();
 
         m_lightingSystem->update();
+        m_lightingBenchmark->update();
 
+        m_terrainSystem->update();
         m_renderSystem->update();
+        m_submissionBenchmark->update();
 
         for(auto& [entity, cameraComponent] : m_world->getAllComponents<CameraComponent>())
         {
@@ -219,11 +243,84 @@ void Application::mouseButtonPressCallback(int button, int action, int modifiers
 {
 }
 
+void Application::printFrameStats()
+{
+    const auto& glStats = GlStateCache::instance().lastFrameStats();
+    std::cout << "GL state calls per frame: " << glStats.issued << " issued, " << glStats.filtered << " filtered\n";
+
+    auto passTimes = std::string{};
+    for(const auto& timing : m_renderer->passTimings())
+    {
+        passTimes += (passTimes.empty() ? "" : ", ") + timing.name + " " + std::to_string(timing.gpuMilliseconds);
+    }
+    std::cout << "GPU ms per pass: " << passTimes << "\n";
+
+    const auto& shadowStats = m_renderer->pointLightShadowScheduler().stats();
+    std::cout << "Point shadow faces: " << shadowStats.scheduledFaces << "/" << shadowStats.budget << " scheduled for "
+              << shadowStats.scheduledLights << " of " << shadowStats.staleLights << " stale lights, "
+              << shadowStats.deferredFaces << " deferred\n";
+
+    if(m_renderSystem->occlusionCulling())
+    {
+        const auto& occlusionStats = m_renderSystem->occlusionStats();
+        std::cout << "CPU occlusion: " << occlusionStats.hiddenEntities << "/" << occlusionStats.testedEntities
+                  << " entities hidden by " << occlusionStats.occluderTriangles << " triangles in "
+                  << occlusionStats.milliseconds << " ms\n";
+    }
+}
+
 void Application::keyPressCallback(int key, int scancode, int action, int mods)
 {
     if(action == GLFW_PRESS)
     {
         m_inputHandler->setKeyPressed(key);
+
+        // L switches the point light shading, B benchmarks both modes,
+        // P switches the depth pre-pass, O shows the G-buffer overdraw, G switches GPU culling,
+        // H switches occlusion culling, C switches CPU occlusion culling and M benchmarks draw submission
+        if(key == GLFW_KEY_L && !m_lightingBenchmark->running())
+        {
+            const auto useLightVolumes = m_renderer->pointLightShading() == PointLightShading::Clustered;
+            m_renderer->setPointLightShading(useLightVolumes ? PointLightShading::LightVolumes : PointLightShading::Clustered);
+            std::cout << "Point light shading: " << (useLightVolumes ? "light volumes" : "clustered") << "\n";
+        }
+        else if(key == GLFW_KEY_B)
+        {
+            m_lightingBenchmark->start();
+        }
+        else if(key == GLFW_KEY_P)
+        {
+            m_renderer->setDepthPrePass(!m_renderer->depthPrePass());
+            std::cout << "Depth pre-pass: " << (m_renderer->depthPrePass() ? "on" : "off") << "\n";
+        }
+        else if(key == GLFW_KEY_O)
+        {
+            m_renderer->setOverdrawVisualisation(!m_renderer->overdrawVisualisation());
+        }
+        else if(key == GLFW_KEY_G)
+        {
+            m_renderer->setGpuCulling(!m_renderer->gpuCulling());
+            std::cout << "GPU culling: " << (m_renderer->gpuCulling() ? "on" : "off") << "\n";
+        }
+        else if(key == GLFW_KEY_H)
+        {
+            m_renderer->setOcclusionCulling(!m_renderer->occlusionCulling());
+            std::cout << "Occlusion culling: " << (m_renderer->occlusionCulling() ? "on" : "off") << "\n";
+        }
+        else if(key == GLFW_KEY_C)
+        {
+            m_renderSystem->setOcclusionCulling(!m_renderSystem->occlusionCulling());
+            std::cout << "CPU occlusion culling: " << (m_renderSystem->occlusionCulling() ? "on" : "off") << "\n";
+        }
+        else if(key == GLFW_KEY_M)
+        {
+            m_submissionBenchmark->start();
+        }
+        else if(key == GLFW_KEY_T)
+        {
+            m_printFrameStats = !m_printFrameStats;
+            std::cout << "Frame stats: " << (m_printFrameStats ? "on" : "off") << "\n";
+        }
     }
     else if(action == GLFW_RELEASE)
     {
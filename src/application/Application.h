@@ -4,15 +4,19 @@
 #pragma once
 
 #include "data/AssetDatabase.h"
+#include "data/SceneSettings.h"
 
 #include <memory>
 
 class BehaviourSystem;
 class InputHandler;
+class LightingBenchmark;
 class LightingSystem;
 class LuaState;
 class Renderer;
 class RenderSystem;
+class SubmissionBenchmark;
+class TerrainSystem;
 class Window;
 class World;
 
@@ -39,6 +43,9 @@ class Application
         void cursorPosChangeCallback(double x, double y);
         void mouseButtonPressCallback(int button, int action, int modifiers);
         void keyPressCallback(int key, int scancode, int action, int mods);
+
+        // Renderer and culling stats, printed once a second while toggled on with T
+        void printFrameStats();
         
     private:
         std::unique_ptr<Window> m_window{nullptr};
@@ -49,6 +56,11 @@ class Application
         std::unique_ptr<RenderSystem> m_renderSystem{nullptr};
         std::unique_ptr<BehaviourSystem> m_behaviourSystem{nullptr};
         std::unique_ptr<LightingSystem> m_lightingSystem{nullptr};
+        std::unique_ptr<TerrainSystem> m_terrainSystem{nullptr};
+        std::unique_ptr<LightingBenchmark> m_lightingBenchmark{nullptr};
+        std::unique_ptr<SubmissionBenchmark> m_submissionBenchmark{nullptr};
         
         AssetDatabase m_assetDb;
+        SceneSettings m_sceneSettings;
+        bool m_printFrameStats{false};
 };
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "LightingBenchmark.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+// GPU timings arrive a few frames late, so the first frames of each step still measure the previous one
+constexpr auto warmupFrames = 30;
+constexpr auto sampleFrames = 120;
+
+constexpr auto benchmarkLightCounts = {8, 64, 512};
+
+// Spread over the demo scene, so the lights overlap its geometry rather than empty space
+constexpr auto lightFieldExtent = 12.0f;
+constexpr auto lightFieldMinHeight = 0.5f;
+constexpr auto lightFieldMaxHeight = 4.0f;
+constexpr auto benchmarkLightRadius = 1.0f;
+
+std::string shadingName(PointLightShading shading)
+{
+    switch(shading)
+    {
+        case PointLightShading::Clustered: return "clustered";
+        case PointLightShading::LightVolumes: return "light volumes";
+        default: return "unknown";
+    }
+}
+
+LightingBenchmark::LightingBenchmark(Renderer& renderer)
+    : m_renderer{renderer}
+{
+}
+
+void LightingBenchmark::start()
+{
+    if(m_running)
+    {
+        return;
+    }
+
+    m_steps.clear();
+    for(const auto lightCount : benchmarkLightCounts)
+    {
+        m_steps.push_back({PointLightShading::Clustered, lightCount});
+        m_steps.push_back({PointLightShading::LightVolumes, lightCount});
+    }
+
+    m_previousShading = m_renderer.pointLightShading();
+    m_currentStep = 0;
+    m_running = true;
+
+    std::cout << "Lighting benchmark started\n";
+    beginStep();
+}
+
+void LightingBenchmark::update()
+{
+    if(!m_running)
+    {
+        return;
+    }
+
+    auto& step = m_steps[m_currentStep];
+    if(m_frame >= warmupFrames)
+    {
+        for(const auto& timing : m_renderer.passTimings())
+        {
+            if(timing.name == "LightCulling" || timing.name == "Lighting" || timing.name == "PointLightVolumes")
+            {
+                step.totalMilliseconds += timing.gpuMilliseconds;
+            }
+        }
+        step.sampleCount++;
+    }
+
+    m_frame++;
+    if(m_frame >= warmupFrames + sampleFrames)
+    {
+        m_currentStep++;
+        if(m_currentStep == m_steps.size())
+        {
+            finish();
+            return;
+        }
+
+        beginStep();
+    }
+
+    for(const auto& light : m_lights)
+    {
+        m_renderer.addPointLight(light);
+    }
+}
+
+void LightingBenchmark::beginStep()
+{
+    const auto& step = m_steps[m_currentStep];
+    m_renderer.setPointLightShading(step.shading);
+    m_frame = 0;
+
+    // Seeded the same for every step, so both shading modes light the same layout
+    auto generator = std::mt19937{1234};
+    auto horizontal = std::uniform_real_distribution<float>{-lightFieldExtent, lightFieldExtent};
+    auto vertical = std::uniform_real_distribution<float>{lightFieldMinHeight, lightFieldMaxHeight};
+    auto channel = std::uniform_real_distribution<float>{0.2f, 1.0f};
+
+    m_lights.clear();
+    for(auto i = 0; i < step.lightCount; ++i)
+    {
+        auto light = PointLight{};
+        light.position = glm::vec3{horizontal(generator), vertical(generator), horizontal(generator)};
+        light.color = glm::vec3{channel(generator), channel(generator), channel(generator)};
+        light.radius = benchmarkLightRadius;
+        light.castShadows = false;
+        m_lights.push_back(light);
+    }
+}
+
+void LightingBenchmark::finish()
+{
+    m_running = false;
+    m_lights.clear();
+    m_renderer.setPointLightShading(m_previousShading);
+
+    std::cout << "Lighting benchmark, GPU ms per frame of the point light passes:\n";
+    for(const auto& step : m_steps)
+    {
+        const auto average = step.sampleCount > 0 ? step.totalMilliseconds / step.sampleCount : 0.0;
+        auto line = std::stringstream{};
+        line << "  " << std::setw(4) << step.lightCount << " lights, " << std::left << std::setw(14)
+             << shadingName(step.shading) << std::right << std::fixed << std::setprecision(3) << average << " ms\n";
+        std::cout << line.str();
+    }
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "data/PointLight.h"
+#include "rendering/Renderer.h"
+
+#include <vector>
+
+// Compares the GPU time of the point light shading modes. Each step adds a fixed set of generated,
+// non shadow casting lights to the scene for a number of frames and averages the lighting pass times
+class LightingBenchmark
+{
+    public:
+        explicit LightingBenchmark(Renderer& renderer);
+
+        LightingBenchmark(const LightingBenchmark& other) = delete;
+        LightingBenchmark(LightingBenchmark&& other) = delete;
+
+        LightingBenchmark& operator=(const LightingBenchmark& other) = delete;
+        LightingBenchmark& operator=(LightingBenchmark&& other) = delete;
+
+        void start();
+
+        // Called each frame before rendering, records the last frame's timings and queues this frame's lights
+        void update();
+
+        inline bool running() const
+        {
+            return m_running;
+        }
+
+    private:
+        struct Step
+        {
+            PointLightShading shading{PointLightShading::Clustered};
+            int lightCount{0};
+            double totalMilliseconds{0.0};
+            int sampleCount{0};
+        };
+
+        void beginStep();
+        void finish();
+
+    private:
+        Renderer& m_renderer;
+        std::vector<Step> m_steps;
+        std::vector<PointLight> m_lights;
+        size_t m_currentStep{0};
+        int m_frame{0};
+        bool m_running{false};
+        PointLightShading m_previousShading{PointLightShading::Clustered};
+};
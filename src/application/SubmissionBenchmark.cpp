@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "SubmissionBenchmark.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+constexpr auto warmupFrames = 10;
+constexpr auto sampleFrames = 120;
+
+constexpr auto benchmarkRepeatCounts = {1, 8, 32};
+
+// Passes whose cost scales with the queued commands, including the instance upload they share
+constexpr auto meshPassNames = {"Instances", "DirectionalShadow", "PointLightShadow", "DepthPrePass", "GBuffer"};
+
+bool isMeshPass(const std::string& name)
+{
+    for(const auto* meshPassName : meshPassNames)
+    {
+        if(name == meshPassName)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+SubmissionBenchmark::SubmissionBenchmark(Renderer& renderer)
+    : m_renderer{renderer}
+{
+}
+
+void SubmissionBenchmark::start()
+{
+    if(m_running)
+    {
+        return;
+    }
+
+    m_steps.clear();
+    for(const auto repeatCount : benchmarkRepeatCounts)
+    {
+        m_steps.push_back({repeatCount});
+    }
+
+    m_currentStep = 0;
+    m_lastFrameDraws = 0;
+    m_frame = 0;
+    m_running = true;
+
+    std::cout << "Submission benchmark started\n";
+}
+
+void SubmissionBenchmark::update()
+{
+    if(!m_running)
+    {
+        return;
+    }
+
+    // Timings read here belong to the previous frame, so the first frames of each step are dropped
+    auto& step = m_steps[m_currentStep];
+    if(m_frame >= warmupFrames)
+    {
+        for(const auto& timing : m_renderer.passTimings())
+        {
+            if(isMeshPass(timing.name))
+            {
+                step.totalMilliseconds += timing.cpuMilliseconds;
+            }
+        }
+        step.totalDraws += m_lastFrameDraws;
+    }
+
+    m_frame++;
+    if(m_frame >= warmupFrames + sampleFrames)
+    {
+        m_currentStep++;
+        m_frame = 0;
+        if(m_currentStep == m_steps.size())
+        {
+            finish();
+            return;
+        }
+    }
+
+    // Copied first, since queueing more commands can reallocate the renderer's list
+    m_sceneCommands = m_renderer.drawCommands();
+    for(auto repeat = 1; repeat < m_steps[m_currentStep].repeatCount; ++repeat)
+    {
+        for(const auto& command : m_sceneCommands)
+        {
+            m_renderer.queueDrawCommand(command);
+        }
+    }
+
+    m_lastFrameDraws = m_renderer.drawCommands().size();
+}
+
+void SubmissionBenchmark::finish()
+{
+    m_running = false;
+    m_sceneCommands.clear();
+
+    std::cout << "Submission benchmark, CPU time of the mesh passes per queued draw:\n";
+    for(const auto& step : m_steps)
+    {
+        const auto microseconds = step.totalDraws > 0 ? step.totalMilliseconds * 1000.0 / static_cast<double>(step.totalDraws) : 0.0;
+        const auto drawsPerFrame = step.totalDraws / sampleFrames;
+
+        auto line = std::stringstream{};
+        line << "  " << std::setw(6) << drawsPerFrame << " draws, " << std::fixed << std::setprecision(3) << microseconds << " us\n";
+        std::cout << line.str();
+    }
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/DrawCommand.h"
+#include "rendering/Renderer.h"
+
+#include <vector>
+
+// Measures the CPU cost of submitting a draw. Each step repeats the scene's draw commands a number of
+// times for a number of frames and divides the CPU time of the mesh passes by the draws they were given
+class SubmissionBenchmark
+{
+    public:
+        explicit SubmissionBenchmark(Renderer& renderer);
+
+        SubmissionBenchmark(const SubmissionBenchmark& other) = delete;
+        SubmissionBenchmark(SubmissionBenchmark&& other) = delete;
+
+        SubmissionBenchmark& operator=(const SubmissionBenchmark& other) = delete;
+        SubmissionBenchmark& operator=(SubmissionBenchmark&& other) = delete;
+
+        void start();
+
+        // Called each frame after the scene's draws are queued, records the last frame's timings and repeats this frame's draws
+        void update();
+
+        inline bool running() const
+        {
+            return m_running;
+        }
+
+    private:
+        struct Step
+        {
+            int repeatCount{0};
+            double totalMilliseconds{0.0};
+            size_t totalDraws{0};
+        };
+
+        void finish();
+
+    private:
+        Renderer& m_renderer;
+        std::vector<Step> m_steps;
+        std::vector<DrawCommand> m_sceneCommands;
+        size_t m_currentStep{0};
+        size_t m_lastFrameDraws{0};
+        int m_frame{0};
+        bool m_running{false};
+};
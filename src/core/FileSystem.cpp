@@ -58,6 +58,11 @@ std::filesystem::path GetShaderDir()
     return GetResourceDir() / "shaders";
 }
 
+std::filesystem::path GetTerrainDir()
+{
+    return GetResourceDir() / "terrain";
+}
+
 std::filesystem::path GetTexturesDir()
 {
     return GetResourceDir() / "textures";
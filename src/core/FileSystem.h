@@ -10,4 +10,5 @@ std::filesystem::path GetResourceDir();
 std::filesystem::path GetPrefabsDir();
 std::filesystem::path GetScriptsDir();
 std::filesystem::path GetShaderDir();
+std::filesystem::path GetTerrainDir();
 std::filesystem::path GetTexturesDir();
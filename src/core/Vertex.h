@@ -5,9 +5,35 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 struct Vertex
 {
     glm::vec3 position{0.0f, 0.0f, 0.0f};
     glm::vec3 normal{0.0f, 0.0f, 0.0f};
     glm::vec2 textureUV{0.0f, 0.0f};
+};
+
+// The parts of a vertex other than its position, which the GPU keeps in a separate stream
+// so depth-only passes fetch just the positions
+struct VertexAttributes
+{
+    glm::vec3 normal{0.0f, 0.0f, 0.0f};
+    glm::vec2 textureUV{0.0f, 0.0f};
+};
+
+// Position normalised to 16 bits within its mesh's bounding box, padded to keep the stream 4-byte aligned
+struct QuantisedPosition
+{
+    uint16_t x{0};
+    uint16_t y{0};
+    uint16_t z{0};
+    uint16_t _padding{0};
+};
+
+// Octahedral-encoded normal as two snorm16 values and a half float texture coordinate
+struct QuantisedVertexAttributes
+{
+    int16_t normal[2]{0, 0};
+    uint16_t textureUV[2]{0, 0};
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t workerCount)
+{
+    m_workers.reserve(workerCount);
+    for(size_t i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        auto lock = std::lock_guard{m_mutex};
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(size_t taskCount, const std::function<void(size_t)>& task)
+{
+    {
+        auto lock = std::lock_guard{m_mutex};
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask = 0;
+        m_busyWorkers = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    runTasks();
+
+    auto lock = std::unique_lock{m_mutex};
+    m_finished.wait(lock, [this]() { return m_busyWorkers == 0; });
+    m_task = nullptr;
+}
+
+void WorkerPool::workerLoop()
+{
+    auto generation = uint64_t{0};
+
+    while(true)
+    {
+        {
+            auto lock = std::unique_lock{m_mutex};
+            m_wake.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+            if(m_stopping)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        runTasks();
+
+        auto lock = std::lock_guard{m_mutex};
+        if(--m_busyWorkers == 0)
+        {
+            m_finished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runTasks()
+{
+    // Tasks are claimed one at a time, so uneven tasks still spread across every thread
+    for(auto i = m_nextTask++; i < m_taskCount; i = m_nextTask++)
+    {
+        (*m_task)(i);
+    }
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads kept alive between frames, so per-frame work can fan out without paying for thread creation
+class WorkerPool
+{
+    public:
+        explicit WorkerPool(size_t workerCount);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool& other) = delete;
+        WorkerPool(WorkerPool&& other) = delete;
+
+        WorkerPool& operator=(const WorkerPool& other) = delete;
+        WorkerPool& operator=(WorkerPool&& other) = delete;
+
+        // Calls task with every index below taskCount, spread over the workers and the calling thread,
+        // and returns once all of them have finished
+        void run(size_t taskCount, const std::function<void(size_t)>& task);
+
+        // Workers plus the calling thread
+        inline size_t threadCount() const
+        {
+            return m_workers.size() + 1;
+        }
+
+    private:
+        void workerLoop();
+        void runTasks();
+
+    private:
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_finished;
+
+        const std::function<void(size_t)>* m_task{nullptr};
+        size_t m_taskCount{0};
+        std::atomic<size_t> m_nextTask{0};
+        size_t m_busyWorkers{0};
+        uint64_t m_generation{0};
+        bool m_stopping{false};
+};
@@ -15,4 +15,6 @@ struct Material
     glm::vec3 diffuse;
     glm::vec3 specular;
     std::optional<Texture*> diffuseTexture;
+    // Average colour of the diffuse texture, for stand-ins too far away to sample it
+    glm::vec3 diffuseTextureMean{1.0f, 1.0f, 1.0f};
 };
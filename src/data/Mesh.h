@@ -4,6 +4,8 @@
 #pragma once
 
 #include "core/Vertex.h"
+#include "data/Box.h"
+#include "data/Meshlet.h"
 
 #include <vector>
 
@@ -16,4 +18,7 @@ struct Mesh
     std::vector<Vertex> vertices;
     std::vector<GLuint> indices;
     Material* material;
+    Box boundingBox;
+    // Empty for meshes small enough to only ever be drawn whole
+    std::vector<Meshlet> meshlets;
 };
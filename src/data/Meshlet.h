@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+// A small cluster of a mesh's triangles, kept together in the mesh's index buffer so it can be culled and drawn on its own
+struct Meshlet
+{
+    // Range of Mesh::indices
+    GLuint firstIndex{0};
+    GLuint indexCount{0};
+    // Model space bounding sphere, centre and radius
+    glm::vec4 boundingSphere{0.0f};
+    // Every triangle faces away from a viewer at p when dot(normalize(coneApex - p), coneAxis) >= coneCutoff.
+    // A cutoff above 1 marks clusters whose normals spread too far to ever be rejected
+    glm::vec3 coneApex{0.0f};
+    glm::vec3 coneAxis{0.0f, 0.0f, 1.0f};
+    float coneCutoff{2.0f};
+};
@@ -10,4 +10,5 @@ struct PointLight
     glm::vec3 position{0.0f, 0.0f, 0.0f};
     glm::vec3 color{0.0f, 0.0f, 0.0f};
     float radius = 7.5f;
+    bool castShadows = true;
 };
\ No newline at end of file
@@ -22,11 +22,22 @@ void Prefab::addMesh(std::unique_ptr<Mesh> mesh)
         return;
     }
 
-    m_boundingBox.expandToFit(Box::enclose(mesh->vertices));
+    mesh->boundingBox = Box::enclose(mesh->vertices);
+    m_boundingBox.expandToFit(mesh->boundingBox);
 
     m_meshes.push_back(std::move(mesh));
 }
 
+void Prefab::addLod(std::vector<std::unique_ptr<Mesh>> meshes)
+{
+    for(auto& mesh : meshes)
+    {
+        mesh->boundingBox = Box::enclose(mesh->vertices);
+    }
+
+    m_lods.push_back(std::move(meshes));
+}
+
 void Prefab::addTexture(const std::string& name, std::unique_ptr<Texture> texture)
 {
     if(!texture)
@@ -37,6 +48,16 @@ void Prefab::addTexture(const std::string& name, std::unique_ptr<Texture> textur
      m_textures[name] = std::move(texture);
 }
 
+void Prefab::setOccluder(std::unique_ptr<OccluderMesh> occluder)
+{
+    m_occluder = std::move(occluder);
+}
+
+void Prefab::setImpostorEnabled(bool enabled)
+{
+    m_impostorEnabled = enabled;
+}
+
 Material* Prefab::getMaterial(const std::string& name) const
 {
     if(!m_materials.contains(name))
@@ -62,6 +83,31 @@ const std::vector<std::unique_ptr<Mesh>>& Prefab::meshes() const
     return m_meshes;
 }
 
+size_t Prefab::lodCount() const
+{
+    return m_lods.size() + 1;
+}
+
+const std::vector<std::unique_ptr<Mesh>>& Prefab::lodMeshes(size_t lod) const
+{
+    if(lod == 0)
+    {
+        return m_meshes;
+    }
+
+    return m_lods.at(lod - 1);
+}
+
+const OccluderMesh* Prefab::occluder() const
+{
+    return m_occluder.get();
+}
+
+bool Prefab::impostorEnabled() const
+{
+    return m_impostorEnabled;
+}
+
 const Box& Prefab::boundingBox() const
 {
     return m_boundingBox;
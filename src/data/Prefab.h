@@ -7,6 +7,7 @@
 
 #include "data/Material.h"
 #include "data/Mesh.h"
+#include "data/OccluderMesh.h"
 #include "data/Texture.h"
 
 #include <memory>
@@ -24,18 +25,37 @@ class Prefab
         void addMaterial(const std::string& name, std::unique_ptr<Material> material);
         void addMesh(std::unique_ptr<Mesh> mesh);
         void addTexture(const std::string& name, std::unique_ptr<Texture> texture);
+        void setOccluder(std::unique_ptr<OccluderMesh> occluder);
+        void setImpostorEnabled(bool enabled);
+
+        // Appends a coarser level of detail, one simplified mesh for each mesh of the level before
+        void addLod(std::vector<std::unique_ptr<Mesh>> meshes);
 
         Material* getMaterial(const std::string& name) const;
         Texture* getTexture(const std::string& name) const;
 
         const std::vector<std::unique_ptr<Mesh>>& meshes() const;
+
+        // Levels of detail including the full meshes, which are level 0
+        size_t lodCount() const;
+        const std::vector<std::unique_ptr<Mesh>>& lodMeshes(size_t lod) const;
+
+        // Null for prefabs that never hide anything from the CPU occlusion test
+        const OccluderMesh* occluder() const;
+
+        // Whether the renderer bakes an impostor atlas for drawing distant instances as quads
+        bool impostorEnabled() const;
     
         const Box& boundingBox() const;
 
     private:
         std::unordered_map<std::string, std::unique_ptr<Material>> m_materials;
         std::vector<std::unique_ptr<Mesh>> m_meshes;
+        // Levels 1 and up
+        std::vector<std::vector<std::unique_ptr<Mesh>>> m_lods;
         std::unordered_map<std::string, std::unique_ptr<Texture>> m_textures;
+        std::unique_ptr<OccluderMesh> m_occluder{nullptr};
+        bool m_impostorEnabled{false};
 
         Box m_boundingBox{};
 };
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+// Rendering options chosen per scene, since what pays off depends on its content
+struct SceneSettings
+{
+    // Worth it for scenes with heavy overlap, where most G-buffer fragments are otherwise overdrawn
+    bool depthPrePass = false;
+
+    // Halves vertex memory and bandwidth, at the cost of sub-millimetre snapping on all but very large meshes
+    bool quantiseVertices = true;
+
+    // Pays off once there are more draws than the CPU can cull and submit one by one
+    bool gpuCulling = false;
+
+    // Skips draws hidden behind last frame's depth, worth it for dense scenes that block most of the view
+    bool occlusionCulling = false;
+
+    // Hides draws behind prefab occluders rasterised on the CPU, for when the GPU path is off or its
+    // frame-late depth is not good enough. Only pays off with large occluders such as walls and terrain
+    bool cpuOcclusionCulling = false;
+
+    // Merges entities without behaviours into world space chunks at load. Saves draws on scenes full of props,
+    // but nothing can move a merged entity afterwards
+    bool staticBatching = false;
+
+    // Projected radius, as a fraction of half the screen height, below which prefabs with "impostor" set are drawn
+    // as a quad from their baked atlas. A few pixels across, where the quad's fixed views are not noticed
+    float impostorScreenSize = 0.03f;
+
+    // Groups entities without behaviours into coarse cells at load, each with one merged and simplified proxy,
+    // and draws a cell's proxy instead of its members once the camera is this far from it. 0 builds no cells.
+    // For large scenes, where distant regions would otherwise cost a draw and a visit per entity
+    float hlodDistance = 0.0f;
+};
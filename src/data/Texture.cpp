@@ -3,14 +3,22 @@
 
 #include "Texture.h"
 
+#include "rendering/GlStateCache.h"
+
 Texture::Texture(GLenum type)
 {
     glCreateTextures(type, 1, &m_handle);
 }
 
+Texture::Texture()
+{
+    glGenTextures(1, &m_handle);
+}
+
 Texture::~Texture()
 {
     glDeleteTextures(1, &m_handle);
+    GlStateCache::instance().onTextureDeleted(m_handle);
 }
 
 void Texture::setMinFilter(GLenum value)
@@ -54,10 +62,21 @@ void Texture::writeImageData(GLsizei width, GLsizei height, const void* data)
     glGenerateTextureMipmap(m_handle);
 }
 
-Texture2D::Texture2D(GLenum format, GLsizei width, GLsizei height)
+Texture2D::Texture2D(GLenum format, GLsizei width, GLsizei height, GLsizei levels)
     : Texture(GL_TEXTURE_2D)
 {
-    glTextureStorage2D(handle(), 1, format, width, height);
+    glTextureStorage2D(handle(), levels, format, width, height);
+}
+
+Texture2DView::Texture2DView(const Texture2D& storage, GLenum format)
+{
+    glTextureView(handle(), GL_TEXTURE_2D, storage.handle(), format, 0, 1, 0, 1);
+}
+
+Texture2DArray::Texture2DArray(GLenum format, GLsizei width, GLsizei height, GLsizei layers)
+    : Texture(GL_TEXTURE_2D_ARRAY)
+{
+    glTextureStorage3D(handle(), 1, format, width, height, layers);
 }
 
 TextureCubeMap::TextureCubeMap(GLenum format, GLsizei width, GLsizei height)
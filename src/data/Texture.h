@@ -34,6 +34,10 @@ class Texture
             return m_handle;
         }
 
+    protected:
+        // Only reserves a name, as a view must be made on one that has never been bound
+        Texture();
+
     private:
         GLuint m_handle{0};
 };
@@ -41,7 +45,24 @@ class Texture
 class Texture2D : public Texture
 {
     public:
-        Texture2D(GLenum format, GLsizei width, GLsizei height);
+        Texture2D(GLenum format, GLsizei width, GLsizei height, GLsizei levels = 1);
+
+    protected:
+        Texture2D() = default;
+};
+
+// Another format's view of a 2D texture's storage. The formats must be of the same view class.
+// Passes see it as any other 2D texture
+class Texture2DView : public Texture2D
+{
+    public:
+        Texture2DView(const Texture2D& storage, GLenum format);
+};
+
+class Texture2DArray : public Texture
+{
+    public:
+        Texture2DArray(GLenum format, GLsizei width, GLsizei height, GLsizei layers);
 };
 
 class TextureCubeMap : public Texture
@@ -44,6 +44,32 @@ std::optional<Texture*> readBaseColorTexture(tinygltf::Material& material, tinyg
     return texture;
 }
 
+glm::vec3 readBaseColorTextureMean(tinygltf::Material& material, tinygltf::Model& model)
+{
+    const auto texIndex = material.pbrMetallicRoughness.baseColorTexture.index;
+    if(texIndex < 0)
+    {
+        return glm::vec3{1.0f, 1.0f, 1.0f};
+    }
+
+    const auto& image = model.images[model.textures[texIndex].source];
+    // 8 bits per channel, the only depth the texture upload handles
+    const auto texelCount = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
+    if(texelCount == 0 || image.component < 3 || image.image.size() != texelCount * image.component)
+    {
+        return glm::vec3{1.0f, 1.0f, 1.0f};
+    }
+
+    auto sum = glm::dvec3{0.0};
+    for(size_t i = 0; i < texelCount; ++i)
+    {
+        const auto* texel = &image.image[i * image.component];
+        sum += glm::dvec3{texel[0], texel[1], texel[2]};
+    }
+
+    return glm::vec3(sum / (static_cast<double>(texelCount) * 255.0));
+}
+
 std::vector<GLuint> readIndices(tinygltf::Primitive& primitive, tinygltf::Model& model)
 {
     const auto& indexAcessor = model.accessors[primitive.indices];
@@ -142,6 +168,7 @@ std::unique_ptr<Prefab> loadBinaryModel(const std::filesystem::path& path)
         auto material = std::make_unique<Material>();
         material->diffuse = readBaseColor(gltfMaterial);
         material->diffuseTexture = readBaseColorTexture(gltfMaterial, model, *prefab);     
+        material->diffuseTextureMean = readBaseColorTextureMean(gltfMaterial, model);
         prefab->addMaterial(gltfMaterial.name, std::move(material));
     }
 
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "HeightmapStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+HeightmapStreamer::HeightmapStreamer(const std::filesystem::path& path)
+    : m_file{path, std::ios::binary}
+{
+    if(!m_file)
+    {
+        throw std::runtime_error("Failed to open heightmap " + path.string());
+    }
+
+    const auto sampleTotal = std::filesystem::file_size(path) / sizeof(uint16_t);
+    m_sampleCount = static_cast<int>(std::lround(std::sqrt(static_cast<double>(sampleTotal))));
+
+    // A power of two intervals along each side, so every quadtree level lands on whole samples
+    const auto intervals = m_sampleCount - 1;
+    if(static_cast<uint64_t>(m_sampleCount) * m_sampleCount != sampleTotal || intervals <= 0 || (intervals & (intervals - 1)) != 0)
+    {
+        throw std::runtime_error("Heightmap " + path.string() + " must be 2^n + 1 samples square");
+    }
+
+    m_thread = std::thread{&HeightmapStreamer::streamLoop, this};
+}
+
+HeightmapStreamer::~HeightmapStreamer()
+{
+    {
+        auto lock = std::lock_guard{m_mutex};
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    m_thread.join();
+}
+
+void HeightmapStreamer::request(uint64_t key, int firstX, int firstZ, int step, int count)
+{
+    {
+        auto lock = std::lock_guard{m_mutex};
+        m_requests.push_back({key, firstX, firstZ, step, count, {}});
+    }
+    m_wake.notify_one();
+}
+
+std::vector<HeightmapRegion> HeightmapStreamer::takeCompleted()
+{
+    auto lock = std::lock_guard{m_mutex};
+    return std::exchange(m_completed, {});
+}
+
+void HeightmapStreamer::streamLoop()
+{
+    while(true)
+    {
+        auto region = HeightmapRegion{};
+        {
+            auto lock = std::unique_lock{m_mutex};
+            m_wake.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+            if(m_stopping)
+            {
+                return;
+            }
+            region = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        readRegion(region);
+
+        auto lock = std::lock_guard{m_mutex};
+        m_completed.push_back(std::move(region));
+    }
+}
+
+void HeightmapStreamer::readRegion(HeightmapRegion& region)
+{
+    const auto clampSample = [this](int i) { return std::clamp(i, 0, m_sampleCount - 1); };
+
+    // Each row is read as one span covering every sample it needs, and thinned out afterwards
+    const auto spanStart = clampSample(region.firstX);
+    const auto spanEnd = clampSample(region.firstX + (region.count - 1) * region.step) + 1;
+    auto row = std::vector<uint16_t>(static_cast<size_t>(spanEnd - spanStart));
+
+    region.samples.resize(static_cast<size_t>(region.count) * region.count);
+    for(auto j = 0; j < region.count; ++j)
+    {
+        const auto z = clampSample(region.firstZ + j * region.step);
+        const auto offset = (static_cast<std::streamoff>(z) * m_sampleCount + spanStart) * sizeof(uint16_t);
+        m_file.seekg(offset);
+        m_file.read(reinterpret_cast<char*>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(uint16_t)));
+
+        for(auto i = 0; i < region.count; ++i)
+        {
+            const auto x = clampSample(region.firstX + i * region.step);
+            region.samples[static_cast<size_t>(j) * region.count + i] = row[x - spanStart];
+        }
+    }
+}
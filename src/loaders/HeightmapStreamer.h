@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A square grid of heights read from a heightmap, every step-th sample from a corner
+struct HeightmapRegion
+{
+    // Chosen by the requester to match the region to what it asked for
+    uint64_t key{0};
+    int firstX{0};
+    int firstZ{0};
+    int step{1};
+    // Samples along each side
+    int count{0};
+    // Row by row along x. Samples past the map's edges repeat its edge
+    std::vector<uint16_t> samples;
+};
+
+// Reads regions of a heightmap file on a thread of its own, so terrain can page in around the camera
+// without stalling a frame on the disk. The file holds 16-bit little endian samples, 2^n + 1 of them
+// along each side, row by row along x
+class HeightmapStreamer
+{
+    public:
+        explicit HeightmapStreamer(const std::filesystem::path& path);
+        ~HeightmapStreamer();
+
+        HeightmapStreamer(const HeightmapStreamer& other) = delete;
+        HeightmapStreamer(HeightmapStreamer&& other) = delete;
+
+        HeightmapStreamer& operator=(const HeightmapStreamer& other) = delete;
+        HeightmapStreamer& operator=(HeightmapStreamer&& other) = delete;
+
+        // Queues a region for reading. Regions are read in the order they were requested
+        void request(uint64_t key, int firstX, int firstZ, int step, int count);
+
+        // Regions read since the last call
+        std::vector<HeightmapRegion> takeCompleted();
+
+        inline int sampleCount() const
+        {
+            return m_sampleCount;
+        }
+
+    private:
+        void streamLoop();
+        void readRegion(HeightmapRegion& region);
+
+    private:
+        std::ifstream m_file;
+        int m_sampleCount{0};
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<HeightmapRegion> m_requests;
+        std::vector<HeightmapRegion> m_completed;
+        bool m_stopping{false};
+};
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "HlodBuilder.h"
+
+#include "data/Material.h"
+#include "data/Mesh.h"
+#include "data/Prefab.h"
+#include "loaders/MeshOptimiser.h"
+#include "loaders/MeshletBuilder.h"
+#include "loaders/MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Texels along each side of a material's tile. Vertices sample the tile's centre, which keeps filtering inside it
+constexpr auto hlodTileSize = 4;
+
+// How far a proxy may stray from the surface, as a fraction of the cell's edge. Coarser than mesh levels,
+// since a proxy is only drawn from further away than the cell is wide
+constexpr auto hlodMaxError = 0.02f;
+
+// Proxy meshes stay small enough for 16-bit indices
+constexpr size_t maxProxyVertices = 65536;
+
+// What a material looks like from far away
+glm::vec3 hlodTileColor(const Material& material)
+{
+    return material.diffuseTexture ? material.diffuseTextureMean : material.diffuse;
+}
+
+HlodProxy buildHlodProxy(const std::vector<HlodSource>& sources)
+{
+    auto proxy = HlodProxy{};
+
+    // A tile per material, in the order they are first met
+    auto materials = std::vector<const Material*>{};
+    for(const auto& source : sources)
+    {
+        for(const auto& mesh : source.prefab->lodMeshes(source.prefab->lodCount() - 1))
+        {
+            if(mesh->material && std::find(materials.begin(), materials.end(), mesh->material) == materials.end())
+            {
+                materials.push_back(mesh->material);
+            }
+        }
+    }
+
+    const auto tilesPerRow = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(materials.size())))));
+    proxy.atlasSize = tilesPerRow * hlodTileSize;
+    proxy.atlas.assign(static_cast<size_t>(proxy.atlasSize * proxy.atlasSize) * 4, 255);
+
+    for(size_t m = 0; m < materials.size(); ++m)
+    {
+        const auto color = glm::clamp(hlodTileColor(*materials[m]), 0.0f, 1.0f) * 255.0f;
+        const auto firstX = static_cast<int>(m) % tilesPerRow * hlodTileSize;
+        const auto firstY = static_cast<int>(m) / tilesPerRow * hlodTileSize;
+        for(auto y = firstY; y < firstY + hlodTileSize; ++y)
+        {
+            for(auto x = firstX; x < firstX + hlodTileSize; ++x)
+            {
+                auto* texel = &proxy.atlas[static_cast<size_t>(y * proxy.atlasSize + x) * 4];
+                texel[0] = static_cast<unsigned char>(color.r + 0.5f);
+                texel[1] = static_cast<unsigned char>(color.g + 0.5f);
+                texel[2] = static_cast<unsigned char>(color.b + 0.5f);
+            }
+        }
+    }
+
+    auto merged = std::vector<std::unique_ptr<Mesh>>{};
+    for(const auto& source : sources)
+    {
+        const auto normalMatrix = glm::transpose(glm::inverse(glm::mat3{source.transform}));
+
+        for(const auto& mesh : source.prefab->lodMeshes(source.prefab->lodCount() - 1))
+        {
+            // Never drawn, so nothing to stand in for
+            if(!mesh->material)
+            {
+                continue;
+            }
+
+            if(merged.empty() || merged.back()->vertices.size() + mesh->vertices.size() > maxProxyVertices)
+            {
+                merged.push_back(std::make_unique<Mesh>());
+            }
+
+            const auto tile = std::find(materials.begin(), materials.end(), mesh->material) - materials.begin();
+            const auto tileUV = (glm::vec2{static_cast<float>(tile % tilesPerRow), static_cast<float>(tile / tilesPerRow)} + 0.5f)
+                              / static_cast<float>(tilesPerRow);
+
+            auto& target = *merged.back();
+            const auto firstVertex = static_cast<GLuint>(target.vertices.size());
+
+            for(auto vertex : mesh->vertices)
+            {
+                vertex.position = glm::vec3(source.transform * glm::vec4(vertex.position, 1.0f));
+                vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+                vertex.textureUV = tileUV;
+                target.vertices.push_back(vertex);
+            }
+
+            for(const auto index : mesh->indices)
+            {
+                target.indices.push_back(firstVertex + index);
+            }
+        }
+    }
+
+    for(const auto& mesh : merged)
+    {
+        auto simplified = simplifyMesh(*mesh, mesh->indices.size() / 4, hlodCellSize * hlodMaxError);
+        simplified->material = nullptr;
+
+        // Same finishing steps as imported meshes
+        optimiseMesh(*simplified);
+        buildMeshlets(*simplified);
+
+        proxy.meshes.push_back(std::move(simplified));
+    }
+
+    return proxy;
+}
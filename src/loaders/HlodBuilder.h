@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+class Prefab;
+struct Mesh;
+
+// Edge of the grid cells a proxy covers. Four static batching cells across, so a region the camera is far from
+// costs one draw instead of tens
+constexpr auto hlodCellSize = 128.0f;
+
+struct HlodSource
+{
+    const Prefab* prefab{nullptr};
+    glm::mat4 transform{1.0f};
+};
+
+// A cell's merged stand-in before anything is uploaded. The meshes are in world space and have no material yet,
+// they are textured by the atlas, which holds a flat tile for every material of the sources
+struct HlodProxy
+{
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    // RGBA8, atlasSize texels square
+    std::vector<unsigned char> atlas;
+    int atlasSize{0};
+};
+
+// Merges the coarsest level of every source into world space meshes and simplifies them to about a quarter
+// of the triangles. Textures are baked down to their average colour. Touches no GL state, so it runs on
+// worker threads and in tools without a window
+HlodProxy buildHlodProxy(const std::vector<HlodSource>& sources);
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "HlodCells.h"
+
+#include "core/WorkerPool.h"
+#include "data/AssetDatabase.h"
+#include "data/Material.h"
+#include "data/Mesh.h"
+#include "data/Prefab.h"
+#include "loaders/HlodBuilder.h"
+#include "loaders/TextureLoader.h"
+#include "world/World.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+void buildHlodCells(AssetDatabase& assetDb, World& world)
+{
+    auto members = std::vector<HlodMember>{};
+    for(auto& [entity, meshComponent] : world.getAllComponents<MeshRendererComponent>())
+    {
+        if(!meshComponent.prefab || world.getComponent<BehaviourComponent>(entity))
+        {
+            continue;
+        }
+
+        const auto* transform = world.getComponent<TransformComponent>(entity);
+        if(!transform)
+        {
+            continue;
+        }
+
+        const auto matrix = transform->matrix();
+        auto worldBox = meshComponent.prefab->boundingBox();
+        worldBox.transform(matrix);
+
+        members.push_back({entity, meshComponent.prefab, matrix, worldBox});
+    }
+
+    // The component storage is unordered, so sort to build the same cells on every run
+    std::sort(members.begin(), members.end(), [](const auto& a, const auto& b) { return a.entity < b.entity; });
+
+    auto cells = std::map<std::array<int, 3>, std::vector<HlodMember>>{};
+    for(const auto& member : members)
+    {
+        const auto cell = glm::floor(member.worldBox.center() / hlodCellSize);
+        cells[{static_cast<int>(cell.x), static_cast<int>(cell.y), static_cast<int>(cell.z)}].push_back(member);
+    }
+
+    // A lone entity already has its own levels of detail to fall back on
+    auto cellMembers = std::vector<std::vector<HlodMember>>{};
+    for(auto& [cell, memberList] : cells)
+    {
+        if(memberList.size() >= 2)
+        {
+            cellMembers.push_back(std::move(memberList));
+        }
+    }
+
+    // Simplifying is the slow part and needs no GL context, so cells are built in parallel and only uploaded here
+    auto proxies = std::vector<HlodProxy>(cellMembers.size());
+    {
+        const auto coreCount = static_cast<size_t>(std::thread::hardware_concurrency());
+        auto workerPool = WorkerPool{std::max<size_t>(coreCount, 2) - 1};
+        workerPool.run(cellMembers.size(), [&](size_t cell) {
+            auto sources = std::vector<HlodSource>{};
+            for(const auto& member : cellMembers[cell])
+            {
+                sources.push_back({member.prefab, member.transform});
+            }
+            proxies[cell] = buildHlodProxy(sources);
+        });
+    }
+
+    auto memberTriangles = size_t{0};
+    auto proxyTriangles = size_t{0};
+    auto groupedCount = size_t{0};
+    for(size_t cell = 0; cell < cellMembers.size(); ++cell)
+    {
+        auto& proxy = proxies[cell];
+        if(proxy.meshes.empty())
+        {
+            continue;
+        }
+
+        auto prefab = std::make_unique<Prefab>();
+        prefab->addTexture("atlas", loadTexture(proxy.atlasSize, proxy.atlasSize, proxy.atlas));
+
+        auto material = std::make_unique<Material>();
+        material->ambient = glm::vec3{1.0f, 1.0f, 1.0f};
+        material->diffuse = glm::vec3{1.0f, 1.0f, 1.0f};
+        material->specular = glm::vec3{0.0f, 0.0f, 0.0f};
+        material->diffuseTexture = prefab->getTexture("atlas");
+
+        for(auto& mesh : proxy.meshes)
+        {
+            mesh->material = material.get();
+            proxyTriangles += mesh->indices.size() / 3;
+            prefab->addMesh(std::move(mesh));
+        }
+        prefab->addMaterial("atlas", std::move(material));
+
+        auto* proxyPrefab = prefab.get();
+        assetDb.addPrefab("hlod_proxy_" + std::to_string(cell), std::move(prefab));
+
+        const auto cellEntity = world.createEntity();
+        auto& hlodComponent = world.addComponent<HlodComponent>(cellEntity);
+        hlodComponent.proxy = proxyPrefab;
+        hlodComponent.bounds = cellMembers[cell].front().worldBox;
+
+        for(const auto& member : cellMembers[cell])
+        {
+            hlodComponent.bounds.expandToFit(member.worldBox);
+            world.removeComponent<MeshRendererComponent>(member.entity);
+
+            for(const auto& mesh : member.prefab->lodMeshes(member.prefab->lodCount() - 1))
+            {
+                memberTriangles += mesh->indices.size() / 3;
+            }
+        }
+
+        groupedCount += cellMembers[cell].size();
+        hlodComponent.members = std::move(cellMembers[cell]);
+    }
+
+    std::cout << "HLOD: " << groupedCount << " entities grouped into " << world.getAllComponents<HlodComponent>().size()
+              << " cells, proxies have " << proxyTriangles << " triangles against " << memberTriangles << " at the members' coarsest levels\n";
+}
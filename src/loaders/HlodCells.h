@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+class AssetDatabase;
+class World;
+
+// Groups entities without a BehaviourComponent into coarse grid cells and builds a proxy for each cell of
+// two or more. Each cell becomes an entity with an HlodComponent, which takes over its members'
+// MeshRendererComponents so RenderSystem visits one entity per far away cell instead of all of its members.
+// Run after static batching, so the cells gather up its chunks too
+void buildHlodCells(AssetDatabase& assetDb, World& world);
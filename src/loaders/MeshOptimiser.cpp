@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "MeshOptimiser.h"
+
+#include "data/Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// FIFO cache the statistics and the overdraw clusters are measured with, about the size of real hardware
+constexpr size_t fifoCacheSize = 16;
+
+// LRU cache the Forsyth scores model. Larger than the FIFO, since a good order for it suits smaller caches too
+constexpr size_t scoringCacheSize = 32;
+
+// Triangles an overdraw cluster reaches before it may also end where the cache is only nearly cold
+constexpr size_t softClusterSize = 64;
+
+constexpr auto noCachePosition = std::numeric_limits<size_t>::max();
+
+// Simulates the FIFO cache, calling onTriangle with the number of misses for each triangle
+template<typename Callback>
+void simulateFifoCache(const std::vector<GLuint>& indices, size_t vertexCount, Callback onTriangle)
+{
+    // The time each vertex entered the cache, which it has left once fifoCacheSize more vertices entered
+    auto entryTimes = std::vector<size_t>(vertexCount, 0);
+    auto time = fifoCacheSize + 1;
+
+    for(size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        auto misses = 0u;
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto vertex = indices[i + e];
+            if(time - entryTimes[vertex] > fifoCacheSize)
+            {
+                entryTimes[vertex] = time++;
+                misses++;
+            }
+        }
+        onTriangle(i / 3, misses);
+    }
+}
+
+VertexCacheStats analyseVertexCache(const std::vector<GLuint>& indices, size_t vertexCount)
+{
+    auto stats = VertexCacheStats{};
+    stats.triangleCount = indices.size() / 3;
+
+    auto used = std::vector<bool>(vertexCount, false);
+    for(const auto index : indices)
+    {
+        if(!used[index])
+        {
+            used[index] = true;
+            stats.vertexCount++;
+        }
+    }
+
+    simulateFifoCache(indices, vertexCount, [&](size_t, unsigned misses) { stats.transformedVertexCount += misses; });
+
+    return stats;
+}
+
+// Forsyth's vertex score: recently used vertices score high, except the last triangle's which are about to be
+// used anyway, and vertices with few triangles left score higher so they are finished off and stop lingering
+float forsythVertexScore(size_t cachePosition, uint32_t remainingTriangles)
+{
+    if(remainingTriangles == 0)
+    {
+        return -1.0f;
+    }
+
+    auto score = 0.0f;
+    if(cachePosition != noCachePosition)
+    {
+        if(cachePosition < 3)
+        {
+            score = 0.75f;
+        }
+        else
+        {
+            const auto scale = 1.0f / static_cast<float>(scoringCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, 1.5f);
+        }
+    }
+
+    return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+}
+
+void optimiseVertexCache(Mesh& mesh)
+{
+    const auto& indices = mesh.indices;
+    const auto vertexCount = mesh.vertices.size();
+    const auto triangleCount = indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    auto remainingTriangles = std::vector<uint32_t>(vertexCount, 0);
+    for(size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        remainingTriangles[indices[i]]++;
+    }
+
+    // Triangles of each vertex packed into one array, with the ones not emitted yet at the front of each range
+    auto firstTriangle = std::vector<size_t>(vertexCount + 1, 0);
+    for(size_t v = 0; v < vertexCount; ++v)
+    {
+        firstTriangle[v + 1] = firstTriangle[v] + remainingTriangles[v];
+    }
+
+    auto vertexTriangles = std::vector<uint32_t>(triangleCount * 3);
+    auto filled = std::vector<uint32_t>(vertexCount, 0);
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto vertex = indices[t * 3 + e];
+            vertexTriangles[firstTriangle[vertex] + filled[vertex]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    auto cachePositions = std::vector<size_t>(vertexCount, noCachePosition);
+    auto vertexScores = std::vector<float>(vertexCount);
+    for(size_t v = 0; v < vertexCount; ++v)
+    {
+        vertexScores[v] = forsythVertexScore(noCachePosition, remainingTriangles[v]);
+    }
+
+    auto triangleScores = std::vector<float>(triangleCount);
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    auto emitted = std::vector<bool>(triangleCount, false);
+    auto ordered = std::vector<GLuint>{};
+    ordered.reserve(indices.size());
+
+    auto cache = std::vector<uint32_t>{};
+    auto nextCache = std::vector<uint32_t>{};
+    size_t scanStart = 0;
+    auto best = std::numeric_limits<size_t>::max();
+
+    for(size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        // Nothing in the cache leads anywhere, so carry on from the first triangle in the original order
+        if(best == std::numeric_limits<size_t>::max())
+        {
+            while(emitted[scanStart])
+            {
+                scanStart++;
+            }
+            best = scanStart;
+        }
+
+        const auto* triangle = &indices[best * 3];
+        emitted[best] = true;
+        ordered.insert(ordered.end(), triangle, triangle + 3);
+
+        // The emitted triangle no longer counts towards its vertices
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto vertex = triangle[e];
+            auto* begin = &vertexTriangles[firstTriangle[vertex]];
+            auto* end = begin + remainingTriangles[vertex];
+            std::swap(*std::find(begin, end, static_cast<uint32_t>(best)), *(end - 1));
+            remainingTriangles[vertex]--;
+        }
+
+        // The triangle's vertices move to the front, the rest shift back and the oldest fall out
+        nextCache.assign(triangle, triangle + 3);
+        for(const auto vertex : cache)
+        {
+            if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for(size_t i = scoringCacheSize; i < nextCache.size(); ++i)
+        {
+            cachePositions[nextCache[i]] = noCachePosition;
+            vertexScores[nextCache[i]] = forsythVertexScore(noCachePosition, remainingTriangles[nextCache[i]]);
+        }
+        nextCache.resize(std::min(nextCache.size(), scoringCacheSize));
+
+        for(size_t i = 0; i < nextCache.size(); ++i)
+        {
+            cachePositions[nextCache[i]] = i;
+            vertexScores[nextCache[i]] = forsythVertexScore(i, remainingTriangles[nextCache[i]]);
+        }
+        std::swap(cache, nextCache);
+
+        // Only triangles around the cached vertices changed score, and the best next triangle is among them
+        best = std::numeric_limits<size_t>::max();
+        auto bestScore = -std::numeric_limits<float>::max();
+        for(const auto vertex : cache)
+        {
+            for(size_t i = 0; i < remainingTriangles[vertex]; ++i)
+            {
+                const auto t = vertexTriangles[firstTriangle[vertex] + i];
+                const auto* corners = &indices[t * 3];
+                triangleScores[t] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+
+                if(triangleScores[t] > bestScore || (triangleScores[t] == bestScore && t < best))
+                {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    mesh.indices = std::move(ordered);
+}
+
+void optimiseOverdraw(Mesh& mesh)
+{
+    const auto triangleCount = mesh.indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    // A triangle missing on all three vertices starts from a cold cache, so cutting there costs no cache hits.
+    // Connected meshes have few of those, so long clusters also end where two vertices miss
+    auto clusterStarts = std::vector<size_t>{};
+    simulateFifoCache(mesh.indices, mesh.vertices.size(), [&](size_t triangle, unsigned misses) {
+        const auto clusterSize = clusterStarts.empty() ? 0 : triangle - clusterStarts.back();
+        if(triangle == 0 || misses == 3 || (misses == 2 && clusterSize >= softClusterSize))
+        {
+            clusterStarts.push_back(triangle);
+        }
+    });
+    clusterStarts.push_back(triangleCount);
+
+    const auto position = [&](size_t i) { return mesh.vertices[mesh.indices[i]].position; };
+
+    struct Cluster
+    {
+        size_t firstTriangle{0};
+        size_t endTriangle{0};
+        glm::vec3 centroid{0.0f};
+        glm::vec3 normal{0.0f};
+        float sortKey{0.0f};
+    };
+
+    auto clusters = std::vector<Cluster>{};
+    auto meshCentroid = glm::vec3{0.0f};
+    auto meshArea = 0.0f;
+
+    for(size_t c = 0; c + 1 < clusterStarts.size(); ++c)
+    {
+        auto cluster = Cluster{clusterStarts[c], clusterStarts[c + 1]};
+        auto area = 0.0f;
+
+        for(auto t = cluster.firstTriangle; t < cluster.endTriangle; ++t)
+        {
+            const auto p0 = position(t * 3);
+            const auto p1 = position(t * 3 + 1);
+            const auto p2 = position(t * 3 + 2);
+
+            // Twice the area, pointing along the normal
+            const auto areaNormal = glm::cross(p1 - p0, p2 - p0);
+            const auto triangleArea = glm::length(areaNormal);
+
+            cluster.normal += areaNormal;
+            cluster.centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            area += triangleArea;
+        }
+
+        meshCentroid += cluster.centroid;
+        meshArea += area;
+        cluster.centroid = area > 0.0f ? cluster.centroid / area : position(cluster.firstTriangle * 3);
+        clusters.push_back(cluster);
+    }
+
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3{0.0f};
+
+    // Clusters far out along their own normal sit on the outside of the mesh, in front of the rest from most views
+    for(auto& cluster : clusters)
+    {
+        const auto normalLength = glm::length(cluster.normal);
+        cluster.sortKey = normalLength > 0.0f ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength) : 0.0f;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    auto ordered = std::vector<GLuint>{};
+    ordered.reserve(mesh.indices.size());
+    for(const auto& cluster : clusters)
+    {
+        ordered.insert(ordered.end(), mesh.indices.begin() + cluster.firstTriangle * 3, mesh.indices.begin() + cluster.endTriangle * 3);
+    }
+
+    mesh.indices = std::move(ordered);
+}
+
+void optimiseVertexFetch(Mesh& mesh)
+{
+    auto remap = std::vector<GLuint>(mesh.vertices.size(), std::numeric_limits<GLuint>::max());
+    auto vertices = std::vector<Vertex>{};
+    vertices.reserve(mesh.vertices.size());
+
+    for(auto& index : mesh.indices)
+    {
+        if(remap[index] == std::numeric_limits<GLuint>::max())
+        {
+            remap[index] = static_cast<GLuint>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    mesh.vertices = std::move(vertices);
+}
+
+void optimiseMesh(Mesh& mesh)
+{
+    optimiseVertexCache(mesh);
+    optimiseOverdraw(mesh);
+    optimiseVertexFetch(mesh);
+}
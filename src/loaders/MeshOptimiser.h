@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <vector>
+
+struct Mesh;
+
+// How often an index buffer misses a small FIFO post-transform cache, the usual model of the vertex shader cache
+struct VertexCacheStats
+{
+    size_t triangleCount{0};
+    // Distinct vertices the indices reference
+    size_t vertexCount{0};
+    // Vertices the cache missed, each of which runs the vertex shader again
+    size_t transformedVertexCount{0};
+
+    // Average cache miss ratio, vertex shader runs per triangle. 0.5 is ideal for large regular meshes, 3 is the worst
+    inline float acmr() const
+    {
+        return triangleCount == 0 ? 0.0f : static_cast<float>(transformedVertexCount) / static_cast<float>(triangleCount);
+    }
+
+    // Average transform to vertex ratio, vertex shader runs per distinct vertex. 1 is ideal
+    inline float atvr() const
+    {
+        return vertexCount == 0 ? 0.0f : static_cast<float>(transformedVertexCount) / static_cast<float>(vertexCount);
+    }
+
+    inline VertexCacheStats& operator+=(const VertexCacheStats& other)
+    {
+        triangleCount += other.triangleCount;
+        vertexCount += other.vertexCount;
+        transformedVertexCount += other.transformedVertexCount;
+        return *this;
+    }
+};
+
+VertexCacheStats analyseVertexCache(const std::vector<GLuint>& indices, size_t vertexCount);
+
+// Reorders triangles for the post-transform cache with Forsyth's greedy scoring
+void optimiseVertexCache(Mesh& mesh);
+
+// Splits cache ordered triangles into clusters where the cache is cold or nearly so, and sorts the clusters
+// so those facing out from the mesh centre come first, to be drawn before the ones they tend to hide
+void optimiseOverdraw(Mesh& mesh);
+
+// Renumbers the vertices in the order the indices first use them, so fetches walk the vertex buffer forwards.
+// Vertices no triangle uses are dropped
+void optimiseVertexFetch(Mesh& mesh);
+
+// Runs every stage in order. Every stage is deterministic, so the same mesh always gives the same buffers
+void optimiseMesh(Mesh& mesh);
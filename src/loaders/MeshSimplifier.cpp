@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "MeshSimplifier.h"
+
+#include "data/Mesh.h"
+#include "data/Prefab.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <queue>
+#include <vector>
+
+// How far the first level may stray from the surface, as a fraction of the prefab's diagonal. Each level doubles it
+constexpr auto lodBaseError = 0.01f;
+
+// Sum of squared distances to a set of planes, kept as the upper triangle of a symmetric 4x4 matrix
+struct Quadric
+{
+    // aa ab ac ad bb bc bd cc cd dd
+    std::array<double, 10> terms{};
+
+    static Quadric fromPlane(const glm::dvec3& normal, double distance)
+    {
+        const auto& n = normal;
+        const auto d = distance;
+        return Quadric{{n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+                        n.y * n.y, n.y * n.z, n.y * d,
+                        n.z * n.z, n.z * d,
+                        d * d}};
+    }
+
+    void add(const Quadric& other)
+    {
+        for(size_t i = 0; i < terms.size(); ++i)
+        {
+            terms[i] += other.terms[i];
+        }
+    }
+
+    double error(const glm::dvec3& p) const
+    {
+        const auto& t = terms;
+        return t[0] * p.x * p.x + 2.0 * t[1] * p.x * p.y + 2.0 * t[2] * p.x * p.z + 2.0 * t[3] * p.x
+             + t[4] * p.y * p.y + 2.0 * t[5] * p.y * p.z + 2.0 * t[6] * p.y
+             + t[7] * p.z * p.z + 2.0 * t[8] * p.z
+             + t[9];
+    }
+};
+
+struct EdgeCollapse
+{
+    double cost{0.0};
+    uint32_t from{0};
+    uint32_t to{0};
+};
+
+// Cheapest first, ties broken by vertex so the result never depends on the queue's implementation
+struct CheaperCollapse
+{
+    bool operator()(const EdgeCollapse& a, const EdgeCollapse& b) const
+    {
+        if(a.cost != b.cost)
+        {
+            return a.cost > b.cost;
+        }
+        return a.from != b.from ? a.from > b.from : a.to > b.to;
+    }
+};
+
+glm::dvec3 triangleNormal(const glm::dvec3& p0, const glm::dvec3& p1, const glm::dvec3& p2)
+{
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+std::unique_ptr<Mesh> simplifyMesh(const Mesh& mesh, size_t targetIndexCount, float maxError)
+{
+    const auto vertexCount = mesh.vertices.size();
+    const auto triangleCount = mesh.indices.size() / 3;
+    auto indices = mesh.indices;
+
+    const auto position = [&](uint32_t vertex) { return glm::dvec3{mesh.vertices[vertex].position}; };
+
+    // Vertices split only by their normals or UVs share a position, which is what the quadrics are kept for
+    auto positionIds = std::vector<uint32_t>(vertexCount);
+    auto positionVertexCounts = std::vector<uint32_t>{};
+    auto positionIdsByValue = std::map<std::array<float, 3>, uint32_t>{};
+    for(size_t i = 0; i < vertexCount; ++i)
+    {
+        const auto& p = mesh.vertices[i].position;
+        const auto [entry, inserted] = positionIdsByValue.emplace(std::array<float, 3>{p.x, p.y, p.z},
+                                                                  static_cast<uint32_t>(positionVertexCounts.size()));
+        if(inserted)
+        {
+            positionVertexCounts.push_back(0);
+        }
+        positionIds[i] = entry->second;
+        positionVertexCounts[entry->second]++;
+    }
+
+    const auto positionCount = positionVertexCounts.size();
+
+    // Moving a seam vertex would tear it from its twins, and moving a border vertex would open a gap
+    auto locked = std::vector<bool>(positionCount, false);
+    for(size_t id = 0; id < positionCount; ++id)
+    {
+        locked[id] = positionVertexCounts[id] > 1;
+    }
+
+    auto edgeTriangleCounts = std::map<std::pair<uint32_t, uint32_t>, uint32_t>{};
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto a = positionIds[indices[t * 3 + e]];
+            const auto b = positionIds[indices[t * 3 + (e + 1) % 3]];
+            edgeTriangleCounts[std::minmax(a, b)]++;
+        }
+    }
+    for(const auto& [edge, count] : edgeTriangleCounts)
+    {
+        if(count == 1)
+        {
+            locked[edge.first] = true;
+            locked[edge.second] = true;
+        }
+    }
+
+    auto quadrics = std::vector<Quadric>(positionCount);
+    auto vertexTriangles = std::vector<std::vector<uint32_t>>(vertexCount);
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        const auto* triangle = &indices[t * 3];
+        for(auto e = 0; e < 3; ++e)
+        {
+            vertexTriangles[triangle[e]].push_back(static_cast<uint32_t>(t));
+        }
+
+        const auto normal = triangleNormal(position(triangle[0]), position(triangle[1]), position(triangle[2]));
+        const auto length = glm::length(normal);
+        if(length <= 0.0)
+        {
+            continue;
+        }
+
+        const auto unitNormal = normal / length;
+        const auto quadric = Quadric::fromPlane(unitNormal, -glm::dot(unitNormal, position(triangle[0])));
+        for(auto e = 0; e < 3; ++e)
+        {
+            quadrics[positionIds[triangle[e]]].add(quadric);
+        }
+    }
+
+    auto triangleRemoved = std::vector<bool>(triangleCount, false);
+    auto vertexRemoved = std::vector<bool>(vertexCount, false);
+
+    const auto collapseCost = [&](uint32_t from, uint32_t to) {
+        auto quadric = quadrics[positionIds[from]];
+        quadric.add(quadrics[positionIds[to]]);
+        return quadric.error(position(to));
+    };
+
+    auto queue = std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, CheaperCollapse>{};
+
+    const auto queueCollapses = [&](uint32_t vertex) {
+        for(const auto t : vertexTriangles[vertex])
+        {
+            if(triangleRemoved[t])
+            {
+                continue;
+            }
+
+            for(auto e = 0; e < 3; ++e)
+            {
+                const auto other = indices[t * 3 + e];
+                if(other == vertex)
+                {
+                    continue;
+                }
+
+                if(!locked[positionIds[vertex]])
+                {
+                    queue.push({collapseCost(vertex, other), vertex, other});
+                }
+                if(!locked[positionIds[other]])
+                {
+                    queue.push({collapseCost(other, vertex), other, vertex});
+                }
+            }
+        }
+    };
+
+    // Each edge is queued from both of its triangles, which only costs a few stale entries
+    for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        queueCollapses(vertex);
+    }
+
+    // Whether the edge still exists, and moving its first vertex onto the second flips or flattens no triangle
+    const auto canCollapse = [&](uint32_t from, uint32_t to) {
+        auto connected = false;
+        for(const auto t : vertexTriangles[from])
+        {
+            if(triangleRemoved[t])
+            {
+                continue;
+            }
+
+            const auto* triangle = &indices[t * 3];
+            if(triangle[0] == to || triangle[1] == to || triangle[2] == to)
+            {
+                connected = true;
+                continue;
+            }
+
+            glm::dvec3 corners[3];
+            glm::dvec3 movedCorners[3];
+            for(auto e = 0; e < 3; ++e)
+            {
+                corners[e] = position(triangle[e]);
+                movedCorners[e] = triangle[e] == from ? position(to) : corners[e];
+            }
+
+            const auto before = triangleNormal(corners[0], corners[1], corners[2]);
+            const auto after = triangleNormal(movedCorners[0], movedCorners[1], movedCorners[2]);
+            if(glm::dot(before, after) <= 0.1 * glm::length(before) * glm::length(after) || glm::length(after) <= 0.0)
+            {
+                return false;
+            }
+        }
+        return connected;
+    };
+
+    const auto targetTriangleCount = targetIndexCount / 3;
+    const auto maxCost = static_cast<double>(maxError) * maxError;
+    auto liveTriangleCount = triangleCount;
+
+    while(liveTriangleCount > targetTriangleCount && !queue.empty())
+    {
+        const auto collapse = queue.top();
+        queue.pop();
+
+        if(collapse.cost > maxCost)
+        {
+            break;
+        }
+
+        if(vertexRemoved[collapse.from] || vertexRemoved[collapse.to])
+        {
+            continue;
+        }
+
+        // Costs go stale as quadrics merge, so an entry that got dearer goes back in at its new cost
+        const auto cost = collapseCost(collapse.from, collapse.to);
+        if(cost > collapse.cost)
+        {
+            queue.push({cost, collapse.from, collapse.to});
+            continue;
+        }
+
+        if(!canCollapse(collapse.from, collapse.to))
+        {
+            continue;
+        }
+
+        for(const auto t : vertexTriangles[collapse.from])
+        {
+            if(triangleRemoved[t])
+            {
+                continue;
+            }
+
+            auto* triangle = &indices[t * 3];
+            if(triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+            {
+                triangleRemoved[t] = true;
+                liveTriangleCount--;
+                continue;
+            }
+
+            std::replace(triangle, triangle + 3, collapse.from, collapse.to);
+            vertexTriangles[collapse.to].push_back(t);
+        }
+
+        vertexRemoved[collapse.from] = true;
+        quadrics[positionIds[collapse.to]].add(quadrics[positionIds[collapse.from]]);
+        queueCollapses(collapse.to);
+    }
+
+    // Keeps only the vertices the remaining triangles use, in the order they are first used
+    auto simplified = std::make_unique<Mesh>();
+    simplified->material = mesh.material;
+
+    auto remap = std::vector<uint32_t>(vertexCount, std::numeric_limits<uint32_t>::max());
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        if(triangleRemoved[t])
+        {
+            continue;
+        }
+
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto vertex = indices[t * 3 + e];
+            if(remap[vertex] == std::numeric_limits<uint32_t>::max())
+            {
+                remap[vertex] = static_cast<uint32_t>(simplified->vertices.size());
+                simplified->vertices.push_back(mesh.vertices[vertex]);
+            }
+            simplified->indices.push_back(remap[vertex]);
+        }
+    }
+
+    return simplified;
+}
+
+void generateLods(Prefab& prefab, size_t lodCount)
+{
+    const auto& box = prefab.boundingBox();
+    const auto diagonal = glm::length(box.max() - box.min());
+
+    for(size_t lod = 1; lod <= lodCount; ++lod)
+    {
+        // Each level starts from the one before, so it only has to halve what is left
+        const auto& previousMeshes = prefab.lodMeshes(lod - 1);
+        const auto maxError = diagonal * lodBaseError * static_cast<float>(1u << (lod - 1));
+
+        auto meshes = std::vector<std::unique_ptr<Mesh>>{};
+        auto previousIndexCount = size_t{0};
+        auto indexCount = size_t{0};
+        for(const auto& mesh : previousMeshes)
+        {
+            auto simplified = simplifyMesh(*mesh, mesh->indices.size() / 2, maxError);
+            previousIndexCount += mesh->indices.size();
+            indexCount += simplified->indices.size();
+            meshes.push_back(std::move(simplified));
+        }
+
+        // Too close to the level before to be worth its memory, and later levels would do no better
+        if(indexCount * 4 > previousIndexCount * 3)
+        {
+            return;
+        }
+
+        prefab.addLod(std::move(meshes));
+    }
+}
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+class Prefab;
+struct Mesh;
+
+// Collapses edges in order of least quadric error until the mesh is down to targetIndexCount indices,
+// or the cheapest collapse left would stray further than maxError from the original surface.
+// Vertices on open borders and on attribute seams never move, so the result has no new cracks
+std::unique_ptr<Mesh> simplifyMesh(const Mesh& mesh, size_t targetIndexCount, float maxError);
+
+// Adds up to lodCount coarser levels to a prefab, each with at most about half the triangles of the one before.
+// Stops early once a level no longer shrinks the prefab by much
+void generateLods(Prefab& prefab, size_t lodCount);
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "MeshletBuilder.h"
+
+#include "data/Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Normals spread wider than this around the axis leave too narrow a cone to ever reject the cluster
+constexpr auto minConeSpread = 0.1f;
+
+void computeMeshletBounds(const Mesh& mesh, Meshlet& meshlet)
+{
+    const auto first = meshlet.firstIndex;
+    const auto end = meshlet.firstIndex + meshlet.indexCount;
+
+    auto boundsMin = glm::vec3{std::numeric_limits<float>::max()};
+    auto boundsMax = glm::vec3{-std::numeric_limits<float>::max()};
+    for(auto i = first; i < end; ++i)
+    {
+        boundsMin = glm::min(boundsMin, mesh.vertices[mesh.indices[i]].position);
+        boundsMax = glm::max(boundsMax, mesh.vertices[mesh.indices[i]].position);
+    }
+
+    const auto center = 0.5f * (boundsMin + boundsMax);
+    auto radius = 0.0f;
+    for(auto i = first; i < end; ++i)
+    {
+        radius = std::max(radius, glm::length(mesh.vertices[mesh.indices[i]].position - center));
+    }
+    meshlet.boundingSphere = glm::vec4{center, radius};
+
+    auto normals = std::vector<glm::vec3>{};
+    auto corners = std::vector<glm::vec3>{};
+    auto axis = glm::vec3{0.0f};
+    for(auto i = first; i + 2 < end; i += 3)
+    {
+        const auto& p0 = mesh.vertices[mesh.indices[i]].position;
+        const auto& p1 = mesh.vertices[mesh.indices[i + 1]].position;
+        const auto& p2 = mesh.vertices[mesh.indices[i + 2]].position;
+
+        const auto normal = glm::cross(p1 - p0, p2 - p0);
+        const auto length = glm::length(normal);
+        if(length <= 0.0f)
+        {
+            continue;
+        }
+
+        normals.push_back(normal / length);
+        corners.push_back(p0);
+        axis += normal / length;
+    }
+
+    const auto axisLength = glm::length(axis);
+    if(normals.empty() || axisLength <= 0.0f)
+    {
+        return;
+    }
+    axis /= axisLength;
+
+    auto minDot = 1.0f;
+    for(const auto& normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+    }
+
+    if(minDot <= minConeSpread)
+    {
+        return;
+    }
+
+    // The apex sits back along the axis far enough that every triangle's plane passes in front of it
+    auto apexDistance = 0.0f;
+    for(size_t t = 0; t < normals.size(); ++t)
+    {
+        apexDistance = std::max(apexDistance, glm::dot(center - corners[t], normals[t]) / glm::dot(axis, normals[t]));
+    }
+
+    meshlet.coneApex = center - axis * apexDistance;
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+void buildMeshlets(Mesh& mesh)
+{
+    mesh.meshlets.clear();
+
+    const auto triangleCount = mesh.indices.size() / 3;
+    if(triangleCount <= maxMeshletTriangles)
+    {
+        return;
+    }
+
+    // Stamped with the meshlet that last used each vertex, so counting a meshlet's vertices needs no clearing
+    auto lastMeshlet = std::vector<size_t>(mesh.vertices.size(), std::numeric_limits<size_t>::max());
+    auto meshlet = Meshlet{};
+    auto vertexCount = size_t{0};
+
+    const auto newVertexCount = [&](const GLuint* triangle) {
+        auto count = size_t{0};
+        for(auto e = 0; e < 3; ++e)
+        {
+            const auto repeated = (e > 0 && triangle[e] == triangle[0]) || (e > 1 && triangle[e] == triangle[1]);
+            if(lastMeshlet[triangle[e]] != mesh.meshlets.size() && !repeated)
+            {
+                count++;
+            }
+        }
+        return count;
+    };
+
+    for(size_t t = 0; t < triangleCount; ++t)
+    {
+        const auto* triangle = &mesh.indices[t * 3];
+
+        auto newVertices = newVertexCount(triangle);
+        if(vertexCount + newVertices > maxMeshletVertices || meshlet.indexCount / 3 + 1 > maxMeshletTriangles)
+        {
+            computeMeshletBounds(mesh, meshlet);
+            mesh.meshlets.push_back(meshlet);
+
+            meshlet = Meshlet{};
+            meshlet.firstIndex = static_cast<GLuint>(t * 3);
+            vertexCount = 0;
+            newVertices = newVertexCount(triangle);
+        }
+
+        for(auto e = 0; e < 3; ++e)
+        {
+            lastMeshlet[triangle[e]] = mesh.meshlets.size();
+        }
+        vertexCount += newVertices;
+        meshlet.indexCount += 3;
+    }
+
+    computeMeshletBounds(mesh, meshlet);
+    mesh.meshlets.push_back(meshlet);
+}
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+
+struct Mesh;
+
+// Small enough for a cluster to cull tightly, and the sizes mesh shading hardware works in
+constexpr size_t maxMeshletVertices = 64;
+constexpr size_t maxMeshletTriangles = 124;
+
+// Cuts the index buffer into meshlets in its current order, which the cache optimiser has already made spatially
+// coherent, so every meshlet is a contiguous index range. Meshes that fit in a single meshlet are given none
+void buildMeshlets(Mesh& mesh);
@@ -5,9 +5,17 @@
 
 #include "core/FileSystem.h"
 #include "data/AssetDatabase.h"
+#include "data/OccluderMesh.h"
+#include "data/Prefab.h"
+#include "data/SceneSettings.h"
 #include "data/Texture.h"
 #include "loaders/GltfLoader.h"
+#include "loaders/HlodCells.h"
+#include "loaders/MeshOptimiser.h"
+#include "loaders/MeshletBuilder.h"
+#include "loaders/MeshSimplifier.h"
 #include "loaders/ScriptLoader.h"
+#include "loaders/StaticBatcher.h"
 #include "loaders/TextureLoader.h"
 #include "scripting/LuaScript.h"
 #include "world/LuaBehaviour.h"
@@ -20,6 +28,9 @@
 
 using json = nlohmann::json;
 
+// Coarser levels generated for each prefab unless it sets its own "lods"
+constexpr auto defaultLodCount = size_t{3};
+
 glm::vec3 loadVec3(const json& json, const std::string& param1, const std::string& param2, const std::string& param3)
 {
     return glm::vec3{json[param1], json[param2], json[param3]};
@@ -113,6 +124,34 @@ void loadPointLightComponent(const json& json, Entity entity, World& world)
     {
         lightComponent.light.radius = json["radius"];
     }
+    if(json.contains("castShadows"))
+    {
+        lightComponent.light.castShadows = json["castShadows"];
+    }
+}
+
+void loadTerrainComponent(const json& json, Entity entity, World& world)
+{
+    if(!json.contains("heightmap"))
+    {
+        return;
+    }
+
+    auto& terrainComponent = world.addComponent<TerrainComponent>(entity);
+    terrainComponent.heightmapPath = GetTerrainDir() / json["heightmap"];
+
+    if(json.contains("size"))
+    {
+        terrainComponent.size = json["size"];
+    }
+    if(json.contains("height"))
+    {
+        terrainComponent.height = json["height"];
+    }
+    if(json.contains("color"))
+    {
+        terrainComponent.color = loadRGB(json["color"]);
+    }
 }
 
 void loadCameraComponent(const json& json, Entity entity, AssetDatabase& assetDb, World& world)
@@ -158,6 +197,10 @@ void loadComponents(const json& json, Entity entity, AssetDatabase& assetDb, Wor
     {
         loadPointLightComponent(json["PointLightComponent"], entity, world);
     }
+    if(json.contains("TerrainComponent"))
+    {
+        loadTerrainComponent(json["TerrainComponent"], entity, world);
+    }
     if(json.contains("CameraComponent"))
     {
         loadCameraComponent(json["CameraComponent"], entity, assetDb, world);
@@ -174,6 +217,27 @@ void loadEntity(const json& json, AssetDatabase& assetDb, World& world, LuaState
     }
 }
 
+// Gathers every mesh of a prefab into one triangle list
+std::unique_ptr<OccluderMesh> occluderFromPrefab(const Prefab& prefab)
+{
+    auto occluder = std::make_unique<OccluderMesh>();
+
+    for(const auto& mesh : prefab.meshes())
+    {
+        const auto firstVertex = static_cast<uint32_t>(occluder->positions.size());
+        for(const auto& vertex : mesh->vertices)
+        {
+            occluder->positions.push_back(vertex.position);
+        }
+        for(const auto index : mesh->indices)
+        {
+            occluder->indices.push_back(firstVertex + index);
+        }
+    }
+
+    return occluder;
+}
+
 void loadPrefab(const json& json, AssetDatabase& assetDb)
 {
     if(!json.contains("id") || !json.contains("path"))
@@ -187,6 +251,55 @@ void loadPrefab(const json& json, AssetDatabase& assetDb)
         return;
     }
 
+    generateLods(*prefab, json.contains("lods") ? json["lods"].get<size_t>() : defaultLodCount);
+
+    // Index order comes from the authoring tool, which rarely cares about the vertex cache
+    auto statsBefore = VertexCacheStats{};
+    auto statsAfter = VertexCacheStats{};
+    auto lodTriangles = std::string{};
+    auto meshletCount = size_t{0};
+    for(size_t lod = 0; lod < prefab->lodCount(); ++lod)
+    {
+        auto triangleCount = size_t{0};
+        for(const auto& mesh : prefab->lodMeshes(lod))
+        {
+            statsBefore += analyseVertexCache(mesh->indices, mesh->vertices.size());
+            optimiseMesh(*mesh);
+            statsAfter += analyseVertexCache(mesh->indices, mesh->vertices.size());
+            triangleCount += mesh->indices.size() / 3;
+
+            // After optimising, so each meshlet is a cache friendly run of the final index order
+            buildMeshlets(*mesh);
+            meshletCount += mesh->meshlets.size();
+        }
+        lodTriangles += (lodTriangles.empty() ? "" : ", ") + std::to_string(triangleCount);
+    }
+
+    std::cout << "Prefab " << json["id"].get<std::string>() << " triangles per LOD: " << lodTriangles
+              << ", ACMR " << statsBefore.acmr() << " -> " << statsAfter.acmr()
+              << ", ATVR " << statsBefore.atvr() << " -> " << statsAfter.atvr()
+              << ", " << meshletCount << " meshlets\n";
+
+    // "self" for prefabs simple enough to occlude with their own meshes, otherwise a simplified model
+    // that must fit inside them
+    if(json.contains("occluder"))
+    {
+        if(json["occluder"] == "self")
+        {
+            prefab->setOccluder(occluderFromPrefab(*prefab));
+        }
+        else if(auto occluderModel = loadGLTFModel(GetPrefabsDir() / json["occluder"]))
+        {
+            prefab->setOccluder(occluderFromPrefab(*occluderModel));
+        }
+    }
+
+    // For prefabs placed by the hundred, such as trees and crowds, whose distant copies need not be geometry
+    if(json.contains("impostor"))
+    {
+        prefab->setImpostorEnabled(json["impostor"]);
+    }
+
     assetDb.addPrefab(json["id"], std::move(prefab));
 }
 
@@ -228,12 +341,60 @@ void loadSkybox(const json& json, AssetDatabase& assetDb)
     assetDb.addSkybox(json["id"], std::move(skybox));
 }
 
-bool loadScene(const std::filesystem::path& path, AssetDatabase& assetDb, World& world, LuaState& lua)
+void loadSceneSettings(const json& json, SceneSettings& settings)
+{
+    if(json.contains("depthPrePass"))
+    {
+        settings.depthPrePass = json["depthPrePass"];
+    }
+
+    if(json.contains("quantiseVertices"))
+    {
+        settings.quantiseVertices = json["quantiseVertices"];
+    }
+
+    if(json.contains("gpuCulling"))
+    {
+        settings.gpuCulling = json["gpuCulling"];
+    }
+
+    if(json.contains("occlusionCulling"))
+    {
+        settings.occlusionCulling = json["occlusionCulling"];
+    }
+
+    if(json.contains("cpuOcclusionCulling"))
+    {
+        settings.cpuOcclusionCulling = json["cpuOcclusionCulling"];
+    }
+
+    if(json.contains("staticBatching"))
+    {
+        settings.staticBatching = json["staticBatching"];
+    }
+
+    if(json.contains("impostorScreenSize"))
+    {
+        settings.impostorScreenSize = json["impostorScreenSize"];
+    }
+
+    if(json.contains("hlodDistance"))
+    {
+        settings.hlodDistance = json["hlodDistance"];
+    }
+}
+
+bool loadScene(const std::filesystem::path& path, AssetDatabase& assetDb, World& world, LuaState& lua, SceneSettings& settings)
 {
     auto filestream = std::ifstream{path};
 
     auto sceneJson = json::parse(filestream);
 
+    if(sceneJson.contains("settings"))
+    {
+        loadSceneSettings(sceneJson["settings"], settings);
+    }
+
     for(const auto& prefabJson : sceneJson["prefabs"])
     {
         loadPrefab(prefabJson, assetDb);
@@ -249,5 +410,15 @@ bool loadScene(const std::filesystem::path& path, AssetDatabase& assetDb, World&
         loadEntity(entityJson, assetDb, world, lua);
     }
 
+    if(settings.staticBatching)
+    {
+        batchStaticMeshes(assetDb, world);
+    }
+
+    if(settings.hlodDistance > 0.0f)
+    {
+        buildHlodCells(assetDb, world);
+    }
+
     return true;
 }
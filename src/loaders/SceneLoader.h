@@ -9,4 +9,6 @@ class AssetDatabase;
 class LuaState;
 class World;
 
-bool loadScene(const std::filesystem::path& path, AssetDatabase& assetDb, World& world, LuaState& lua);
+struct SceneSettings;
+
+bool loadScene(const std::filesystem::path& path, AssetDatabase& assetDb, World& world, LuaState& lua, SceneSettings& settings);
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "StaticBatcher.h"
+
+#include "data/AssetDatabase.h"
+#include "data/Mesh.h"
+#include "data/OccluderMesh.h"
+#include "data/Prefab.h"
+#include "loaders/MeshletBuilder.h"
+#include "world/World.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Edge of the grid cells static geometry is gathered into. Small enough for a cell to cull usefully,
+// large enough for thousands of props to land in tens of chunks
+constexpr auto staticCellSize = 32.0f;
+
+// Chunk meshes stay small enough for 16-bit indices
+constexpr size_t maxChunkVertices = 65536;
+
+struct StaticInstance
+{
+    Entity entity{0};
+    const Prefab* prefab{nullptr};
+    glm::mat4 transform{1.0f};
+};
+
+// Appends a mesh in world space, starting a new chunk mesh for its material when the current one is full
+void appendStaticMesh(const Mesh& mesh, const glm::mat4& transform, std::vector<std::unique_ptr<Mesh>>& chunkMeshes)
+{
+    auto chunk = std::find_if(chunkMeshes.rbegin(), chunkMeshes.rend(), [&](const auto& chunkMesh) {
+        return chunkMesh->material == mesh.material;
+    });
+
+    if(chunk == chunkMeshes.rend() || (*chunk)->vertices.size() + mesh.vertices.size() > maxChunkVertices)
+    {
+        auto chunkMesh = std::make_unique<Mesh>();
+        chunkMesh->material = mesh.material;
+        chunkMeshes.push_back(std::move(chunkMesh));
+        chunk = chunkMeshes.rbegin();
+    }
+
+    auto& target = **chunk;
+    const auto normalMatrix = glm::transpose(glm::inverse(glm::mat3{transform}));
+    const auto firstVertex = static_cast<GLuint>(target.vertices.size());
+
+    for(auto vertex : mesh.vertices)
+    {
+        vertex.position = glm::vec3(transform * glm::vec4(vertex.position, 1.0f));
+        vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+        target.vertices.push_back(vertex);
+    }
+
+    for(const auto index : mesh.indices)
+    {
+        target.indices.push_back(firstVertex + index);
+    }
+}
+
+std::unique_ptr<Prefab> buildStaticChunk(const std::vector<StaticInstance>& instances)
+{
+    auto chunk = std::make_unique<Prefab>();
+
+    // A level the chunk has but a member lacks falls back to the member's coarsest
+    auto lodCount = size_t{1};
+    for(const auto& instance : instances)
+    {
+        lodCount = std::max(lodCount, instance.prefab->lodCount());
+    }
+
+    for(size_t lod = 0; lod < lodCount; ++lod)
+    {
+        auto chunkMeshes = std::vector<std::unique_ptr<Mesh>>{};
+        for(const auto& instance : instances)
+        {
+            for(const auto& mesh : instance.prefab->lodMeshes(std::min(lod, instance.prefab->lodCount() - 1)))
+            {
+                appendStaticMesh(*mesh, instance.transform, chunkMeshes);
+            }
+        }
+
+        // Members keep their optimised order, only the meshlets have to be cut again across the whole chunk
+        for(auto& chunkMesh : chunkMeshes)
+        {
+            buildMeshlets(*chunkMesh);
+        }
+
+        if(lod == 0)
+        {
+            for(auto& chunkMesh : chunkMeshes)
+            {
+                chunk->addMesh(std::move(chunkMesh));
+            }
+        }
+        else
+        {
+            chunk->addLod(std::move(chunkMeshes));
+        }
+    }
+
+    auto occluder = std::make_unique<OccluderMesh>();
+    for(const auto& instance : instances)
+    {
+        const auto* memberOccluder = instance.prefab->occluder();
+        if(!memberOccluder)
+        {
+            continue;
+        }
+
+        const auto firstPosition = static_cast<uint32_t>(occluder->positions.size());
+        for(const auto& position : memberOccluder->positions)
+        {
+            occluder->positions.push_back(glm::vec3(instance.transform * glm::vec4(position, 1.0f)));
+        }
+
+        for(const auto index : memberOccluder->indices)
+        {
+            occluder->indices.push_back(firstPosition + index);
+        }
+    }
+
+    if(!occluder->indices.empty())
+    {
+        chunk->setOccluder(std::move(occluder));
+    }
+
+    return chunk;
+}
+
+void batchStaticMeshes(AssetDatabase& assetDb, World& world)
+{
+    auto instances = std::vector<StaticInstance>{};
+    for(auto& [entity, meshComponent] : world.getAllComponents<MeshRendererComponent>())
+    {
+        if(!meshComponent.prefab || world.getComponent<BehaviourComponent>(entity))
+        {
+            continue;
+        }
+
+        // Drawn as quads from far away, which costs less than any chunk they could join
+        if(meshComponent.prefab->impostorEnabled())
+        {
+            continue;
+        }
+
+        const auto* transform = world.getComponent<TransformComponent>(entity);
+        if(!transform)
+        {
+            continue;
+        }
+
+        instances.push_back({entity, meshComponent.prefab, transform->matrix()});
+    }
+
+    // The component storage is unordered, so sort to build the same chunks on every run
+    std::sort(instances.begin(), instances.end(), [](const auto& a, const auto& b) { return a.entity < b.entity; });
+
+    auto cells = std::map<std::array<int, 3>, std::vector<StaticInstance>>{};
+    for(const auto& instance : instances)
+    {
+        auto box = instance.prefab->boundingBox();
+        box.transform(instance.transform);
+
+        const auto cell = glm::floor(box.center() / staticCellSize);
+        cells[{static_cast<int>(cell.x), static_cast<int>(cell.y), static_cast<int>(cell.z)}].push_back(instance);
+    }
+
+    auto mergedCount = size_t{0};
+    auto chunkCount = size_t{0};
+    for(const auto& [cell, cellInstances] : cells)
+    {
+        // A lone entity gains nothing from being merged with itself
+        if(cellInstances.size() < 2)
+        {
+            continue;
+        }
+
+        auto chunk = buildStaticChunk(cellInstances);
+        auto* chunkPrefab = chunk.get();
+        assetDb.addPrefab("static_chunk_" + std::to_string(chunkCount), std::move(chunk));
+
+        const auto chunkEntity = world.createEntity();
+        world.addComponent<TransformComponent>(chunkEntity);
+        world.addComponent<MeshRendererComponent>(chunkEntity).prefab = chunkPrefab;
+
+        for(const auto& instance : cellInstances)
+        {
+            world.removeComponent<MeshRendererComponent>(instance.entity);
+        }
+
+        mergedCount += cellInstances.size();
+        chunkCount++;
+    }
+
+    std::cout << "Static batching: " << mergedCount << " entities merged into " << chunkCount << " chunks\n";
+}
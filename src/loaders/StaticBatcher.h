@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+class AssetDatabase;
+class World;
+
+// Merges the meshes of entities that never move, those without a BehaviourComponent, into world space chunks.
+// Each chunk covers one cell of a grid so culling still has something to work with, and holds a mesh per material,
+// so a scene full of static props draws in a few calls per cell. Chunks are added to the asset database as prefabs,
+// drawn by new entities, and the merged entities keep everything but their MeshRendererComponent.
+// Prefabs with impostors are left alone
+void batchStaticMeshes(AssetDatabase& assetDb, World& world);
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "rendering/GlStateCache.h"
+
 #include <glad/gl.h>
 
 #include <vector>
@@ -16,9 +18,15 @@ class Buffer
             glCreateBuffers(1, &m_handle);
             glNamedBufferStorage(m_handle, data.size() * sizeof(DataType), data.data(), GL_DYNAMIC_STORAGE_BIT);
         }
+        explicit Buffer(size_t count)
+        {
+            glCreateBuffers(1, &m_handle);
+            glNamedBufferStorage(m_handle, count * sizeof(DataType), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        }
         ~Buffer()
         {
             glDeleteBuffers(1, &m_handle);
+            GlStateCache::instance().onBufferDeleted(m_handle);
         }
 
         Buffer(const Buffer& other) = delete;
@@ -27,6 +35,26 @@ class Buffer
         Buffer& operator=(const Buffer& other) = delete;
         Buffer& operator=(Buffer&& other) = delete;
 
+        void write(const std::vector<DataType>& data, size_t offset = 0) const
+        {
+            write(data.data(), data.size(), offset);
+        }
+
+        void write(const DataType* data, size_t count, size_t offset) const
+        {
+            glNamedBufferSubData(m_handle, offset * sizeof(DataType), count * sizeof(DataType), data);
+        }
+
+        // GPU side copy, the ranges must not overlap if source is this buffer
+        void copy(const Buffer& source, size_t sourceOffset, size_t offset, size_t count) const
+        {
+            glCopyNamedBufferSubData(source.m_handle,
+                                     m_handle,
+                                     sourceOffset * sizeof(DataType),
+                                     offset * sizeof(DataType),
+                                     count * sizeof(DataType));
+        }
+
         inline GLuint handle() const
         {
             return m_handle;
@@ -3,12 +3,44 @@
 
 #pragma once
 
+#include <glad/gl.h>
+
 #include <glm/glm.hpp>
 
 class Mesh;
+struct ImpostorAtlas;
+
+// Where a mesh lives in the MeshBuffer, copied into each draw so the passes need no lookups to submit it
+struct GpuMesh
+{
+    GLsizei indexCount{0};
+    GLenum indexType{GL_UNSIGNED_INT};
+    // Counted in indices of indexType
+    GLuint firstIndex{0};
+    GLint baseVertex{0};
+    glm::mat4 positionDequantisation{1.0f};
+
+    // Byte offset of the first index, as passed to the glDrawElements family
+    inline const void* indexPointer() const
+    {
+        const auto indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        return reinterpret_cast<const void*>(firstIndex * indexSize);
+    }
+};
 
 struct DrawCommand
 {
     Mesh* mesh;
     glm::mat4 transform;
+    // Set by the renderer from the mesh buffer when the command is queued
+    GpuMesh gpuMesh{};
+    // Set when the CPU occlusion test found the draw hidden. Camera passes skip it, shadow passes still draw it
+    bool hiddenFromCamera{false};
+};
+
+// A distant prefab instance drawn as one quad from the prefab's baked atlas
+struct ImpostorDrawCommand
+{
+    const ImpostorAtlas* atlas;
+    glm::mat4 transform;
 };
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "FramePasses.h"
+
+void addFramePasses(RenderGraph& graph,
+                    const FramePassOptions& options,
+                    const std::unordered_map<std::string, RenderGraph::ExecuteFunction>& executes)
+{
+    const auto execute = [&executes](const std::string& name) -> RenderGraph::ExecuteFunction {
+        if(const auto itr = executes.find(name); itr != executes.end())
+        {
+            return itr->second;
+        }
+        return [](const RenderGraph&) {};
+    };
+
+    const auto width = options.width;
+    const auto height = options.height;
+    const auto useDepthPrePass = options.depthPrePass;
+    const auto countOverdraw = options.countOverdraw;
+    const auto useOcclusionCulling = options.gpuCulling && options.occlusionCulling;
+
+    graph.markOutput("backbuffer");
+
+    // The pyramid is read by the next frame, so it is a result of this one
+    if(useOcclusionCulling)
+    {
+        graph.markOutput("scene.hiz");
+    }
+
+    // Every mesh pass reads its transforms and bounds from the one upload
+    graph.addPass("Instances",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.write("scene.instances");
+        },
+        execute("Instances")
+    );
+
+    graph.addPass("DirectionalShadow",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.read("scene.instances");
+            builder.write("shadow.directional");
+        },
+        execute("DirectionalShadow")
+    );
+
+    graph.addPass("PointLightShadow",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.read("scene.instances");
+            builder.write("shadow.point");
+        },
+        execute("PointLightShadow")
+    );
+
+    if(useDepthPrePass)
+    {
+        graph.addPass("DepthPrePass",
+            [width, height, useOcclusionCulling](RenderGraphBuilder& builder)
+            {
+                builder.read("scene.instances");
+                builder.create("gbuffer.depth", {GL_DEPTH24_STENCIL8, width, height, GL_NEAREST});
+                if(useOcclusionCulling)
+                {
+                    builder.write("scene.hiz");
+                }
+            },
+            execute("DepthPrePass")
+        );
+    }
+
+    graph.addPass("GBuffer",
+        [width, height, useDepthPrePass, countOverdraw, useOcclusionCulling](RenderGraphBuilder& builder)
+        {
+            builder.read("scene.instances");
+            if(useOcclusionCulling)
+            {
+                builder.write("scene.hiz");
+            }
+            builder.create("gbuffer.color", {GL_RGBA8, width, height, GL_LINEAR});
+            builder.create("gbuffer.normal", {GL_RG16, width, height, GL_NEAREST});
+            if(useDepthPrePass)
+            {
+                builder.write("gbuffer.depth");
+            }
+            else
+            {
+                builder.create("gbuffer.depth", {GL_DEPTH24_STENCIL8, width, height, GL_NEAREST});
+            }
+            if(countOverdraw)
+            {
+                builder.create("gbuffer.overdraw", {GL_R16F, width, height, GL_NEAREST});
+            }
+        },
+        execute("GBuffer")
+    );
+
+    // Before the pyramid is built, so impostors hide what is behind them too
+    graph.addPass("Impostors",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.write("gbuffer.color");
+            builder.write("gbuffer.normal");
+            builder.write("gbuffer.depth");
+        },
+        execute("Impostors")
+    );
+
+    if(useOcclusionCulling)
+    {
+        // Reduces the finished depth, so next frame's mesh passes can skip what it hides before drawing
+        graph.addPass("HiZ",
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read("gbuffer.depth");
+                builder.write("scene.hiz");
+            },
+            execute("HiZ")
+        );
+    }
+
+    graph.addPass("LightCulling",
+        [](RenderGraphBuilder& builder)
+        {
+            // Not sampled, but the light list carries the shadow cube assigned to each light by that pass
+            builder.read("shadow.point");
+            builder.write("lights.list");
+            builder.write("lights.grid");
+            builder.write("lights.indices");
+        },
+        execute("LightCulling")
+    );
+
+    graph.addPass("Lighting",
+        [width, height](RenderGraphBuilder& builder)
+        {
+            builder.read("gbuffer.color");
+            builder.read("gbuffer.normal");
+            builder.read("gbuffer.depth");
+            builder.read("shadow.directional");
+            builder.read("shadow.point");
+            builder.read("lights.list");
+            builder.read("lights.grid");
+            builder.read("lights.indices");
+            builder.create("scene.color", {GL_RGBA16F, width, height, GL_LINEAR});
+        },
+        execute("Lighting")
+    );
+
+    if(options.lightVolumes)
+    {
+        graph.addPass("PointLightVolumes",
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read("gbuffer.color");
+                builder.read("gbuffer.normal");
+                // Tested against and sampled, never written. The stencil the pass marks shares the texture,
+                // but it is cleared and used up within the pass, so it is no new version for anyone else
+                builder.read("gbuffer.depth");
+                builder.read("shadow.point");
+                builder.read("lights.list");
+                builder.write("scene.color");
+            },
+            execute("PointLightVolumes")
+        );
+    }
+
+    graph.addPass("Skybox",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.write("scene.color");
+        },
+        execute("Skybox")
+    );
+
+    if(countOverdraw)
+    {
+        graph.addPass("Overdraw",
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read("gbuffer.overdraw");
+                builder.write("scene.color");
+            },
+            execute("Overdraw")
+        );
+    }
+
+    graph.addPass("Present",
+        [](RenderGraphBuilder& builder)
+        {
+            builder.read("scene.color");
+            builder.write("backbuffer");
+        },
+        execute("Present")
+    );
+}
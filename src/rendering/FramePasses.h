@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/RenderGraph.h"
+
+#include <glad/gl.h>
+
+#include <string>
+#include <unordered_map>
+
+// The renderer settings that change which passes a frame holds
+struct FramePassOptions
+{
+    GLsizei width{0};
+    GLsizei height{0};
+    bool lightVolumes{false};
+    bool depthPrePass{false};
+    bool countOverdraw{false};
+    bool gpuCulling{false};
+    // Only takes effect with GPU culling
+    bool occlusionCulling{false};
+};
+
+// Adds the renderer's passes to the graph with the resources each one touches, and marks the frame's results.
+// Each pass runs the function registered under its name, or nothing when there is none, so the layout can be
+// scheduled without a renderer or GL context
+void addFramePasses(RenderGraph& graph,
+                    const FramePassOptions& options,
+                    const std::unordered_map<std::string, RenderGraph::ExecuteFunction>& executes);
@@ -4,6 +4,7 @@
 #include "Framebuffer.h"
 
 #include "data/Texture.h"
+#include "rendering/GlStateCache.h"
 
 #include <stdexcept>
 #include <string>
@@ -16,6 +17,7 @@ Framebuffer::Framebuffer()
 Framebuffer::~Framebuffer()
 {
     glDeleteFramebuffers(1, &m_handle);
+    GlStateCache::instance().onFramebufferDeleted(m_handle);
 }
 
 void Framebuffer::attachTexture(GLenum attachment, Texture& texture, GLint level) const
@@ -45,10 +47,10 @@ void Framebuffer::setReadBuffer(GLenum buffer) const
 
 void Framebuffer::bind() const
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_handle);
+    GlStateCache::instance().bindFramebuffer(GL_FRAMEBUFFER, m_handle);
 }
 
 void Framebuffer::unbind() const
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlStateCache::instance().bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "FreeListAllocator.h"
+
+#include <algorithm>
+
+FreeListAllocator::FreeListAllocator(size_t capacity)
+    : m_capacity{capacity}
+    , m_freeSpace{capacity}
+{
+    if(capacity > 0)
+    {
+        m_freeRanges[0] = capacity;
+    }
+}
+
+std::optional<size_t> FreeListAllocator::allocate(size_t size, size_t alignment)
+{
+    if(size == 0)
+    {
+        return size_t{0};
+    }
+
+    for(auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+    {
+        const auto [rangeOffset, rangeSize] = *it;
+        const auto offset = (rangeOffset + alignment - 1) / alignment * alignment;
+        const auto padding = offset - rangeOffset;
+        if(padding + size > rangeSize)
+        {
+            continue;
+        }
+
+        // The range is split into the alignment padding, the allocation and whatever is left after it
+        m_freeRanges.erase(it);
+        if(padding > 0)
+        {
+            m_freeRanges[rangeOffset] = padding;
+        }
+        if(padding + size < rangeSize)
+        {
+            m_freeRanges[offset + size] = rangeSize - padding - size;
+        }
+
+        m_freeSpace -= size;
+        return offset;
+    }
+
+    return std::nullopt;
+}
+
+void FreeListAllocator::free(size_t offset, size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    m_freeSpace += size;
+
+    auto it = m_freeRanges.emplace(offset, size).first;
+
+    // Merge with the following range, then with the preceding one
+    const auto next = std::next(it);
+    if(next != m_freeRanges.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        m_freeRanges.erase(next);
+    }
+
+    if(it != m_freeRanges.begin())
+    {
+        const auto previous = std::prev(it);
+        if(previous->first + previous->second == it->first)
+        {
+            previous->second += it->second;
+            m_freeRanges.erase(it);
+        }
+    }
+}
+
+size_t FreeListAllocator::largestFreeRange() const
+{
+    auto largest = size_t{0};
+    for(const auto& [offset, size] : m_freeRanges)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
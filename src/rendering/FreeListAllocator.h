@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+
+// Hands out ranges of a fixed size arena, such as a preallocated GPU buffer. Free ranges are kept
+// sorted by offset and merged with their neighbours when released, and allocation takes the first fit,
+// so an empty allocator packs allocations from the start in the order they are made
+class FreeListAllocator
+{
+    public:
+        explicit FreeListAllocator(size_t capacity);
+
+        FreeListAllocator(const FreeListAllocator& other) = delete;
+        FreeListAllocator(FreeListAllocator&& other) = delete;
+
+        FreeListAllocator& operator=(const FreeListAllocator& other) = delete;
+        FreeListAllocator& operator=(FreeListAllocator&& other) = delete;
+
+        // Returns the offset of the range, or nothing if no free range is large enough
+        std::optional<size_t> allocate(size_t size, size_t alignment = 1);
+
+        void free(size_t offset, size_t size);
+
+        // Largest allocation that can currently succeed, ignoring alignment
+        size_t largestFreeRange() const;
+
+        inline size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        inline size_t freeSpace() const
+        {
+            return m_freeSpace;
+        }
+
+    private:
+        // Offset to size
+        std::map<size_t, size_t> m_freeRanges;
+        size_t m_capacity{0};
+        size_t m_freeSpace{0};
+};
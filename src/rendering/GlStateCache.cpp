@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "GlStateCache.h"
+
+std::optional<GLuint>& slotAt(std::vector<std::optional<GLuint>>& slots, GLuint index)
+{
+    if(index >= slots.size())
+    {
+        slots.resize(index + 1);
+    }
+
+    return slots[index];
+}
+
+void forgetName(std::vector<std::optional<GLuint>>& slots, GLuint name)
+{
+    for(auto& slot : slots)
+    {
+        if(slot && *slot == name)
+        {
+            slot.reset();
+        }
+    }
+}
+
+GlStateCache& GlStateCache::instance()
+{
+    static auto cache = GlStateCache{};
+    return cache;
+}
+
+void GlStateCache::invalidate()
+{
+    m_capabilities.clear();
+    m_blendFunc.reset();
+    m_depthFunc.reset();
+    m_depthMask.reset();
+    m_colorMask.reset();
+    m_cullFace.reset();
+    m_stencilFunc.reset();
+    m_frontStencilOp.reset();
+    m_backStencilOp.reset();
+    m_stencilMask.reset();
+    m_viewport.reset();
+
+    m_program.reset();
+    m_vertexArray.reset();
+    m_readFramebuffer.reset();
+    m_drawFramebuffer.reset();
+    m_textureUnits.clear();
+    m_bufferBases.clear();
+}
+
+void GlStateCache::beginFrame()
+{
+    m_lastFrameStats = m_stats;
+    m_stats = Stats{};
+}
+
+void GlStateCache::setEnabled(GLenum capability, bool enabled)
+{
+    if(!update(m_capabilities[capability], enabled))
+    {
+        return;
+    }
+
+    if(enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+}
+
+void GlStateCache::setBlendFunc(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha)
+{
+    if(update(m_blendFunc, std::array<GLenum, 4>{srcRgb, dstRgb, srcAlpha, dstAlpha}))
+    {
+        glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+    }
+}
+
+void GlStateCache::setDepthFunc(GLenum func)
+{
+    if(update(m_depthFunc, func))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void GlStateCache::setDepthMask(bool enabled)
+{
+    if(update(m_depthMask, enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GlStateCache::setColorMask(bool enabled)
+{
+    if(update(m_colorMask, enabled))
+    {
+        const auto mask = enabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+    }
+}
+
+void GlStateCache::setCullFace(GLenum face)
+{
+    if(update(m_cullFace, face))
+    {
+        glCullFace(face);
+    }
+}
+
+void GlStateCache::setStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    if(update(m_stencilFunc, std::array<GLuint, 3>{func, static_cast<GLuint>(ref), mask}))
+    {
+        glStencilFunc(func, ref, mask);
+    }
+}
+
+void GlStateCache::setStencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    const auto ops = std::array<GLenum, 3>{stencilFail, depthFail, depthPass};
+    switch(face)
+    {
+        case GL_FRONT:
+            if(update(m_frontStencilOp, ops))
+            {
+                glStencilOpSeparate(GL_FRONT, stencilFail, depthFail, depthPass);
+            }
+            break;
+        case GL_BACK:
+            if(update(m_backStencilOp, ops))
+            {
+                glStencilOpSeparate(GL_BACK, stencilFail, depthFail, depthPass);
+            }
+            break;
+        default:
+            if(m_frontStencilOp == ops && m_backStencilOp == ops)
+            {
+                m_stats.filtered++;
+                return;
+            }
+
+            m_frontStencilOp = ops;
+            m_backStencilOp = ops;
+            m_stats.issued++;
+            glStencilOpSeparate(GL_FRONT_AND_BACK, stencilFail, depthFail, depthPass);
+            break;
+    }
+}
+
+void GlStateCache::setStencilMask(GLuint mask)
+{
+    if(update(m_stencilMask, mask))
+    {
+        glStencilMask(mask);
+    }
+}
+
+void GlStateCache::setViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if(update(m_viewport, std::array<GLint, 4>{x, y, width, height}))
+    {
+        glViewport(x, y, width, height);
+    }
+}
+
+void GlStateCache::useProgram(GLuint program)
+{
+    if(update(m_program, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+void GlStateCache::bindVertexArray(GLuint vertexArray)
+{
+    if(update(m_vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GlStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    switch(target)
+    {
+        case GL_READ_FRAMEBUFFER:
+            if(update(m_readFramebuffer, framebuffer))
+            {
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            }
+            break;
+        case GL_DRAW_FRAMEBUFFER:
+            if(update(m_drawFramebuffer, framebuffer))
+            {
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            }
+            break;
+        default:
+            if(m_readFramebuffer == framebuffer && m_drawFramebuffer == framebuffer)
+            {
+                m_stats.filtered++;
+                return;
+            }
+
+            m_readFramebuffer = framebuffer;
+            m_drawFramebuffer = framebuffer;
+            m_stats.issued++;
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            break;
+    }
+}
+
+void GlStateCache::bindTextureUnit(GLuint unit, GLuint texture)
+{
+    if(update(slotAt(m_textureUnits, unit), texture))
+    {
+        glBindTextureUnit(unit, texture);
+    }
+}
+
+void GlStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    if(update(slotAt(m_bufferBases[target], index), buffer))
+    {
+        glBindBufferBase(target, index, buffer);
+    }
+}
+
+void GlStateCache::onProgramDeleted(GLuint program)
+{
+    // Deleting the bound program defers the delete until it is unbound, so drop the binding too
+    if(m_program == program)
+    {
+        m_program.reset();
+    }
+}
+
+void GlStateCache::onVertexArrayDeleted(GLuint vertexArray)
+{
+    // Deleting a bound object reverts the binding to zero
+    if(m_vertexArray == vertexArray)
+    {
+        m_vertexArray = 0;
+    }
+}
+
+void GlStateCache::onFramebufferDeleted(GLuint framebuffer)
+{
+    if(m_readFramebuffer == framebuffer)
+    {
+        m_readFramebuffer = 0;
+    }
+
+    if(m_drawFramebuffer == framebuffer)
+    {
+        m_drawFramebuffer = 0;
+    }
+}
+
+void GlStateCache::onTextureDeleted(GLuint texture)
+{
+    forgetName(m_textureUnits, texture);
+}
+
+void GlStateCache::onBufferDeleted(GLuint buffer)
+{
+    for(auto& [target, slots] : m_bufferBases)
+    {
+        forgetName(slots, buffer);
+    }
+}
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Shadows the GL state touched by the renderer and only forwards calls that actually change it.
+// There is a single GL context, so there is a single cache shared by every pass and GL object wrapper.
+class GlStateCache
+{
+    public:
+        struct Stats
+        {
+            uint32_t issued{0};
+            uint32_t filtered{0};
+        };
+
+        static GlStateCache& instance();
+
+        GlStateCache(const GlStateCache& other) = delete;
+        GlStateCache(GlStateCache&& other) = delete;
+
+        GlStateCache& operator=(const GlStateCache& other) = delete;
+        GlStateCache& operator=(GlStateCache&& other) = delete;
+
+        // Forgets all shadowed state, so the next call for each piece of state is forwarded to the driver.
+        // Needed after any code changes GL state without going through the cache
+        void invalidate();
+
+        // Stores the counters of the frame that just finished and starts counting again
+        void beginFrame();
+
+        void setEnabled(GLenum capability, bool enabled);
+        void setBlendFunc(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha);
+        void setDepthFunc(GLenum func);
+        void setDepthMask(bool enabled);
+        void setColorMask(bool enabled);
+        void setCullFace(GLenum face);
+        void setStencilFunc(GLenum func, GLint ref, GLuint mask);
+        void setStencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+        // Also masks stencil clears, so leave it at 0xff for the passes after
+        void setStencilMask(GLuint mask);
+        void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+        void useProgram(GLuint program);
+        void bindVertexArray(GLuint vertexArray);
+        void bindFramebuffer(GLenum target, GLuint framebuffer);
+        void bindTextureUnit(GLuint unit, GLuint texture);
+        void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        // Called when a GL object is deleted, since GL may recycle its name for a new object
+        void onProgramDeleted(GLuint program);
+        void onVertexArrayDeleted(GLuint vertexArray);
+        void onFramebufferDeleted(GLuint framebuffer);
+        void onTextureDeleted(GLuint texture);
+        void onBufferDeleted(GLuint buffer);
+
+        inline const Stats& lastFrameStats() const
+        {
+            return m_lastFrameStats;
+        }
+
+    private:
+        GlStateCache() = default;
+
+        // Returns true if the call needs forwarding to the driver, updating the shadowed value and counters
+        template <typename ValueType>
+        bool update(std::optional<ValueType>& cached, const ValueType& value)
+        {
+            if(cached && *cached == value)
+            {
+                m_stats.filtered++;
+                return false;
+            }
+
+            cached = value;
+            m_stats.issued++;
+            return true;
+        }
+
+    private:
+        std::unordered_map<GLenum, std::optional<bool>> m_capabilities;
+        std::optional<std::array<GLenum, 4>> m_blendFunc;
+        std::optional<GLenum> m_depthFunc;
+        std::optional<bool> m_depthMask;
+        std::optional<bool> m_colorMask;
+        std::optional<GLenum> m_cullFace;
+        std::optional<std::array<GLuint, 3>> m_stencilFunc;
+        std::optional<std::array<GLenum, 3>> m_frontStencilOp;
+        std::optional<std::array<GLenum, 3>> m_backStencilOp;
+        std::optional<GLuint> m_stencilMask;
+        std::optional<std::array<GLint, 4>> m_viewport;
+
+        std::optional<GLuint> m_program;
+        std::optional<GLuint> m_vertexArray;
+        std::optional<GLuint> m_readFramebuffer;
+        std::optional<GLuint> m_drawFramebuffer;
+        std::vector<std::optional<GLuint>> m_textureUnits;
+        std::unordered_map<GLenum, std::vector<std::optional<GLuint>>> m_bufferBases;
+
+        Stats m_stats{};
+        Stats m_lastFrameStats{};
+};
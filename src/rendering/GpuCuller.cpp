@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "GpuCuller.h"
+
+#include "core/FileSystem.h"
+#include "data/Texture.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/HiZPyramid.h"
+#include "rendering/InstanceBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Must match the define in instance_cull_compute.glsl
+constexpr auto cullWorkgroupSize = 64;
+
+GpuCuller::GpuCuller(bool cameraView)
+    : m_cameraView{cameraView}
+{
+    const auto shaderDir = GetShaderDir();
+    const auto csPath = shaderDir / "instance_cull_compute.glsl";
+
+    m_shader = std::make_unique<Shader>(csPath);
+    m_cullBlock = m_shader->registerUniformBuffer("CullBlock", sizeof(CullUbo), 8);
+    m_instanceSlot = m_shader->registerStorageBuffer("InstanceBuffer", 3);
+    m_viewMaskSlot = m_shader->registerStorageBuffer("ViewMaskBuffer", 4);
+    m_bucketSlot = m_shader->registerStorageBuffer("BucketBuffer", 5);
+    m_commandSlot = m_shader->registerStorageBuffer("CommandBuffer", 6);
+    m_counterSlot = m_shader->registerStorageBuffer("CounterBuffer", 7);
+    m_hiZTexture = m_shader->registerTextureSampler("hiZTexture", 0);
+}
+
+GpuCuller::~GpuCuller() = default;
+
+void GpuCuller::cull(const InstanceBuffer& instances, const std::vector<Frustum>& views)
+{
+    cull(instances, views, Occlusion{});
+}
+
+void GpuCuller::cull(const InstanceBuffer& instances, const std::vector<Frustum>& views, const Occlusion& occlusion)
+{
+    if (views.size() > maxViews)
+    {
+        throw std::runtime_error("GpuCuller supports at most " + std::to_string(maxViews) + " views");
+    }
+
+    const auto testOcclusion = occlusion.test != OcclusionTest::None;
+    if (testOcclusion && (views.size() != 1 || !occlusion.pyramid || !occlusion.pyramid->valid()))
+    {
+        throw std::runtime_error("GpuCuller occlusion needs a single view and a built pyramid");
+    }
+
+    reserve(instances.capacity());
+
+    // Unused command slots stay zeroed, so the multi-draws can cover whole buckets without a draw count
+    glClearNamedBufferData(m_commandBuffer->handle(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glClearNamedBufferData(m_counterBuffer->handle(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    if (instances.instanceCount() == 0)
+    {
+        return;
+    }
+
+    auto cullUbo = CullUbo{};
+    for (size_t view = 0; view < views.size(); ++view)
+    {
+        std::copy(views[view].begin(), views[view].end(), cullUbo.planes[view]);
+    }
+    cullUbo.viewCount = static_cast<GLuint>(views.size());
+    cullUbo.instanceCount = static_cast<GLuint>(instances.instanceCount());
+    cullUbo.occlusionTest = static_cast<GLuint>(occlusion.test);
+    cullUbo.skipHiddenFromCamera = m_cameraView ? 1 : 0;
+    cullUbo.viewerPosition = glm::vec4{m_viewerPosition, m_cameraView ? 1.0f : 0.0f};
+    if (testOcclusion)
+    {
+        const auto& pyramid = *occlusion.pyramid;
+        cullUbo.occlusionViewProjection = occlusion.viewProjection;
+        cullUbo.hiZSize = glm::vec4{pyramid.width(), pyramid.height(), pyramid.levelCount(), 0.0f};
+    }
+
+    m_shader->bind();
+    m_shader->writeUniformData(m_cullBlock, sizeof(CullUbo), &cullUbo);
+    m_shader->bindStorageBuffer(m_instanceSlot, instances.instanceBufferHandle());
+    m_shader->bindStorageBuffer(m_viewMaskSlot, m_viewMaskBuffer->handle());
+    m_shader->bindStorageBuffer(m_bucketSlot, instances.bucketBufferHandle());
+    m_shader->bindStorageBuffer(m_commandSlot, m_commandBuffer->handle());
+    m_shader->bindStorageBuffer(m_counterSlot, m_counterBuffer->handle());
+    if (testOcclusion)
+    {
+        m_shader->bindTexture(m_hiZTexture, occlusion.pyramid->texture());
+    }
+
+    const auto workgroupCount = (instances.instanceCount() + cullWorkgroupSize - 1) / cullWorkgroupSize;
+    glDispatchCompute(static_cast<GLuint>(workgroupCount), 1, 1);
+
+    // The commands are read by the draws and the view masks by the geometry shaders that follow
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCuller::drawBucket(const InstanceBuffer& instances, size_t bucketIndex) const
+{
+    const auto& bucket = instances.buckets()[bucketIndex];
+    if (bucket.commandCount == 0)
+    {
+        return;
+    }
+
+    glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                bucket.indexType,
+                                reinterpret_cast<const void*>(bucket.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                static_cast<GLsizei>(bucket.commandCount),
+                                0);
+}
+
+void GpuCuller::bindIndirectBuffer() const
+{
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer->handle());
+}
+
+void GpuCuller::setViewerPosition(const glm::vec3& position)
+{
+    m_viewerPosition = position;
+}
+
+void GpuCuller::reserve(size_t capacity)
+{
+    if (capacity <= m_capacity)
+    {
+        return;
+    }
+
+    m_commandBuffer = std::make_unique<Buffer<DrawElementsIndirectCommand>>(capacity);
+    // One counter per bucket, and there is never more than a bucket per instance
+    m_counterBuffer = std::make_unique<Buffer<GLuint>>(capacity);
+    m_viewMaskBuffer = std::make_unique<Buffer<GLuint>>(capacity);
+    m_capacity = capacity;
+}
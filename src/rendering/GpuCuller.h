@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+class HiZPyramid;
+class InstanceBuffer;
+
+// Layout read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count{0};
+    GLuint instanceCount{0};
+    GLuint firstIndex{0};
+    GLint baseVertex{0};
+    GLuint baseInstance{0};
+};
+
+// Frustum and optionally occlusion culls every instance in a compute shader and appends the survivors to an indirect command buffer,
+// so a pass draws any number of instances with one multi-draw per bucket. Each pass that culls against its
+// own view, such as a camera or a set of shadow cascades, owns a culler
+class GpuCuller
+{
+    public:
+        static constexpr auto maxViews = 4;
+
+        using Frustum = std::array<glm::vec4, 6>;
+
+        enum class OcclusionTest
+        {
+            None,
+            // Rejects instances hidden in the pyramid and remembers them for a retest
+            Test,
+            // Only considers the instances the last Test rejected, so the two draws never overlap
+            Retest
+        };
+
+        struct Occlusion
+        {
+            const HiZPyramid* pyramid{nullptr};
+            // Projects the bounds into the pyramid, which for a pyramid from an earlier frame reprojects them
+            glm::mat4 viewProjection{1.0f};
+            OcclusionTest test{OcclusionTest::None};
+        };
+
+        // Camera views also skip instances the CPU occlusion test hid from the camera,
+        // and meshlets facing away from the viewer position
+        explicit GpuCuller(bool cameraView = false);
+        ~GpuCuller();
+
+        GpuCuller(const GpuCuller& other) = delete;
+        GpuCuller(GpuCuller&& other) = delete;
+
+        GpuCuller& operator=(const GpuCuller& other) = delete;
+        GpuCuller& operator=(GpuCuller&& other) = delete;
+
+        // Tests each instance against up to maxViews frusta and keeps it if any of them contains it.
+        void cull(const InstanceBuffer& instances, const std::vector<Frustum>& views);
+        // Also tests against a Hi-Z pyramid, which is only supported with a single view
+        void cull(const InstanceBuffer& instances, const std::vector<Frustum>& views, const Occlusion& occlusion);
+
+        // Draws the surviving instances of one bucket. The vertex layout and indirect buffer must be bound
+        void drawBucket(const InstanceBuffer& instances, size_t bucketIndex) const;
+
+        void bindIndirectBuffer() const;
+
+        // Where camera views see the meshlets from, for the back-facing test of the next cull
+        void setViewerPosition(const glm::vec3& position);
+
+        // One bit per view for each instance, for shaders that route an instance to the views it is in
+        inline GLuint viewMaskBufferHandle() const
+        {
+            return m_viewMaskBuffer->handle();
+        }
+
+    private:
+        struct alignas(16) CullUbo
+        {
+                glm::vec4 planes[maxViews][6];
+                glm::mat4 occlusionViewProjection;
+                // Pyramid width, height and level count
+                glm::vec4 hiZSize;
+                // Viewer position, w is 1 when meshlet cones are tested
+                glm::vec4 viewerPosition;
+                GLuint viewCount;
+                GLuint instanceCount;
+                GLuint occlusionTest;
+                GLuint skipHiddenFromCamera;
+        };
+
+        void reserve(size_t capacity);
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_cullBlock{};
+        StorageBufferSlot m_instanceSlot{};
+        StorageBufferSlot m_bucketSlot{};
+        StorageBufferSlot m_commandSlot{};
+        StorageBufferSlot m_counterSlot{};
+        StorageBufferSlot m_viewMaskSlot{};
+        TextureSlot m_hiZTexture{};
+        bool m_cameraView{false};
+        glm::vec3 m_viewerPosition{0.0f};
+
+        std::unique_ptr<Buffer<DrawElementsIndirectCommand>> m_commandBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_counterBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_viewMaskBuffer{nullptr};
+        size_t m_capacity{0};
+};
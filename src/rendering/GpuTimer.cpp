@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer()
+{
+    glCreateQueries(GL_TIME_ELAPSED, queryCount, m_queries.data());
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries(queryCount, m_queries.data());
+}
+
+void GpuTimer::begin()
+{
+    collectResults();
+
+    // If this query is still in flight its result is dropped rather than stalling on it
+    m_pending[m_next] = false;
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+}
+
+void GpuTimer::end()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+
+    m_pending[m_next] = true;
+    m_next = (m_next + 1) % queryCount;
+}
+
+void GpuTimer::collectResults()
+{
+    // Oldest first, so the last result read is the most recent one available
+    for(size_t i = 0; i < queryCount; ++i)
+    {
+        const auto index = (m_next + i) % queryCount;
+        if(!m_pending[index])
+        {
+            continue;
+        }
+
+        auto available = GLint{0};
+        glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available)
+        {
+            // Queries complete in order, so none after this one are ready either
+            break;
+        }
+
+        auto elapsedNanoseconds = GLuint64{0};
+        glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &elapsedNanoseconds);
+        m_lastMilliseconds = static_cast<double>(elapsedNanoseconds) / 1.0e6;
+        m_pending[index] = false;
+    }
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstddef>
+
+// Measures the GPU time between begin and end with GL_TIME_ELAPSED queries.
+// Results arrive a few frames late, so queries are recycled from a ring and never waited on
+class GpuTimer
+{
+    public:
+        GpuTimer();
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer& other) = delete;
+        GpuTimer(GpuTimer&& other) = delete;
+
+        GpuTimer& operator=(const GpuTimer& other) = delete;
+        GpuTimer& operator=(GpuTimer&& other) = delete;
+
+        void begin();
+        void end();
+
+        // Time of the most recent measurement the GPU has finished
+        inline double lastMilliseconds() const
+        {
+            return m_lastMilliseconds;
+        }
+
+    private:
+        static constexpr auto queryCount = 4;
+
+        void collectResults();
+
+    private:
+        std::array<GLuint, queryCount> m_queries{};
+        std::array<bool, queryCount> m_pending{};
+        size_t m_next{0};
+        double m_lastMilliseconds{0.0};
+};
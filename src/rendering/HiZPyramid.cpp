@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "HiZPyramid.h"
+
+#include "core/FileSystem.h"
+#include "data/Texture.h"
+
+#include <algorithm>
+#include <bit>
+
+// Must match the define in hiz_build_compute.glsl
+constexpr auto hiZWorkgroupSize = 8;
+
+GLuint hiZWorkgroupCount(GLsizei size)
+{
+    return static_cast<GLuint>((size + hiZWorkgroupSize - 1) / hiZWorkgroupSize);
+}
+
+HiZPyramid::HiZPyramid()
+{
+    const auto shaderDir = GetShaderDir();
+    const auto csPath = shaderDir / "hiz_build_compute.glsl";
+
+    m_shader = std::make_unique<Shader>(csPath);
+    m_hiZBlock = m_shader->registerUniformBuffer("HiZBlock", sizeof(HiZUbo), 9);
+    m_sourceTexture = m_shader->registerTextureSampler("sourceTexture", 0);
+}
+
+HiZPyramid::~HiZPyramid() = default;
+
+void HiZPyramid::resize(GLsizei width, GLsizei height)
+{
+    m_width = width;
+    m_height = height;
+    m_levelCount = static_cast<GLsizei>(std::bit_width(static_cast<unsigned>(std::max(width, height))));
+    m_valid = false;
+
+    m_texture = std::make_unique<Texture2D>(GL_R32F, width, height, m_levelCount);
+    m_texture->setMinFilter(GL_NEAREST_MIPMAP_NEAREST);
+    m_texture->setMagFilter(GL_NEAREST);
+    m_texture->setWrapS(GL_CLAMP_TO_EDGE);
+    m_texture->setWrapT(GL_CLAMP_TO_EDGE);
+}
+
+void HiZPyramid::build(Texture2D& depthImage, const glm::mat4& viewProjection)
+{
+    m_shader->bind();
+
+    // Level 0 is a copy of the depth, each level after it reduces the one before
+    auto sourceSize = glm::ivec2{m_width, m_height};
+    for (auto level = 0; level < m_levelCount; ++level)
+    {
+        const auto destinationSize = glm::max(glm::ivec2{m_width >> level, m_height >> level}, glm::ivec2{1});
+
+        auto hiZUbo = HiZUbo{};
+        hiZUbo.sourceSize = sourceSize;
+        hiZUbo.destinationSize = destinationSize;
+        hiZUbo.sourceLevel = level == 0 ? -1 : level - 1;
+        m_shader->writeUniformData(m_hiZBlock, sizeof(HiZUbo), &hiZUbo);
+
+        m_shader->bindTexture(m_sourceTexture, level == 0 ? static_cast<Texture*>(&depthImage) : m_texture.get());
+        glBindImageTexture(0, m_texture->handle(), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glDispatchCompute(hiZWorkgroupCount(destinationSize.x), hiZWorkgroupCount(destinationSize.y), 1);
+
+        // The next level and the culling shaders fetch what this level stored
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        sourceSize = destinationSize;
+    }
+
+    m_viewProjection = viewProjection;
+    m_valid = true;
+}
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+class Texture2D;
+
+// Mip chain of the farthest depth under each texel, built from a depth image with a compute shader.
+// It outlives the frame that built it, so the next frame can test its bounds against it before drawing anything.
+// Odd sized levels fold their last row and column into the level below, so every texel covers its footprint
+class HiZPyramid
+{
+    public:
+        HiZPyramid();
+        ~HiZPyramid();
+
+        HiZPyramid(const HiZPyramid& other) = delete;
+        HiZPyramid(HiZPyramid&& other) = delete;
+
+        HiZPyramid& operator=(const HiZPyramid& other) = delete;
+        HiZPyramid& operator=(HiZPyramid&& other) = delete;
+
+        // Recreates the pyramid for a new depth image size. It holds nothing until the next build
+        void resize(GLsizei width, GLsizei height);
+
+        // Reduces a depth image the size of the pyramid, drawn with the given view projection
+        void build(Texture2D& depthImage, const glm::mat4& viewProjection);
+
+        inline Texture2D* texture() const
+        {
+            return m_texture.get();
+        }
+
+        // View projection of the depth the pyramid was last built from
+        inline const glm::mat4& viewProjection() const
+        {
+            return m_viewProjection;
+        }
+
+        inline bool valid() const
+        {
+            return m_valid;
+        }
+
+        inline GLsizei width() const
+        {
+            return m_width;
+        }
+
+        inline GLsizei height() const
+        {
+            return m_height;
+        }
+
+        inline GLsizei levelCount() const
+        {
+            return m_levelCount;
+        }
+
+    private:
+        struct alignas(16) HiZUbo
+        {
+                glm::ivec2 sourceSize;
+                glm::ivec2 destinationSize;
+                int sourceLevel;
+                int _padding[3];
+        };
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_hiZBlock{};
+        TextureSlot m_sourceTexture{};
+        std::unique_ptr<Texture2D> m_texture{nullptr};
+
+        glm::mat4 m_viewProjection{1.0f};
+        bool m_valid{false};
+
+        GLsizei m_width{0};
+        GLsizei m_height{0};
+        GLsizei m_levelCount{0};
+};
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "ImpostorBaker.h"
+
+#include "core/FileSystem.h"
+#include "data/Material.h"
+#include "data/Mesh.h"
+#include "data/Prefab.h"
+#include "data/Texture.h"
+#include "rendering/DrawCommand.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/InstanceBuffer.h"
+#include "rendering/MeshBuffer.h"
+#include "rendering/VertexLayout.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Matches the blocks of mesh_deferred_vertex.glsl and mesh_deferred_fragment.glsl
+struct alignas(16) ImpostorBakeTransformUbo
+{
+        glm::mat4 projection;
+        glm::mat4 view;
+        int octahedralNormals;
+};
+
+struct alignas(16) ImpostorBakeMaterialUbo
+{
+        int hasTexture{0};
+        int _padding[3];
+        glm::vec4 diffuseColor{0.0f, 0.0f, 0.0f, 1.0f};
+};
+
+// Direction towards the viewer of a frame, decoded from the centre of its cell on the hemi-octahedral grid.
+// Must match frameDirection in impostor_vertex.glsl
+glm::vec3 impostorFrameDirection(int x, int y)
+{
+    const auto cell = (glm::vec2{x, y} + 0.5f) / static_cast<float>(ImpostorBaker::frameCount) * 2.0f - 1.0f;
+    const auto dx = 0.5f * (cell.x + cell.y);
+    const auto dz = 0.5f * (cell.x - cell.y);
+    return glm::normalize(glm::vec3{dx, 1.0f - std::abs(dx) - std::abs(dz), dz});
+}
+
+ImpostorBaker::ImpostorBaker()
+{
+    const auto shaderDir = GetShaderDir();
+
+    m_shader = std::make_unique<Shader>(shaderDir / "mesh_deferred_vertex.glsl", shaderDir / "mesh_deferred_fragment.glsl");
+    m_slots.transformBlock = m_shader->registerUniformBuffer("TransformBlock", sizeof(ImpostorBakeTransformUbo), 0);
+    m_slots.diffuseTexture = m_shader->registerTextureSampler("diffuseTexture", 1);
+    m_slots.materialBlock = m_shader->registerUniformBuffer("MaterialBlock", sizeof(ImpostorBakeMaterialUbo), 2);
+    m_slots.instanceBuffer = m_shader->registerStorageBuffer("InstanceBuffer", 3);
+
+    m_framebuffer = std::make_unique<Framebuffer>();
+    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+
+    m_vertexLayout = std::make_unique<VertexLayout>();
+    m_instances = std::make_unique<InstanceBuffer>();
+}
+
+ImpostorBaker::~ImpostorBaker() = default;
+
+std::unique_ptr<ImpostorAtlas> ImpostorBaker::bake(const Prefab& prefab, const MeshBuffer& meshBuffer)
+{
+    const auto& box = prefab.boundingBox();
+    const auto center = box.center();
+    const auto radius = 0.5f * glm::length(box.max() - box.min());
+    if (radius <= 0.0f)
+    {
+        return nullptr;
+    }
+
+    // A mesh left out of a full mesh buffer would be missing from every frame
+    for (const auto& mesh : prefab.meshes())
+    {
+        if (!meshBuffer.handleOfMesh(mesh.get()))
+        {
+            return nullptr;
+        }
+    }
+
+    constexpr auto atlasSize = frameCount * frameSize;
+
+    auto atlas = std::make_unique<ImpostorAtlas>();
+    atlas->boundingSphere = glm::vec4{center, radius};
+    atlas->colorImage = std::make_unique<Texture2D>(GL_RGBA8, atlasSize, atlasSize);
+    atlas->normalImage = std::make_unique<Texture2D>(GL_RG16, atlasSize, atlasSize);
+    atlas->depthImage = std::make_unique<Texture2D>(GL_DEPTH24_STENCIL8, atlasSize, atlasSize);
+
+    // Filtering would blend neighbouring frames at their edges, and depths and encoded normals never blend well
+    for (auto* image : {atlas->colorImage.get(), atlas->normalImage.get(), atlas->depthImage.get()})
+    {
+        image->setMinFilter(GL_NEAREST);
+        image->setMagFilter(GL_NEAREST);
+        image->setWrapS(GL_CLAMP_TO_EDGE);
+        image->setWrapT(GL_CLAMP_TO_EDGE);
+    }
+
+    // Baked in model space, so the normals come out in model space too and turn with each instance
+    auto drawQueue = std::vector<DrawCommand>{};
+    for (const auto& mesh : prefab.meshes())
+    {
+        auto& command = drawQueue.emplace_back();
+        command.mesh = mesh.get();
+        command.transform = glm::mat4{1.0f};
+        command.gpuMesh = meshBuffer.gpuMesh(*meshBuffer.handleOfMesh(mesh.get()));
+    }
+    m_instances->upload(drawQueue);
+
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *atlas->colorImage, 0);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT1, *atlas->normalImage, 0);
+    m_framebuffer->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, *atlas->depthImage, 0);
+
+    m_shader->bind();
+    m_framebuffer->bind();
+
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
+
+    glState.setViewport(0, 0, atlasSize, atlasSize);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    m_vertexLayout->bind();
+    meshBuffer.bindToVertexLayout(*m_vertexLayout);
+    m_instances->bindToVertexLayout(*m_vertexLayout);
+    m_shader->bindStorageBuffer(m_slots.instanceBuffer, m_instances->instanceBufferHandle());
+
+    auto transformUbo = ImpostorBakeTransformUbo{};
+    transformUbo.projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+    transformUbo.octahedralNormals = meshBuffer.octahedralNormals() ? 1 : 0;
+
+    for (auto y = 0; y < frameCount; ++y)
+    {
+        for (auto x = 0; x < frameCount; ++x)
+        {
+            // The projection only covers the sphere, so each frame's viewport clips it to its own cell
+            const auto direction = impostorFrameDirection(x, y);
+            transformUbo.view = glm::lookAt(center + direction * radius, center, glm::vec3{0.0f, 1.0f, 0.0f});
+            m_shader->writeUniformData(m_slots.transformBlock, sizeof(ImpostorBakeTransformUbo), &transformUbo);
+            glState.setViewport(x * frameSize, y * frameSize, frameSize, frameSize);
+
+            for (size_t i = 0; i < drawQueue.size(); ++i)
+            {
+                const auto* material = drawQueue[i].mesh->material;
+                if (!material)
+                {
+                    continue;
+                }
+
+                auto materialUbo = ImpostorBakeMaterialUbo{};
+                materialUbo.diffuseColor = glm::vec4{material->diffuse, 1.0f};
+                if (material->diffuseTexture)
+                {
+                    materialUbo.hasTexture = 1;
+                    m_shader->bindTexture(m_slots.diffuseTexture, material->diffuseTexture.value());
+                }
+                m_shader->writeUniformData(m_slots.materialBlock, sizeof(ImpostorBakeMaterialUbo), &materialUbo);
+
+                const auto& gpuMesh = drawQueue[i].gpuMesh;
+                glDrawElementsInstancedBaseVertexBaseInstance(
+                    GL_TRIANGLES,
+                    gpuMesh.indexCount,
+                    gpuMesh.indexType,
+                    gpuMesh.indexPointer(),
+                    1,
+                    gpuMesh.baseVertex,
+                    static_cast<GLuint>(i));
+            }
+        }
+    }
+
+    m_framebuffer->unbind();
+
+    return atlas;
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+class Framebuffer;
+class InstanceBuffer;
+class MeshBuffer;
+class Prefab;
+class Texture2D;
+class VertexLayout;
+
+// A prefab seen from a hemisphere of directions, one frame per direction, in the G-buffer formats so a quad
+// drawn from it lights like the meshes it stands in for. Frames are laid out on a hemi-octahedral grid,
+// and each is an orthographic view of the prefab's bounding sphere from outside it
+struct ImpostorAtlas
+{
+    std::unique_ptr<Texture2D> colorImage{nullptr};
+    std::unique_ptr<Texture2D> normalImage{nullptr};
+    // Depth from the near side of the sphere to the far side, 1 where the frame is empty
+    std::unique_ptr<Texture2D> depthImage{nullptr};
+    // Model space centre and radius
+    glm::vec4 boundingSphere{0.0f};
+};
+
+// Renders the full detail meshes of a prefab into an impostor atlas, with the G-buffer shaders
+class ImpostorBaker
+{
+    public:
+        // Frames along each side of the atlas. Even, so no frame looks straight down and the up vector holds
+        static constexpr int frameCount = 8;
+        static constexpr int frameSize = 128;
+
+        ImpostorBaker();
+        ~ImpostorBaker();
+
+        ImpostorBaker(const ImpostorBaker& other) = delete;
+        ImpostorBaker(ImpostorBaker&& other) = delete;
+
+        ImpostorBaker& operator=(const ImpostorBaker& other) = delete;
+        ImpostorBaker& operator=(ImpostorBaker&& other) = delete;
+
+        // The prefab's meshes must already be in the mesh buffer. Null for prefabs with nothing to see
+        std::unique_ptr<ImpostorAtlas> bake(const Prefab& prefab, const MeshBuffer& meshBuffer);
+
+    private:
+        struct ShaderSlots
+        {
+            UniformBufferSlot transformBlock{};
+            TextureSlot diffuseTexture{};
+            UniformBufferSlot materialBlock{};
+            StorageBufferSlot instanceBuffer{};
+        };
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        ShaderSlots m_slots{};
+        std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
+        std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
+        std::unique_ptr<InstanceBuffer> m_instances{nullptr};
+};
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "InstanceBuffer.h"
+
+#include "data/Mesh.h"
+#include "data/Meshlet.h"
+#include "rendering/VertexLayout.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <utility>
+
+constexpr auto initialInstanceCapacity = size_t{1024};
+
+InstanceBuffer::InstanceBuffer()
+{
+    reserve(initialInstanceCapacity);
+}
+
+InstanceBuffer::~InstanceBuffer() = default;
+
+bool isSameGpuMesh(const GpuMesh& a, const GpuMesh& b)
+{
+    return a.indexCount == b.indexCount && a.indexType == b.indexType && a.firstIndex == b.firstIndex
+        && a.baseVertex == b.baseVertex && a.positionDequantisation == b.positionDequantisation;
+}
+
+void InstanceBuffer::upload(const std::vector<DrawCommand>& drawQueue, bool splitMeshlets)
+{
+    // Meshlet instances follow the draw commands' instances
+    auto instanceCount = drawQueue.size();
+    for (const auto& drawCommand : drawQueue)
+    {
+        instanceCount += splitMeshlets ? drawCommand.mesh->meshlets.size() : 0;
+    }
+
+    const auto previousCapacity = m_capacity;
+    reserve(instanceCount);
+    if (m_capacity != previousCapacity)
+    {
+        markDirty(0, instanceCount);
+    }
+
+    m_instances.resize(instanceCount);
+    m_slots.resize(drawQueue.size());
+
+    for (auto& bucket : m_buckets)
+    {
+        bucket.commandCount = 0;
+    }
+
+    // A prefab's meshes are queued one after another with the same transform, so they share a normal matrix
+    auto normalTransform = glm::mat4{0.0f};
+    auto normalMatrix = glm::mat4{1.0f};
+
+    auto nextMeshletInstance = drawQueue.size();
+    for (size_t i = 0; i < drawQueue.size(); ++i)
+    {
+        const auto& drawCommand = drawQueue[i];
+        const auto& gpuMesh = drawCommand.gpuMesh;
+        const auto& meshlets = drawCommand.mesh->meshlets;
+        const auto split = splitMeshlets && !meshlets.empty();
+        const auto firstMeshletInstance = nextMeshletInstance;
+        const auto meshletCount = split ? meshlets.size() : 0;
+        nextMeshletInstance += meshletCount;
+
+        auto& slot = m_slots[i];
+        auto& instance = m_instances[i];
+
+        const auto flags = (drawCommand.hiddenFromCamera ? instanceHiddenFromCamera : 0)
+                         | (split ? instanceSplitIntoMeshlets : 0);
+
+        const auto unchanged = slot.mesh == drawCommand.mesh && slot.material == drawCommand.mesh->material
+                            && slot.split == split && (!split || slot.firstMeshletInstance == firstMeshletInstance)
+                            && slot.transform == drawCommand.transform && isSameGpuMesh(slot.gpuMesh, gpuMesh);
+        if (unchanged)
+        {
+            m_buckets[instance.bucket].commandCount += split ? static_cast<GLuint>(meshletCount) : 1;
+
+            // Occlusion results change from frame to frame even when nothing moves
+            if (instance.flags != flags)
+            {
+                instance.flags = flags;
+                markDirty(i, 1);
+                for (auto meshlet = firstMeshletInstance; meshlet < firstMeshletInstance + meshletCount; ++meshlet)
+                {
+                    m_instances[meshlet].flags = flags & ~instanceSplitIntoMeshlets;
+                }
+                markDirty(firstMeshletInstance, meshletCount);
+            }
+            continue;
+        }
+
+        slot = {drawCommand.mesh, drawCommand.mesh->material, drawCommand.transform, gpuMesh, firstMeshletInstance, split};
+
+        // The sphere around the transformed box, scaled by the largest axis so it stays conservative
+        const auto& box = drawCommand.mesh->boundingBox;
+        const auto& transform = drawCommand.transform;
+        const auto axisScales = glm::vec3{glm::length(glm::vec3(transform[0])),
+                                          glm::length(glm::vec3(transform[1])),
+                                          glm::length(glm::vec3(transform[2]))};
+        const auto scale = std::max({axisScales.x, axisScales.y, axisScales.z});
+        const auto center = glm::vec3(transform * glm::vec4(box.center(), 1.0f));
+        const auto radius = 0.5f * glm::length(box.max() - box.min()) * scale;
+
+        // Normals are stored in model space, so they skip the dequantisation
+        if (transform != normalTransform)
+        {
+            normalTransform = transform;
+            normalMatrix = glm::mat4{glm::transpose(glm::inverse(glm::mat3{transform}))};
+        }
+
+        instance = GpuInstance{};
+        instance.model = transform * gpuMesh.positionDequantisation;
+        instance.normalMatrix = normalMatrix;
+        instance.boundingSphere = glm::vec4{center, radius};
+        instance.indexCount = static_cast<GLuint>(gpuMesh.indexCount);
+        instance.firstIndex = gpuMesh.firstIndex;
+        instance.baseVertex = gpuMesh.baseVertex;
+        instance.bucket = findBucket(drawCommand.mesh->material, gpuMesh.indexType);
+        instance.flags = flags;
+        markDirty(i, 1);
+
+        if (!split)
+        {
+            m_buckets[instance.bucket].commandCount++;
+            continue;
+        }
+
+        // Culled one draw at a time, large meshes are all or nothing. The cullers test each meshlet instead
+        m_buckets[instance.bucket].commandCount += static_cast<GLuint>(meshletCount);
+
+        // Non-uniform scale bends the normals, which the cone does not account for
+        const auto uniformScale = scale - std::min({axisScales.x, axisScales.y, axisScales.z}) <= 0.01f * scale;
+        for (size_t m = 0; m < meshletCount; ++m)
+        {
+            const auto& meshlet = meshlets[m];
+
+            auto& meshletInstance = m_instances[firstMeshletInstance + m];
+            meshletInstance = instance;
+            meshletInstance.flags = flags & ~instanceSplitIntoMeshlets;
+            meshletInstance.indexCount = meshlet.indexCount;
+            meshletInstance.firstIndex = gpuMesh.firstIndex + meshlet.firstIndex;
+
+            const auto meshletCenter = glm::vec3(transform * glm::vec4(glm::vec3(meshlet.boundingSphere), 1.0f));
+            meshletInstance.boundingSphere = glm::vec4{meshletCenter, meshlet.boundingSphere.w * scale};
+
+            if (uniformScale && meshlet.coneCutoff <= 1.0f)
+            {
+                const auto axis = glm::normalize(glm::mat3{transform} * meshlet.coneAxis);
+                meshletInstance.coneApex = glm::vec4{glm::vec3(transform * glm::vec4(meshlet.coneApex, 1.0f)), 1.0f};
+                meshletInstance.coneAxisCutoff = glm::vec4{axis, meshlet.coneCutoff};
+            }
+        }
+        markDirty(firstMeshletInstance, meshletCount);
+    }
+
+    removeEmptyBuckets();
+
+    auto firstCommands = std::vector<GLuint>{};
+    auto nextCommand = GLuint{0};
+    for (auto& bucket : m_buckets)
+    {
+        bucket.firstCommand = nextCommand;
+        firstCommands.push_back(nextCommand);
+        nextCommand += bucket.commandCount;
+    }
+
+    if (!firstCommands.empty())
+    {
+        m_bucketBuffer->write(firstCommands);
+    }
+
+    // Instances past the end were dropped, nothing reads them
+    m_dirtyEnd = std::min(m_dirtyEnd, m_instances.size());
+    if (m_dirtyFirst < m_dirtyEnd)
+    {
+        m_instanceBuffer->write(m_instances.data() + m_dirtyFirst, m_dirtyEnd - m_dirtyFirst, m_dirtyFirst);
+    }
+    m_dirtyFirst = 0;
+    m_dirtyEnd = 0;
+}
+
+void InstanceBuffer::bindToVertexLayout(const VertexLayout& vertexLayout, GLuint divisor) const
+{
+    vertexLayout.registerAttribute(instanceAttribute, 1, GL_UNSIGNED_INT, 0, instanceStream, AttributeFormat::Integer);
+    vertexLayout.bindVertexBuffer(instanceStream, m_identityBuffer->handle(), 0, sizeof(GLuint));
+    vertexLayout.setBindingDivisor(instanceStream, divisor);
+}
+
+GLuint InstanceBuffer::findBucket(const Material* material, GLenum indexType)
+{
+    const auto key = std::make_pair(material, indexType);
+    auto bucket = m_bucketIndices.find(key);
+    if (bucket == m_bucketIndices.end())
+    {
+        bucket = m_bucketIndices.emplace(key, static_cast<GLuint>(m_buckets.size())).first;
+        m_buckets.push_back({material, indexType});
+    }
+    return bucket->second;
+}
+
+void InstanceBuffer::removeEmptyBuckets()
+{
+    if (std::none_of(m_buckets.begin(), m_buckets.end(), [](const Bucket& bucket) { return bucket.commandCount == 0; }))
+    {
+        return;
+    }
+
+    // A material nothing draws may be gone already, so its bucket must not reach the passes.
+    // Rare enough to renumber every instance when it happens
+    auto remap = std::vector<GLuint>(m_buckets.size());
+    auto kept = std::vector<Bucket>{};
+    m_bucketIndices.clear();
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        if (m_buckets[i].commandCount != 0)
+        {
+            remap[i] = static_cast<GLuint>(kept.size());
+            m_bucketIndices.emplace(std::make_pair(m_buckets[i].material, m_buckets[i].indexType), remap[i]);
+            kept.push_back(m_buckets[i]);
+        }
+    }
+    m_buckets = std::move(kept);
+
+    for (auto& instance : m_instances)
+    {
+        instance.bucket = remap[instance.bucket];
+    }
+    markDirty(0, m_instances.size());
+}
+
+void InstanceBuffer::markDirty(size_t first, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (m_dirtyFirst == m_dirtyEnd)
+    {
+        m_dirtyFirst = first;
+        m_dirtyEnd = first + count;
+        return;
+    }
+
+    m_dirtyFirst = std::min(m_dirtyFirst, first);
+    m_dirtyEnd = std::max(m_dirtyEnd, first + count);
+}
+
+void InstanceBuffer::reserve(size_t instanceCount)
+{
+    if (instanceCount <= m_capacity)
+    {
+        return;
+    }
+
+    auto capacity = std::max(m_capacity, initialInstanceCapacity);
+    while (capacity < instanceCount)
+    {
+        capacity *= 2;
+    }
+
+    auto identity = std::vector<GLuint>(capacity);
+    std::iota(identity.begin(), identity.end(), 0u);
+
+    m_instanceBuffer = std::make_unique<Buffer<GpuInstance>>(capacity);
+    m_identityBuffer = std::make_unique<Buffer<GLuint>>(identity);
+    // A bucket per draw at most
+    m_bucketBuffer = std::make_unique<Buffer<GLuint>>(capacity);
+    m_capacity = capacity;
+}
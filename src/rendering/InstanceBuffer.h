@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/DrawCommand.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct Material;
+class VertexLayout;
+
+// Bits of GpuInstance::flags, must match the defines in instance_cull_compute.glsl
+constexpr GLuint instanceHiddenFromCamera = 1;
+// A whole mesh whose meshlets follow as instances of their own. Cullers skip it and cull the meshlets instead
+constexpr GLuint instanceSplitIntoMeshlets = 2;
+
+// Matches the Instance struct in the mesh and culling shaders
+struct alignas(16) GpuInstance
+{
+        glm::mat4 model{1.0f};
+        glm::mat4 normalMatrix{1.0f};
+        // World space bounding sphere, centre and radius
+        glm::vec4 boundingSphere{0.0f};
+        // World space normal cone of a meshlet, apex and then axis and cutoff. See Meshlet
+        glm::vec4 coneApex{0.0f};
+        glm::vec4 coneAxisCutoff{0.0f, 0.0f, 1.0f, 2.0f};
+        GLuint indexCount{0};
+        GLuint firstIndex{0};
+        GLint baseVertex{0};
+        GLuint bucket{0};
+        GLuint flags{0};
+};
+
+// Holds every draw of the frame on the GPU, uploaded once and shared by all the mesh passes.
+// Instance i is draw command i, and shaders find it through an instanced vertex attribute fed from
+// an identity buffer, since GL 4.5 has no gl_BaseInstance. Draws pass their instance as the base instance.
+// Meshlets of split meshes come after the draw commands, so only the cullers ever see them.
+// Slots live on between frames, and only those whose command changed are rebuilt and uploaded again
+class InstanceBuffer
+{
+    public:
+        static constexpr GLuint instanceStream = 2;
+        static constexpr GLuint instanceAttribute = 3;
+
+        // Draws sharing a material and index type, which can go out in one multi-draw
+        struct Bucket
+        {
+            const Material* material{nullptr};
+            GLenum indexType{GL_UNSIGNED_INT};
+            // Range reserved for the bucket in a culler's indirect command buffer, one command for each
+            // instance the culler can emit
+            GLuint firstCommand{0};
+            GLuint commandCount{0};
+        };
+
+        InstanceBuffer();
+        ~InstanceBuffer();
+
+        InstanceBuffer(const InstanceBuffer& other) = delete;
+        InstanceBuffer(InstanceBuffer&& other) = delete;
+
+        InstanceBuffer& operator=(const InstanceBuffer& other) = delete;
+        InstanceBuffer& operator=(InstanceBuffer&& other) = delete;
+
+        // With splitMeshlets, meshes that have meshlets are culled and drawn one meshlet at a time by the
+        // cullers. Passes drawing the queue on the CPU still draw each command's whole mesh
+        void upload(const std::vector<DrawCommand>& drawQueue, bool splitMeshlets = false);
+
+        // Feeds the instance attribute. Passes drawing each instance several times, once per light say,
+        // set a divisor above their instance count so every copy reads the base instance
+        void bindToVertexLayout(const VertexLayout& vertexLayout, GLuint divisor = 1) const;
+
+        inline GLuint instanceBufferHandle() const
+        {
+            return m_instanceBuffer->handle();
+        }
+
+        inline GLuint bucketBufferHandle() const
+        {
+            return m_bucketBuffer->handle();
+        }
+
+        inline size_t instanceCount() const
+        {
+            return m_instances.size();
+        }
+
+        // Grows in steps, so cullers only reallocate their buffers when it changes
+        inline size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        inline const std::vector<Bucket>& buckets() const
+        {
+            return m_buckets;
+        }
+
+    private:
+        // What a draw command's instances were built from, to tell whether they need building again
+        struct Slot
+        {
+            const Mesh* mesh{nullptr};
+            const Material* material{nullptr};
+            glm::mat4 transform{1.0f};
+            GpuMesh gpuMesh{};
+            // Where the instances of its meshlets start, if the mesh was split
+            size_t firstMeshletInstance{0};
+            bool split{false};
+        };
+
+        GLuint findBucket(const Material* material, GLenum indexType);
+        void removeEmptyBuckets();
+        void markDirty(size_t first, size_t count);
+        void reserve(size_t instanceCount);
+
+    private:
+        std::unique_ptr<Buffer<GpuInstance>> m_instanceBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_identityBuffer{nullptr};
+        // First command of each bucket, indexed by GpuInstance::bucket
+        std::unique_ptr<Buffer<GLuint>> m_bucketBuffer{nullptr};
+
+        std::vector<GpuInstance> m_instances;
+        std::vector<Slot> m_slots;
+        // Buckets outlive the draws in them, so a slot keeps its bucket while its mesh stays the same
+        std::vector<Bucket> m_buckets;
+        std::map<std::pair<const Material*, GLenum>, GLuint> m_bucketIndices;
+        // Instances changed since the last upload
+        size_t m_dirtyFirst{0};
+        size_t m_dirtyEnd{0};
+        size_t m_capacity{0};
+};
@@ -8,17 +8,81 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 
-glm::mat4 getLightSpaceMatrix(const glm::vec3& lightDirection)
+#include <cmath>
+
+glm::mat4 getDirectionalLightView(const glm::vec3& lightDirection)
 {
-    // Directional lights have no position, so make a pretend one along its direction vector
+    // Directional lights have no position, so look along the direction from the origin.
+    // Only the orientation matters, the cascades position their ortho boxes within this space
     const auto normalisedDirection = glm::normalize(lightDirection);
-    const auto lightPos = -normalisedDirection * 50.0f;
+    const auto up = std::abs(normalisedDirection.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+
+    return glm::lookAt(glm::vec3(0.0f), normalisedDirection, up);
+}
+
+std::vector<float> getCascadeSplitDepths(float nearPlane, float farPlane, int cascadeCount, float lambda)
+{
+    auto splits = std::vector<float>{};
+
+    for (auto i = 1; i <= cascadeCount; ++i)
+    {
+        const auto fraction = static_cast<float>(i) / static_cast<float>(cascadeCount);
+        const auto logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        const auto uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+
+        splits.push_back(lambda * logSplit + (1.0f - lambda) * uniformSplit);
+    }
+
+    return splits;
+}
+
+std::array<glm::vec3, 8> getFrustumCorners(const glm::mat4& viewProjection)
+{
+    const auto inverse = glm::inverse(viewProjection);
 
-    // Create a projection and view from the pretend light point of view
-    const auto lightProjection = glm::ortho(-50.0f, 50.0f, -50.0f, 50.0f, 1.0f, 200.0f);
-    const auto lightView = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0, 1, 0));
+    auto corners = std::array<glm::vec3, 8>{};
+    auto i = 0;
 
-    return lightProjection * lightView;
+    for (auto x = 0; x < 2; ++x)
+    {
+        for (auto y = 0; y < 2; ++y)
+        {
+            for (auto z = 0; z < 2; ++z)
+            {
+                const auto corner = inverse * glm::vec4(2.0f * x - 1.0f, 2.0f * y - 1.0f, 2.0f * z - 1.0f, 1.0f);
+                corners[i++] = glm::vec3(corner) / corner.w;
+            }
+        }
+    }
+
+    return corners;
+}
+
+std::array<glm::vec4, 6> getFrustumPlanes(const glm::mat4& viewProjection)
+{
+    // Gribb and Hartmann, each plane is the fourth row plus or minus one of the others
+    const auto m = glm::transpose(viewProjection);
+
+    auto planes = std::array<glm::vec4, 6>{
+        m[3] + m[0],
+        m[3] - m[0],
+        m[3] + m[1],
+        m[3] - m[1],
+        m[3] + m[2],
+        m[3] - m[2]};
+
+    for (auto& plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return planes;
+}
+
+float getPointLightRange(float radius)
+{
+    // The lighting shader windows the attenuation to reach zero here, it has already fallen to around 6% by then
+    return radius * 4.0f;
 }
 
 std::array<glm::mat4, 6> getPointLightShadowTransforms(const glm::vec3& position, float farPlane)
@@ -6,7 +6,22 @@
 #include <glm/glm.hpp>
 
 #include <array>
+#include <vector>
 
-glm::mat4 getLightSpaceMatrix(const glm::vec3& lightDirection);
+// View matrix looking along a directional light, centred on the world origin
+glm::mat4 getDirectionalLightView(const glm::vec3& lightDirection);
+
+// Far distance of each cascade, blending logarithmic and uniform splits (the practical split scheme)
+std::vector<float> getCascadeSplitDepths(float nearPlane, float farPlane, int cascadeCount, float lambda);
+
+// World space corners of the frustum described by a view projection matrix
+std::array<glm::vec3, 8> getFrustumCorners(const glm::mat4& viewProjection);
+
+// World space planes of the frustum described by a view projection matrix, as (normal, distance) with
+// normals facing inwards, ordered left, right, bottom, top, near, far
+std::array<glm::vec4, 6> getFrustumPlanes(const glm::mat4& viewProjection);
+
+// Distance at which a point light's contribution has faded to zero, which is also how far it casts shadows
+float getPointLightRange(float radius);
 
 std::array<glm::mat4, 6> getPointLightShadowTransforms(const glm::vec3& position, float farPlane);
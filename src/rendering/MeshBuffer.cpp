@@ -7,39 +7,359 @@
 #include "data/Prefab.h"
 #include "rendering/VertexLayout.h"
 
-MeshBuffer::MeshBuffer(const std::vector<Mesh*>& meshes)
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Meshes with no more vertices than this can address them with 16-bit indices, relative to their base vertex
+constexpr auto maxShortIndexedVertices = size_t{65536};
+
+uint16_t quantiseUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+int16_t quantiseSnorm16(float value)
+{
+    return static_cast<int16_t>(std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Folds the unit sphere onto a square, matching decodeNormal in mesh_deferred_vertex.glsl
+glm::vec2 encodeOctahedral(const glm::vec3& normal)
+{
+    const auto n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    if (n.z >= 0.0f)
+    {
+        return glm::vec2{n.x, n.y};
+    }
+
+    const auto signs = glm::vec2{n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f};
+    return (1.0f - glm::abs(glm::vec2{n.y, n.x})) * signs;
+}
+
+MeshBuffer::MeshBuffer(VertexFormat format, size_t vertexCapacity, size_t indexCapacity)
+    : m_format{format}
+    , m_vertexCapacity{vertexCapacity}
+    , m_indexCapacity{indexCapacity}
+{
+    createBuffers();
+
+    m_vertexAllocator = std::make_unique<FreeListAllocator>(m_vertexCapacity);
+    m_indexAllocator = std::make_unique<FreeListAllocator>(m_indexCapacity);
+}
+
+MeshBuffer::~MeshBuffer()
+{
+}
+
+std::optional<MeshHandle> MeshBuffer::addMesh(Mesh* mesh)
+{
+    if (m_handles.contains(mesh))
+    {
+        return m_handles.at(mesh);
+    }
+
+    auto allocation = MeshAllocation{};
+    allocation.mesh = mesh;
+    allocation.vertexCount = static_cast<GLuint>(mesh->vertices.size());
+    allocation.indexType = mesh->vertices.size() <= maxShortIndexedVertices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    allocation.indexByteSize = mesh->indices.size() * (allocation.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+
+    if (!allocate(allocation))
+    {
+        // There may be room once the holes are merged
+        m_fragmented = true;
+        return std::nullopt;
+    }
+
+    if (m_format == VertexFormat::Quantised)
+    {
+        uploadQuantised(allocation);
+    }
+    else
+    {
+        uploadFloat(allocation);
+    }
+    uploadIndices(allocation);
+
+    auto handle = static_cast<MeshHandle>(m_allocations.size());
+    if (!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_allocations[handle] = allocation;
+    }
+    else
+    {
+        m_allocations.push_back(allocation);
+    }
+
+    m_handles[mesh] = handle;
+    return handle;
+}
+
+void MeshBuffer::removeMesh(MeshHandle handle)
 {
-    auto vertexBufferOffset = GLuint{0};
-    auto indexBufferOffset = GLuint{0};
+    auto& allocation = m_allocations.at(handle);
+    if (!allocation.mesh)
+    {
+        return;
+    }
 
-    auto vertices = std::vector<Vertex>{};
-    auto indices = std::vector<GLuint>{};
+    m_vertexAllocator->free(allocation.vertexOffset, allocation.vertexCount);
+    m_indexAllocator->free(allocation.indexByteOffset, allocation.indexByteSize);
+
+    m_handles.erase(allocation.mesh);
+    allocation = MeshAllocation{};
+    m_freeHandles.push_back(handle);
+    m_fragmented = true;
+}
 
-    for (const auto& mesh : meshes)
+void MeshBuffer::compact(size_t byteBudget)
+{
+    if (!m_fragmented)
+    {
+        return;
+    }
+
+    // Lowest first, so each move fills the earliest hole and the free space gathers at the end
+    auto order = std::vector<MeshHandle>{};
+    for (MeshHandle handle = 0; handle < m_allocations.size(); ++handle)
     {
-        const auto vertexCount = static_cast<GLuint>(mesh->vertices.size());
-        const auto indexCount = static_cast<GLuint>(mesh->indices.size());
+        if (m_allocations[handle].mesh)
+        {
+            order.push_back(handle);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](MeshHandle a, MeshHandle b) {
+        return m_allocations[a].vertexOffset < m_allocations[b].vertexOffset;
+    });
+
+    auto copiedBytes = size_t{0};
+    for (const auto handle : order)
+    {
+        auto& allocation = m_allocations[handle];
+        const auto bytes = allocationBytes(allocation);
+        if (copiedBytes + bytes > byteBudget)
+        {
+            // Picked up again next frame
+            return;
+        }
+
+        // The old ranges are still held, so the new ones never overlap them and the copies stay within one buffer
+        auto moved = allocation;
+        if (!allocate(moved))
+        {
+            continue;
+        }
 
-        m_vertexOffsets[mesh] = vertexBufferOffset;
-        m_indexOffsets[mesh] = indexBufferOffset;
+        if (moved.vertexOffset > allocation.vertexOffset || moved.indexByteOffset > allocation.indexByteOffset
+            || (moved.vertexOffset == allocation.vertexOffset && moved.indexByteOffset == allocation.indexByteOffset))
+        {
+            m_vertexAllocator->free(moved.vertexOffset, moved.vertexCount);
+            m_indexAllocator->free(moved.indexByteOffset, moved.indexByteSize);
+            continue;
+        }
 
-        vertices.insert(vertices.end(),mesh->vertices.begin(), mesh->vertices.end());
-        indices.insert(indices.end(), mesh->indices.begin(), mesh->indices.end());
+        if (m_format == VertexFormat::Quantised)
+        {
+            m_quantisedPositionBuffer->copy(*m_quantisedPositionBuffer, allocation.vertexOffset, moved.vertexOffset, allocation.vertexCount);
+            m_quantisedAttributeBuffer->copy(*m_quantisedAttributeBuffer, allocation.vertexOffset, moved.vertexOffset, allocation.vertexCount);
+        }
+        else
+        {
+            m_positionBuffer->copy(*m_positionBuffer, allocation.vertexOffset, moved.vertexOffset, allocation.vertexCount);
+            m_attributeBuffer->copy(*m_attributeBuffer, allocation.vertexOffset, moved.vertexOffset, allocation.vertexCount);
+        }
+        m_indexBuffer->copy(*m_indexBuffer, allocation.indexByteOffset, moved.indexByteOffset, allocation.indexByteSize);
 
-        vertexBufferOffset += vertexCount;
-        indexBufferOffset += indexCount;
+        m_vertexAllocator->free(allocation.vertexOffset, allocation.vertexCount);
+        m_indexAllocator->free(allocation.indexByteOffset, allocation.indexByteSize);
+        allocation = moved;
+        copiedBytes += bytes;
     }
 
-    m_vertexBuffer = std::make_unique<Buffer<Vertex>>(vertices);
-    m_indexBuffer = std::make_unique<Buffer<GLuint>>(indices);
+    // A whole pass within the budget, so nothing is left that can move down
+    m_fragmented = false;
 }
 
-MeshBuffer::~MeshBuffer()
+GpuMesh MeshBuffer::gpuMesh(MeshHandle handle) const
 {
+    const auto& allocation = m_allocations.at(handle);
+    const auto indexSize = allocation.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+    auto mesh = GpuMesh{};
+    mesh.indexCount = static_cast<GLsizei>(allocation.indexByteSize / indexSize);
+    mesh.indexType = allocation.indexType;
+    mesh.firstIndex = static_cast<GLuint>(allocation.indexByteOffset / indexSize);
+    mesh.baseVertex = static_cast<GLint>(allocation.vertexOffset);
+    mesh.positionDequantisation = allocation.positionDequantisation;
+    return mesh;
+}
+
+bool MeshBuffer::allocate(MeshAllocation& allocation)
+{
+    const auto vertexOffset = m_vertexAllocator->allocate(allocation.vertexCount);
+    if (!vertexOffset)
+    {
+        return false;
+    }
+
+    // Aligned to the index size, so the offset can be counted in whole indices
+    const auto indexSize = allocation.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    const auto indexByteOffset = m_indexAllocator->allocate(allocation.indexByteSize, indexSize);
+    if (!indexByteOffset)
+    {
+        m_vertexAllocator->free(vertexOffset.value(), allocation.vertexCount);
+        return false;
+    }
+
+    allocation.vertexOffset = static_cast<GLuint>(vertexOffset.value());
+    allocation.indexByteOffset = indexByteOffset.value();
+    return true;
+}
+
+size_t MeshBuffer::allocationBytes(const MeshAllocation& allocation) const
+{
+    const auto vertexBytes = m_format == VertexFormat::Quantised
+                           ? sizeof(QuantisedPosition) + sizeof(QuantisedVertexAttributes)
+                           : sizeof(glm::vec3) + sizeof(VertexAttributes);
+    return allocation.vertexCount * vertexBytes + allocation.indexByteSize;
+}
+
+void MeshBuffer::createBuffers()
+{
+    if (m_format == VertexFormat::Quantised)
+    {
+        m_quantisedPositionBuffer = std::make_unique<Buffer<QuantisedPosition>>(m_vertexCapacity);
+        m_quantisedAttributeBuffer = std::make_unique<Buffer<QuantisedVertexAttributes>>(m_vertexCapacity);
+    }
+    else
+    {
+        m_positionBuffer = std::make_unique<Buffer<glm::vec3>>(m_vertexCapacity);
+        m_attributeBuffer = std::make_unique<Buffer<VertexAttributes>>(m_vertexCapacity);
+    }
+
+    m_indexBuffer = std::make_unique<Buffer<GLubyte>>(m_indexCapacity);
+}
+
+void MeshBuffer::uploadFloat(const MeshAllocation& allocation)
+{
+    auto positions = std::vector<glm::vec3>{};
+    auto attributes = std::vector<VertexAttributes>{};
+
+    for (const auto& vertex : allocation.mesh->vertices)
+    {
+        positions.push_back(vertex.position);
+        attributes.push_back({vertex.normal, vertex.textureUV});
+    }
+
+    m_positionBuffer->write(positions, allocation.vertexOffset);
+    m_attributeBuffer->write(attributes, allocation.vertexOffset);
+}
+
+void MeshBuffer::uploadQuantised(MeshAllocation& allocation)
+{
+    auto positions = std::vector<QuantisedPosition>{};
+    auto attributes = std::vector<QuantisedVertexAttributes>{};
+
+    const auto* mesh = allocation.mesh;
+
+    // Positions are stored as fractions of the mesh's bounding box, so precision follows the mesh size
+    const auto& boxMin = mesh->boundingBox.min();
+    const auto extent = mesh->boundingBox.max() - boxMin;
+    const auto inverseExtent = glm::vec3{
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f};
+
+    allocation.positionDequantisation = glm::scale(glm::translate(glm::mat4{1.0f}, boxMin), extent);
+
+    for (const auto& vertex : mesh->vertices)
+    {
+        const auto fraction = (vertex.position - boxMin) * inverseExtent;
+
+        auto position = QuantisedPosition{};
+        position.x = quantiseUnorm16(fraction.x);
+        position.y = quantiseUnorm16(fraction.y);
+        position.z = quantiseUnorm16(fraction.z);
+        positions.push_back(position);
+
+        const auto normalLength = glm::length(vertex.normal);
+        const auto normal = normalLength > 0.0f ? encodeOctahedral(vertex.normal / normalLength) : glm::vec2{0.0f};
+
+        auto attribute = QuantisedVertexAttributes{};
+        attribute.normal[0] = quantiseSnorm16(normal.x);
+        attribute.normal[1] = quantiseSnorm16(normal.y);
+        attribute.textureUV[0] = glm::packHalf1x16(vertex.textureUV.x);
+        attribute.textureUV[1] = glm::packHalf1x16(vertex.textureUV.y);
+        attributes.push_back(attribute);
+    }
+
+    m_quantisedPositionBuffer->write(positions, allocation.vertexOffset);
+    m_quantisedAttributeBuffer->write(attributes, allocation.vertexOffset);
+}
+
+void MeshBuffer::uploadIndices(const MeshAllocation& allocation)
+{
+    const auto& indices = allocation.mesh->indices;
+
+    auto indexData = std::vector<GLubyte>(allocation.indexByteSize);
+    if (allocation.indexType == GL_UNSIGNED_SHORT)
+    {
+        auto shortIndices = std::vector<GLushort>(indices.begin(), indices.end());
+        std::memcpy(indexData.data(), shortIndices.data(), indexData.size());
+    }
+    else
+    {
+        std::memcpy(indexData.data(), indices.data(), indexData.size());
+    }
+
+    m_indexBuffer->write(indexData, allocation.indexByteOffset);
 }
 
 void MeshBuffer::bindToVertexLayout(const VertexLayout& vertexLayout) const
 {
-    vertexLayout.bindVertexBuffer(0, m_vertexBuffer->handle(), 0, sizeof(Vertex));
+    bindPositions(vertexLayout);
+
+    if (m_format == VertexFormat::Quantised)
+    {
+        vertexLayout.registerAttribute(1, 2, GL_HALF_FLOAT, offsetof(QuantisedVertexAttributes, textureUV), attributeStream);
+        vertexLayout.registerAttribute(2, 2, GL_SHORT, offsetof(QuantisedVertexAttributes, normal), attributeStream,
+                                       AttributeFormat::Normalised);
+        vertexLayout.bindVertexBuffer(attributeStream, m_quantisedAttributeBuffer->handle(), 0, sizeof(QuantisedVertexAttributes));
+    }
+    else
+    {
+        vertexLayout.registerAttribute(1, 2, GL_FLOAT, offsetof(VertexAttributes, textureUV), attributeStream);
+        vertexLayout.registerAttribute(2, 3, GL_FLOAT, offsetof(VertexAttributes, normal), attributeStream);
+        vertexLayout.bindVertexBuffer(attributeStream, m_attributeBuffer->handle(), 0, sizeof(VertexAttributes));
+    }
+
+    vertexLayout.bindElementBuffer(m_indexBuffer->handle());
+}
+
+void MeshBuffer::bindPositionsToVertexLayout(const VertexLayout& vertexLayout) const
+{
+    bindPositions(vertexLayout);
     vertexLayout.bindElementBuffer(m_indexBuffer->handle());
 }
+
+void MeshBuffer::bindPositions(const VertexLayout& vertexLayout) const
+{
+    // The formats belong to the buffer rather than the pass, so they are set whenever the buffer is bound
+    if (m_format == VertexFormat::Quantised)
+    {
+        vertexLayout.registerAttribute(0, 3, GL_UNSIGNED_SHORT, 0, positionStream, AttributeFormat::Normalised);
+        vertexLayout.bindVertexBuffer(positionStream, m_quantisedPositionBuffer->handle(), 0, sizeof(QuantisedPosition));
+    }
+    else
+    {
+        vertexLayout.registerAttribute(0, 3, GL_FLOAT, 0, positionStream);
+        vertexLayout.bindVertexBuffer(positionStream, m_positionBuffer->handle(), 0, sizeof(glm::vec3));
+    }
+}
@@ -5,18 +5,43 @@
 
 #include "core/Vertex.h"
 #include "rendering/Buffer.h"
+#include "rendering/DrawCommand.h"
+#include "rendering/FreeListAllocator.h"
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
 class Mesh;
 class VertexLayout;
 
+using MeshHandle = uint32_t;
+
+enum class VertexFormat
+{
+    // 32 bytes per vertex, floats throughout
+    Float,
+    // 16 bytes per vertex, see QuantisedPosition and QuantisedVertexAttributes
+    Quantised
+};
+
+// Sub-allocates the vertices and indices of meshes from preallocated GPU arenas, so meshes can be added and
+// removed at runtime by uploading only their own data. Vertices are split into two streams, positions and
+// everything else, so passes that only need positions fetch just the position stream.
+// Indices are stored 16-bit for every mesh whose vertex count allows it.
+// The mesh shaders read position at location 0, texture coordinate at 1 and normal at 2
 class MeshBuffer
 {
     public:
-        explicit MeshBuffer(const std::vector<Mesh*>& meshes);
+        static constexpr GLuint positionStream = 0;
+        static constexpr GLuint attributeStream = 1;
+
+        // The index capacity is in bytes, since 16-bit and 32-bit indices share the arena
+        MeshBuffer(VertexFormat format, size_t vertexCapacity, size_t indexCapacity);
         ~MeshBuffer();
 
         MeshBuffer(const MeshBuffer& other) = delete;
@@ -25,24 +50,88 @@ class MeshBuffer
         MeshBuffer& operator=(const MeshBuffer& other) = delete;
         MeshBuffer& operator=(MeshBuffer&& other) = delete;   
 
-        inline GLuint vertexOffsetOfMesh(Mesh* mesh) const;
-        inline GLuint indexOffsetOfMesh(Mesh* mesh) const;
+        // Uploads a mesh into free space. Returns nothing if no free range is large enough, which compaction
+        // may fix over the next frames. The handle stays valid until the mesh is removed, even across compaction
+        std::optional<MeshHandle> addMesh(Mesh* mesh);
+
+        // Releases the mesh's space. It must not be drawn again until it is re-added
+        void removeMesh(MeshHandle handle);
+
+        // Moves meshes into free space nearer the start of the arenas with GPU copies, copying at most
+        // byteBudget bytes, so the holes left by removals merge over a few frames instead of in one stall.
+        // Moved meshes have new offsets, so call it before any draw is queued for the frame
+        void compact(size_t byteBudget);
+
+        // Nothing if the mesh was never added or failed to fit
+        inline std::optional<MeshHandle> handleOfMesh(Mesh* mesh) const;
+
+        // Everything needed to draw the mesh, resolved once when its draw command is queued
+        GpuMesh gpuMesh(MeshHandle handle) const;
+
+        // Normals in the attribute stream are octahedral encoded and must be decoded by the shader
+        inline bool octahedralNormals() const;
 
+        // Sets up the attribute formats of the streams and binds both of them and the indices
         void bindToVertexLayout(const VertexLayout& vertexLayout) const;
 
+        // Sets up and binds only the position stream and the indices, for shadow and depth passes
+        void bindPositionsToVertexLayout(const VertexLayout& vertexLayout) const;
+
+    private:
+        struct MeshAllocation
+        {
+            Mesh* mesh{nullptr};
+            GLuint vertexOffset{0};
+            GLuint vertexCount{0};
+            size_t indexByteOffset{0};
+            size_t indexByteSize{0};
+            GLenum indexType{GL_UNSIGNED_INT};
+            glm::mat4 positionDequantisation{1.0f};
+        };
+
+        bool allocate(MeshAllocation& allocation);
+        size_t allocationBytes(const MeshAllocation& allocation) const;
+
+        void createBuffers();
+
+        void uploadFloat(const MeshAllocation& allocation);
+        void uploadQuantised(MeshAllocation& allocation);
+        void uploadIndices(const MeshAllocation& allocation);
+
+        void bindPositions(const VertexLayout& vertexLayout) const;
+
     private:
-        std::unique_ptr<Buffer<Vertex>> m_vertexBuffer{nullptr};
-        std::unique_ptr<Buffer<GLuint>> m_indexBuffer{nullptr};
-        std::unordered_map<Mesh*, GLuint> m_vertexOffsets;
-        std::unordered_map<Mesh*, GLuint> m_indexOffsets;
+        VertexFormat m_format{VertexFormat::Float};
+        size_t m_vertexCapacity{0};
+        size_t m_indexCapacity{0};
+
+        std::unique_ptr<Buffer<glm::vec3>> m_positionBuffer{nullptr};
+        std::unique_ptr<Buffer<VertexAttributes>> m_attributeBuffer{nullptr};
+        std::unique_ptr<Buffer<QuantisedPosition>> m_quantisedPositionBuffer{nullptr};
+        std::unique_ptr<Buffer<QuantisedVertexAttributes>> m_quantisedAttributeBuffer{nullptr};
+        std::unique_ptr<Buffer<GLubyte>> m_indexBuffer{nullptr};
+
+        std::unique_ptr<FreeListAllocator> m_vertexAllocator{nullptr};
+        std::unique_ptr<FreeListAllocator> m_indexAllocator{nullptr};
+
+        // Indexed by handle. Removed meshes leave a slot with no mesh, reused by later additions
+        std::vector<MeshAllocation> m_allocations;
+        std::vector<MeshHandle> m_freeHandles;
+        std::unordered_map<Mesh*, MeshHandle> m_handles;
+        // Set when a removal or a failed addition leaves holes worth compacting
+        bool m_fragmented{false};
 };
 
-inline GLuint MeshBuffer::vertexOffsetOfMesh(Mesh* mesh) const
+inline std::optional<MeshHandle> MeshBuffer::handleOfMesh(Mesh* mesh) const
 {
-    return m_vertexOffsets.at(mesh);
+    if (auto handle = m_handles.find(mesh); handle != m_handles.end())
+    {
+        return handle->second;
+    }
+    return std::nullopt;
 }
 
-inline GLuint MeshBuffer::indexOffsetOfMesh(Mesh* mesh) const
+inline bool MeshBuffer::octahedralNormals() const
 {
-    return m_indexOffsets.at(mesh);
+    return m_format == VertexFormat::Quantised;
 }
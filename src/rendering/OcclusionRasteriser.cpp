@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "OcclusionRasteriser.h"
+
+#include "data/OccluderMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+constexpr auto fullRow = ~uint32_t{0};
+
+// Pixels a span is widened by on each side. Triangles sharing an edge solve it from opposite ends, and with
+// different rounding a pixel centre lying on the edge can fall outside both. The overhang this adds is far
+// inside the pixel that isVisible grows its rectangles by
+constexpr auto spanTolerance = 1.0f / 256.0f;
+
+// Bits for the pixels [start, end) of a tile row, the leftmost pixel in the top bit
+uint32_t rowSpanMask(int start, int end)
+{
+    const auto fromStart = start < OcclusionRasteriser::tileWidth ? fullRow >> start : 0u;
+    const auto fromEnd = end < OcclusionRasteriser::tileWidth ? fullRow >> end : 0u;
+    return fromStart & ~fromEnd;
+}
+
+OcclusionRasteriser::OcclusionRasteriser(int width, int height)
+    : m_width{width}
+    , m_height{height}
+    , m_tileColumns{width / tileWidth}
+    , m_tileRows{height / tileHeight}
+{
+    if (width <= 0 || height <= 0 || width % tileWidth != 0 || height % tileHeight != 0)
+    {
+        throw std::runtime_error("OcclusionRasteriser size must be a whole number of tiles");
+    }
+
+    m_tiles.resize(static_cast<size_t>(m_tileColumns) * m_tileRows);
+}
+
+void OcclusionRasteriser::begin(const glm::mat4& viewProjection)
+{
+    std::fill(m_tiles.begin(), m_tiles.end(), Tile{});
+    m_triangles.clear();
+    m_viewProjection = viewProjection;
+}
+
+void OcclusionRasteriser::addOccluder(const OccluderMesh& occluder, const glm::mat4& transform)
+{
+    const auto modelViewProjection = m_viewProjection * transform;
+    const auto screenScale = glm::vec3{0.5f * m_width, 0.5f * m_height, 0.5f};
+
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+    {
+        auto triangle = ScreenTriangle{};
+        auto clipped = false;
+
+        for (auto v = 0; v < 3; ++v)
+        {
+            const auto clip = modelViewProjection * glm::vec4{occluder.positions[occluder.indices[i + v]], 1.0f};
+
+            // Dropping a triangle only makes the buffer hide less, so there is no need to clip against the near plane
+            if (clip.w <= std::numeric_limits<float>::epsilon() || clip.z < -clip.w)
+            {
+                clipped = true;
+                break;
+            }
+
+            triangle.vertices[v] = (glm::vec3{clip} / clip.w + 1.0f) * screenScale;
+        }
+
+        if (clipped)
+        {
+            continue;
+        }
+
+        // Occluders are closed, so their back faces are always behind their front faces
+        const auto edge1 = glm::vec2{triangle.vertices[1] - triangle.vertices[0]};
+        const auto edge2 = glm::vec2{triangle.vertices[2] - triangle.vertices[0]};
+        if (edge1.x * edge2.y - edge1.y * edge2.x <= 0.0f)
+        {
+            continue;
+        }
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionRasteriser::rasteriseTileRows(int firstTileRow, int endTileRow)
+{
+    for (const auto& triangle : m_triangles)
+    {
+        rasteriseTriangle(triangle, firstTileRow, endTileRow);
+    }
+}
+
+bool OcclusionRasteriser::isVisible(const Box& worldBox) const
+{
+    auto screenMin = glm::vec2{std::numeric_limits<float>::max()};
+    auto screenMax = glm::vec2{-std::numeric_limits<float>::max()};
+    auto nearestDepth = 1.0f;
+
+    for (auto i = 0; i < 8; ++i)
+    {
+        const auto corner = glm::vec3{(i & 1) ? worldBox.max().x : worldBox.min().x,
+                                      (i & 2) ? worldBox.max().y : worldBox.min().y,
+                                      (i & 4) ? worldBox.max().z : worldBox.min().z};
+        const auto clip = m_viewProjection * glm::vec4{corner, 1.0f};
+
+        // Boxes reaching behind the near plane have no finite screen rectangle
+        if (clip.w <= std::numeric_limits<float>::epsilon() || clip.z < -clip.w)
+        {
+            return true;
+        }
+
+        const auto ndc = glm::vec3{clip} / clip.w;
+        const auto screen = (glm::vec2{ndc} + 1.0f) * 0.5f * glm::vec2{m_width, m_height};
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= m_width || screenMin.y >= m_height)
+    {
+        return false;
+    }
+
+    // Coverage is sampled at pixel centres, so an occluder can overhang its mesh by up to half a pixel.
+    // Growing the rectangle by a pixel keeps a box peeking out from behind it visible
+    const auto startX = std::max(static_cast<int>(std::floor(screenMin.x)) - 1, 0);
+    const auto startY = std::max(static_cast<int>(std::floor(screenMin.y)) - 1, 0);
+    const auto endX = std::min(static_cast<int>(std::ceil(screenMax.x)) + 1, m_width);
+    const auto endY = std::min(static_cast<int>(std::ceil(screenMax.y)) + 1, m_height);
+
+    for (auto tileRow = startY / tileHeight; tileRow <= (endY - 1) / tileHeight; ++tileRow)
+    {
+        for (auto tileColumn = startX / tileWidth; tileColumn <= (endX - 1) / tileWidth; ++tileColumn)
+        {
+            const auto& tile = m_tiles[static_cast<size_t>(tileRow) * m_tileColumns + tileColumn];
+            const auto tileX = tileColumn * tileWidth;
+
+            auto inWorkingLayer = uint32_t{0};
+            auto inReferenceLayer = uint32_t{0};
+            for (auto row = 0; row < tileHeight; ++row)
+            {
+                const auto y = tileRow * tileHeight + row;
+                const auto rectMask = y >= startY && y < endY
+                    ? rowSpanMask(std::max(startX - tileX, 0), std::min(endX - tileX, tileWidth))
+                    : 0u;
+                inWorkingLayer |= rectMask & tile.coverage[row];
+                inReferenceLayer |= rectMask & ~tile.coverage[row];
+            }
+
+            // Pixels in the working layer are bounded by both depths, the rest only by the reference
+            auto farthestDepth = 0.0f;
+            if (inReferenceLayer != 0)
+            {
+                farthestDepth = tile.referenceDepth;
+            }
+            if (inWorkingLayer != 0)
+            {
+                farthestDepth = std::max(farthestDepth, std::min(tile.workingDepth, tile.referenceDepth));
+            }
+
+            if (nearestDepth <= farthestDepth)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void OcclusionRasteriser::rasteriseTriangle(const ScreenTriangle& triangle, int firstTileRow, int endTileRow)
+{
+    const auto& v0 = triangle.vertices[0];
+    const auto& v1 = triangle.vertices[1];
+    const auto& v2 = triangle.vertices[2];
+
+    const auto boundsMin = glm::min(glm::min(v0, v1), v2);
+    const auto boundsMax = glm::max(glm::max(v0, v1), v2);
+    if (boundsMax.x < 0.0f || boundsMax.y < 0.0f || boundsMin.x >= m_width || boundsMin.y >= m_height)
+    {
+        return;
+    }
+
+    const auto firstColumn = std::max(static_cast<int>(boundsMin.x), 0) / tileWidth;
+    const auto lastColumn = std::min(static_cast<int>(boundsMax.x), m_width - 1) / tileWidth;
+    const auto firstRow = std::max(std::max(static_cast<int>(boundsMin.y), 0) / tileHeight, firstTileRow);
+    const auto lastRow = std::min(std::min(static_cast<int>(boundsMax.y), m_height - 1) / tileHeight, endTileRow - 1);
+    if (firstRow > lastRow)
+    {
+        return;
+    }
+
+    // Inside is where a * x + b * y + c >= 0 for all three edges of the counter-clockwise triangle
+    glm::vec3 edges[3];
+    for (auto e = 0; e < 3; ++e)
+    {
+        const auto& from = triangle.vertices[e];
+        const auto& to = triangle.vertices[(e + 1) % 3];
+        const auto a = from.y - to.y;
+        const auto b = to.x - from.x;
+        edges[e] = glm::vec3{a, b, -(a * from.x + b * from.y)};
+    }
+
+    // Depth is linear in screen space, so its farthest point over a tile is at one of the tile's corners
+    const auto edge1 = v1 - v0;
+    const auto edge2 = v2 - v0;
+    const auto area = edge1.x * edge2.y - edge1.y * edge2.x;
+    const auto depthX = (edge1.z * edge2.y - edge2.z * edge1.y) / area;
+    const auto depthY = (edge2.z * edge1.x - edge1.z * edge2.x) / area;
+    const auto depthOrigin = v0.z - depthX * v0.x - depthY * v0.y;
+
+    for (auto tileRow = firstRow; tileRow <= lastRow; ++tileRow)
+    {
+        // Each pixel row of the tile row is a single span, found once and shared by every tile along it
+        int spanStart[tileHeight];
+        int spanEnd[tileHeight];
+        for (auto row = 0; row < tileHeight; ++row)
+        {
+            const auto y = static_cast<float>(tileRow * tileHeight + row) + 0.5f;
+
+            auto left = -1.0f;
+            auto right = static_cast<float>(m_width) + 1.0f;
+            for (const auto& edge : edges)
+            {
+                const auto offset = edge.y * y + edge.z;
+                if (edge.x > 0.0f)
+                {
+                    left = std::max(left, -offset / edge.x);
+                }
+                else if (edge.x < 0.0f)
+                {
+                    right = std::min(right, -offset / edge.x);
+                }
+                else if (offset < 0.0f)
+                {
+                    right = left;
+                }
+            }
+
+            // Pixels whose centres lie within [left, right]
+            spanStart[row] = static_cast<int>(std::ceil(std::clamp(left - spanTolerance, -1.0f, m_width + 1.0f) - 0.5f));
+            spanEnd[row] = static_cast<int>(std::floor(std::clamp(right + spanTolerance, -1.0f, m_width + 1.0f) - 0.5f)) + 1;
+        }
+
+        for (auto tileColumn = firstColumn; tileColumn <= lastColumn; ++tileColumn)
+        {
+            const auto tileX = tileColumn * tileWidth;
+
+            auto coverage = TileCoverage{};
+            auto covered = uint32_t{0};
+            for (auto row = 0; row < tileHeight; ++row)
+            {
+                coverage[row] = rowSpanMask(std::clamp(spanStart[row] - tileX, 0, tileWidth),
+                                            std::clamp(spanEnd[row] - tileX, 0, tileWidth));
+                covered |= coverage[row];
+            }
+
+            if (covered == 0)
+            {
+                continue;
+            }
+
+            const auto cornerX = static_cast<float>(depthX > 0.0f ? tileX + tileWidth : tileX);
+            const auto cornerY = static_cast<float>(depthY > 0.0f ? (tileRow + 1) * tileHeight : tileRow * tileHeight);
+            const auto depth = std::min(depthOrigin + depthX * cornerX + depthY * cornerY, boundsMax.z);
+
+            mergeIntoTile(m_tiles[static_cast<size_t>(tileRow) * m_tileColumns + tileColumn], coverage, depth);
+        }
+    }
+}
+
+void OcclusionRasteriser::mergeIntoTile(Tile& tile, const TileCoverage& coverage, float depth)
+{
+    // Already behind everything in the tile
+    if (depth >= tile.referenceDepth)
+    {
+        return;
+    }
+
+    // A triangle nearer the reference depth than the working depth would loosen the working layer more
+    // than it is worth, so the working layer is dropped and starts again from this triangle
+    if (depth - tile.workingDepth > tile.referenceDepth - depth)
+    {
+        tile.coverage = TileCoverage{};
+        tile.workingDepth = 0.0f;
+    }
+
+    tile.workingDepth = std::max(tile.workingDepth, depth);
+
+    auto full = fullRow;
+    for (auto row = 0; row < tileHeight; ++row)
+    {
+        tile.coverage[row] |= coverage[row];
+        full &= tile.coverage[row];
+    }
+
+    // Once the working layer covers the whole tile it bounds every pixel, and becomes the reference
+    if (full == fullRow)
+    {
+        tile.referenceDepth = std::min(tile.referenceDepth, tile.workingDepth);
+        tile.coverage = TileCoverage{};
+        tile.workingDepth = 0.0f;
+    }
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "data/Box.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct OccluderMesh;
+
+// Software masked occlusion buffer, filled from occluder meshes on the CPU and queried with bounding boxes.
+// The screen is split into 32x4 pixel tiles, each holding a coverage bit per pixel, one 32 bit word per row,
+// and two conservative depths: a reference layer for the whole tile and a working layer for the covered pixels.
+// Coverage is built a word at a time, so every operation handles a row of 32 pixels at once.
+// Nothing here touches the GPU, so it runs on any thread and without a context
+class OcclusionRasteriser
+{
+    public:
+        static constexpr int tileWidth = 32;
+        static constexpr int tileHeight = 4;
+
+        using TileCoverage = std::array<uint32_t, tileHeight>;
+
+        struct Tile
+        {
+            // A row of pixels per word, the leftmost pixel in the top bit
+            TileCoverage coverage{};
+            // Farthest depth of any pixel in the tile
+            float referenceDepth{1.0f};
+            // Farthest depth of the pixels set in coverage
+            float workingDepth{0.0f};
+        };
+
+        // Width must be a multiple of tileWidth and height a multiple of tileHeight
+        OcclusionRasteriser(int width, int height);
+
+        // Empties the buffer and the queued occluders, and sets the view both are seen from
+        void begin(const glm::mat4& viewProjection);
+
+        // Projects an occluder's front facing triangles to the screen and queues them
+        void addOccluder(const OccluderMesh& occluder, const glm::mat4& transform);
+
+        // Rasterises the queued triangles into the tile rows [firstTileRow, endTileRow).
+        // Bands share no tiles, so separate bands can be filled on separate threads
+        void rasteriseTileRows(int firstTileRow, int endTileRow);
+
+        // Whether any part of a world space box may be in front of the occluders, once rasterisation has finished.
+        // Boxes crossing the near plane are always visible, and boxes off screen never are
+        bool isVisible(const Box& worldBox) const;
+
+        // Folds a triangle's coverage of a tile into it, given the triangle's farthest depth over the tile
+        static void mergeIntoTile(Tile& tile, const TileCoverage& coverage, float depth);
+
+        inline int tileRowCount() const
+        {
+            return m_tileRows;
+        }
+
+        inline size_t triangleCount() const
+        {
+            return m_triangles.size();
+        }
+
+        // Tile columns count from the left and tile rows from the bottom
+        inline const Tile& tile(int tileColumn, int tileRow) const
+        {
+            return m_tiles[static_cast<size_t>(tileRow) * m_tileColumns + tileColumn];
+        }
+
+    private:
+        // Pixel coordinates with y up, and depth in [0, 1]
+        struct ScreenTriangle
+        {
+            glm::vec3 vertices[3];
+        };
+
+        void rasteriseTriangle(const ScreenTriangle& triangle, int firstTileRow, int endTileRow);
+
+    private:
+        std::vector<Tile> m_tiles;
+        std::vector<ScreenTriangle> m_triangles;
+        glm::mat4 m_viewProjection{1.0f};
+
+        int m_width{0};
+        int m_height{0};
+        int m_tileColumns{0};
+        int m_tileRows{0};
+};
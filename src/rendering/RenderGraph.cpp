@@ -0,0 +1,657 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "RenderGraph.h"
+
+#include "data/Texture.h"
+#include "rendering/GpuTimer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+size_t bytesPerPixel(GLenum format)
+{
+    switch(format)
+    {
+        case GL_R8:
+            return 1;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGBA8:
+        case GL_RG16:
+        case GL_RG16F:
+        case GL_RG16_SNORM:
+        case GL_R32F:
+        case GL_R32UI:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH_COMPONENT32F:
+            return 4;
+        case GL_RGBA16F:
+        case GL_RG32F:
+            return 8;
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+std::string formatName(GLenum format)
+{
+    switch(format)
+    {
+        case GL_R8: return "R8";
+        case GL_RG8: return "RG8";
+        case GL_R16F: return "R16F";
+        case GL_RGBA8: return "RGBA8";
+        case GL_RG16: return "RG16";
+        case GL_RG16F: return "RG16F";
+        case GL_RG16_SNORM: return "RG16_SNORM";
+        case GL_R32F: return "R32F";
+        case GL_R32UI: return "R32UI";
+        case GL_RGBA16F: return "RGBA16F";
+        case GL_RG32F: return "RG32F";
+        case GL_RGBA32F: return "RGBA32F";
+        case GL_DEPTH_COMPONENT16: return "DEPTH16";
+        case GL_DEPTH_COMPONENT24: return "DEPTH24";
+        case GL_DEPTH24_STENCIL8: return "DEPTH24_STENCIL8";
+        case GL_DEPTH_COMPONENT32F: return "DEPTH32F";
+        default: break;
+    }
+
+    auto stream = std::stringstream{};
+    stream << "0x" << std::hex << format;
+    return stream.str();
+}
+
+// Formats of the same class can view each other's storage. Depth formats only view their own
+GLenum viewClass(GLenum format)
+{
+    switch(format)
+    {
+        case GL_R8:
+            return GL_VIEW_CLASS_8_BITS;
+        case GL_RG8:
+        case GL_R16F:
+            return GL_VIEW_CLASS_16_BITS;
+        case GL_RGBA8:
+        case GL_RG16:
+        case GL_RG16F:
+        case GL_RG16_SNORM:
+        case GL_R32F:
+        case GL_R32UI:
+            return GL_VIEW_CLASS_32_BITS;
+        case GL_RGBA16F:
+        case GL_RG32F:
+            return GL_VIEW_CLASS_64_BITS;
+        case GL_RGBA32F:
+            return GL_VIEW_CLASS_128_BITS;
+        default:
+            return format;
+    }
+}
+
+size_t textureBytes(const RenderGraphTextureDesc& desc)
+{
+    return static_cast<size_t>(desc.width) * static_cast<size_t>(desc.height) * bytesPerPixel(desc.format);
+}
+
+std::string toMegabytes(size_t bytes)
+{
+    auto stream = std::stringstream{};
+    stream << std::fixed << std::setprecision(2) << (static_cast<double>(bytes) / (1024.0 * 1024.0)) << " MiB";
+    return stream.str();
+}
+
+RenderGraphBuilder::RenderGraphBuilder(RenderGraph& graph, size_t passIndex)
+    : m_graph{graph}
+    , m_passIndex{passIndex}
+{
+}
+
+void RenderGraphBuilder::create(const std::string& name, const RenderGraphTextureDesc& desc)
+{
+    const auto resourceIndex = m_graph.findOrAddResource(name);
+    auto& resource = m_graph.m_resources[resourceIndex];
+    resource.desc = desc;
+
+    // The creating pass always comes first, regardless of the order passes were added in,
+    // so reads declared before it see one more write than they counted
+    resource.writers.insert(resource.writers.begin(), m_passIndex);
+    for(auto& reader : resource.readers)
+    {
+        ++reader.version;
+    }
+    m_graph.m_passes[m_passIndex].creates.push_back(resourceIndex);
+}
+
+void RenderGraphBuilder::read(const std::string& name)
+{
+    const auto resourceIndex = m_graph.findOrAddResource(name);
+    auto& resource = m_graph.m_resources[resourceIndex];
+    resource.readers.push_back({m_passIndex, resource.writers.size()});
+    m_graph.m_passes[m_passIndex].reads.push_back(resourceIndex);
+}
+
+void RenderGraphBuilder::write(const std::string& name)
+{
+    const auto resourceIndex = m_graph.findOrAddResource(name);
+    m_graph.m_resources[resourceIndex].writers.push_back(m_passIndex);
+    m_graph.m_passes[m_passIndex].writes.push_back(resourceIndex);
+}
+
+RenderGraph::RenderGraph() = default;
+
+RenderGraph::~RenderGraph() = default;
+
+void RenderGraph::reset()
+{
+    m_passes.clear();
+    m_resources.clear();
+    m_resourceLookup.clear();
+    m_executionOrder.clear();
+    m_compiled = false;
+}
+
+void RenderGraph::addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+{
+    auto pass = PassNode{};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+
+    auto builder = RenderGraphBuilder{*this, m_passes.size() - 1};
+    setup(builder);
+
+    m_compiled = false;
+}
+
+void RenderGraph::importTexture(const std::string& name, Texture* texture)
+{
+    auto& resource = m_resources[findOrAddResource(name)];
+    resource.imported = true;
+    resource.texture = texture;
+}
+
+void RenderGraph::importBuffer(const std::string& name, GLuint buffer)
+{
+    auto& resource = m_resources[findOrAddResource(name)];
+    resource.imported = true;
+    resource.buffer = buffer;
+}
+
+GLuint RenderGraph::buffer(const std::string& name) const
+{
+    return m_resources[m_resourceLookup.at(name)].buffer;
+}
+
+int RenderGraph::transientSlot(const std::string& name) const
+{
+    return m_resources[m_resourceLookup.at(name)].pooledIndex;
+}
+
+void RenderGraph::markOutput(const std::string& name)
+{
+    m_resources[findOrAddResource(name)].output = true;
+}
+
+void RenderGraph::compile()
+{
+    schedule();
+    createTransients();
+
+    m_compiled = true;
+}
+
+void RenderGraph::schedule()
+{
+    for(auto& pass : m_passes)
+    {
+        pass.culled = false;
+    }
+
+    cullPasses();
+    sortPasses();
+    computeLifetimes();
+    assignSlots();
+}
+
+void RenderGraph::execute()
+{
+    if(!m_compiled)
+    {
+        throw std::runtime_error("RenderGraph executed before being compiled");
+    }
+
+    for(const auto passIndex : m_executionOrder)
+    {
+        const auto& pass = m_passes[passIndex];
+
+        // Timers are kept by name, so they survive the graph being rebuilt
+        auto& timer = m_passTimers[pass.name];
+        if(!timer)
+        {
+            timer = std::make_unique<GpuTimer>();
+        }
+
+        const auto cpuStart = std::chrono::steady_clock::now();
+
+        timer->begin();
+        pass.execute(*this);
+        timer->end();
+
+        const auto cpuDuration = std::chrono::steady_clock::now() - cpuStart;
+        m_passCpuMilliseconds[pass.name] = std::chrono::duration<double, std::milli>(cpuDuration).count();
+    }
+}
+
+std::vector<RenderGraph::PassTiming> RenderGraph::passTimings() const
+{
+    auto timings = std::vector<PassTiming>{};
+    for(const auto passIndex : m_executionOrder)
+    {
+        const auto& name = m_passes[passIndex].name;
+        if(const auto it = m_passTimers.find(name); it != m_passTimers.end())
+        {
+            timings.push_back({name, it->second->lastMilliseconds(), m_passCpuMilliseconds.at(name)});
+        }
+    }
+
+    return timings;
+}
+
+std::vector<std::string> RenderGraph::executionOrder() const
+{
+    auto names = std::vector<std::string>{};
+    for(const auto passIndex : m_executionOrder)
+    {
+        names.push_back(m_passes[passIndex].name);
+    }
+
+    return names;
+}
+
+std::string RenderGraph::dump() const
+{
+    auto stream = std::stringstream{};
+
+    const auto culledCount = std::count_if(m_passes.begin(), m_passes.end(), [](const auto& pass) { return pass.culled; });
+    stream << "RenderGraph: " << m_executionOrder.size() << " passes (" << culledCount << " culled), "
+           << m_resources.size() << " resources\n";
+
+    const auto resourceNames = [this](const std::vector<size_t>& indices) {
+        auto names = std::string{};
+        for(const auto index : indices)
+        {
+            names += (names.empty() ? "" : ", ") + m_resources[index].name;
+        }
+        return names.empty() ? std::string{"-"} : names;
+    };
+
+    stream << "Passes:\n";
+    for(size_t i = 0; i < m_executionOrder.size(); ++i)
+    {
+        const auto& pass = m_passes[m_executionOrder[i]];
+        stream << "  [" << i << "] " << pass.name
+               << "\n      creates: " << resourceNames(pass.creates)
+               << "\n      reads:   " << resourceNames(pass.reads)
+               << "\n      writes:  " << resourceNames(pass.writes) << "\n";
+    }
+    for(const auto& pass : m_passes)
+    {
+        if(pass.culled)
+        {
+            stream << "  [culled] " << pass.name << "\n";
+        }
+    }
+
+    auto requestedBytes = size_t{0};
+    stream << "Resources:\n";
+    for(const auto& resource : m_resources)
+    {
+        stream << "  " << resource.name << ": ";
+        if(resource.imported)
+        {
+            stream << "imported" << (resource.output ? ", output" : "") << "\n";
+            continue;
+        }
+        if(!resource.used)
+        {
+            stream << "unused\n";
+            continue;
+        }
+
+        const auto bytes = textureBytes(resource.desc);
+        requestedBytes += bytes;
+
+        stream << formatName(resource.desc.format) << " " << resource.desc.width << "x" << resource.desc.height
+               << ", " << toMegabytes(bytes)
+               << ", passes [" << resource.firstUse << ".." << resource.lastUse << "]"
+               << ", pool slot " << resource.pooledIndex << "\n";
+    }
+
+    auto allocatedBytes = size_t{0};
+    for(const auto& pooled : m_pool)
+    {
+        allocatedBytes += textureBytes({pooled.format, pooled.width, pooled.height});
+    }
+
+    stream << "Transient memory: " << toMegabytes(requestedBytes) << " requested, "
+           << toMegabytes(allocatedBytes) << " allocated in " << m_pool.size() << " textures ("
+           << toMegabytes(requestedBytes - allocatedBytes) << " saved by aliasing)\n";
+
+    return stream.str();
+}
+
+size_t RenderGraph::findOrAddResource(const std::string& name)
+{
+    if(const auto itr = m_resourceLookup.find(name); itr != m_resourceLookup.end())
+    {
+        return itr->second;
+    }
+
+    auto resource = ResourceNode{};
+    resource.name = name;
+    m_resources.push_back(std::move(resource));
+
+    m_resourceLookup[name] = m_resources.size() - 1;
+    return m_resources.size() - 1;
+}
+
+Texture* RenderGraph::resolveTexture(const std::string& name) const
+{
+    return m_resources[m_resourceLookup.at(name)].texture;
+}
+
+void RenderGraph::cullPasses()
+{
+    for(auto& pass : m_passes)
+    {
+        pass.refCount = static_cast<int>(pass.creates.size() + pass.writes.size());
+    }
+
+    // A pass that modifies a resource in place also reads it, but that read must not keep its own write alive
+    const auto isWriterOf = [](const ResourceNode& resource, size_t passIndex) {
+        return std::find(resource.writers.begin(), resource.writers.end(), passIndex) != resource.writers.end();
+    };
+
+    auto unreferenced = std::vector<size_t>{};
+    for(size_t i = 0; i < m_resources.size(); ++i)
+    {
+        auto& resource = m_resources[i];
+        resource.refCount = resource.output ? 1 : 0;
+        for(const auto& reader : resource.readers)
+        {
+            if(!isWriterOf(resource, reader.pass))
+            {
+                ++resource.refCount;
+            }
+        }
+
+        if(resource.refCount == 0)
+        {
+            unreferenced.push_back(i);
+        }
+    }
+
+    while(!unreferenced.empty())
+    {
+        const auto& resource = m_resources[unreferenced.back()];
+        unreferenced.pop_back();
+
+        for(const auto writerIndex : resource.writers)
+        {
+            auto& writer = m_passes[writerIndex];
+            if(writer.culled || --writer.refCount > 0)
+            {
+                continue;
+            }
+
+            writer.culled = true;
+            for(const auto readIndex : writer.reads)
+            {
+                auto& read = m_resources[readIndex];
+                if(!isWriterOf(read, writerIndex) && --read.refCount == 0)
+                {
+                    unreferenced.push_back(readIndex);
+                }
+            }
+        }
+    }
+}
+
+void RenderGraph::sortPasses()
+{
+    auto dependents = std::vector<std::set<size_t>>(m_passes.size());
+    auto dependencyCount = std::vector<size_t>(m_passes.size(), 0);
+
+    const auto addEdge = [&](size_t from, size_t to) {
+        if(from != to && dependents[from].insert(to).second)
+        {
+            ++dependencyCount[to];
+        }
+    };
+
+    for(const auto& resource : m_resources)
+    {
+        // Writers apply in order: creator first, then each in-place modification
+        for(size_t i = 1; i < resource.writers.size(); ++i)
+        {
+            addEdge(resource.writers[i - 1], resource.writers[i]);
+        }
+
+        // A reader runs after the write that made the version it reads, and before the write that replaces it
+        for(const auto& reader : resource.readers)
+        {
+            if(reader.version > 0)
+            {
+                addEdge(resource.writers[reader.version - 1], reader.pass);
+            }
+            if(reader.version < resource.writers.size())
+            {
+                addEdge(reader.pass, resource.writers[reader.version]);
+            }
+        }
+    }
+
+    // Kahn's algorithm, preferring the order passes were added in when there is a choice
+    auto ready = std::set<size_t>{};
+    for(size_t i = 0; i < m_passes.size(); ++i)
+    {
+        if(dependencyCount[i] == 0)
+        {
+            ready.insert(i);
+        }
+    }
+
+    auto sorted = std::vector<size_t>{};
+    while(!ready.empty())
+    {
+        const auto passIndex = *ready.begin();
+        ready.erase(ready.begin());
+        sorted.push_back(passIndex);
+
+        for(const auto dependent : dependents[passIndex])
+        {
+            if(--dependencyCount[dependent] == 0)
+            {
+                ready.insert(dependent);
+            }
+        }
+    }
+
+    if(sorted.size() != m_passes.size())
+    {
+        throw std::runtime_error("RenderGraph contains a dependency cycle");
+    }
+
+    m_executionOrder.clear();
+    for(const auto passIndex : sorted)
+    {
+        if(!m_passes[passIndex].culled)
+        {
+            m_executionOrder.push_back(passIndex);
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    auto position = std::vector<int>(m_passes.size(), -1);
+    for(size_t i = 0; i < m_executionOrder.size(); ++i)
+    {
+        position[m_executionOrder[i]] = static_cast<int>(i);
+    }
+
+    for(auto& resource : m_resources)
+    {
+        auto first = -1;
+        auto last = -1;
+
+        const auto extend = [&](size_t passIndex) {
+            const auto pos = position[passIndex];
+            if(pos < 0)
+            {
+                return;
+            }
+            first = first < 0 ? pos : std::min(first, pos);
+            last = std::max(last, pos);
+        };
+
+        std::for_each(resource.writers.begin(), resource.writers.end(), extend);
+        for(const auto& reader : resource.readers)
+        {
+            extend(reader.pass);
+        }
+
+        resource.used = first >= 0;
+        resource.pooledIndex = -1;
+        resource.firstUse = resource.used ? static_cast<size_t>(first) : 0;
+        resource.lastUse = resource.used ? static_cast<size_t>(last) : 0;
+
+        if(!resource.imported)
+        {
+            resource.texture = nullptr;
+        }
+    }
+}
+
+void RenderGraph::assignSlots()
+{
+    for(auto& pooled : m_pool)
+    {
+        pooled.used = false;
+    }
+
+    auto busy = std::vector<bool>(m_pool.size(), false);
+
+    for(size_t pos = 0; pos < m_executionOrder.size(); ++pos)
+    {
+        // Take a slot for each resource whose lifetime starts here
+        for(auto& resource : m_resources)
+        {
+            if(resource.imported || !resource.used || resource.firstUse != pos)
+            {
+                continue;
+            }
+
+            const auto resourceClass = viewClass(resource.desc.format);
+            auto slot = -1;
+            for(size_t i = 0; i < m_pool.size(); ++i)
+            {
+                const auto& pooled = m_pool[i];
+                if(!busy[i] && pooled.viewClass == resourceClass
+                   && pooled.width == resource.desc.width && pooled.height == resource.desc.height)
+                {
+                    slot = static_cast<int>(i);
+                    break;
+                }
+            }
+
+            if(slot < 0)
+            {
+                auto pooled = PooledTexture{};
+                pooled.viewClass = resourceClass;
+                pooled.format = resource.desc.format;
+                pooled.width = resource.desc.width;
+                pooled.height = resource.desc.height;
+                m_pool.push_back(std::move(pooled));
+                busy.push_back(false);
+                slot = static_cast<int>(m_pool.size() - 1);
+            }
+
+            busy[slot] = true;
+            m_pool[slot].used = true;
+            resource.pooledIndex = slot;
+        }
+
+        // Free the slots whose last use is this pass, so later resources can alias them
+        for(const auto& resource : m_resources)
+        {
+            if(!resource.imported && resource.pooledIndex >= 0 && resource.lastUse == pos)
+            {
+                busy[resource.pooledIndex] = false;
+            }
+        }
+    }
+
+    // Drop slots nobody needs any more (e.g. the old size after a resize)
+    auto remap = std::vector<int>(m_pool.size(), -1);
+    auto kept = std::vector<PooledTexture>{};
+    for(size_t i = 0; i < m_pool.size(); ++i)
+    {
+        if(m_pool[i].used)
+        {
+            remap[i] = static_cast<int>(kept.size());
+            kept.push_back(std::move(m_pool[i]));
+        }
+    }
+    m_pool = std::move(kept);
+
+    for(auto& resource : m_resources)
+    {
+        if(!resource.imported && resource.pooledIndex >= 0)
+        {
+            resource.pooledIndex = remap[resource.pooledIndex];
+        }
+    }
+}
+
+void RenderGraph::createTransients()
+{
+    for(auto& resource : m_resources)
+    {
+        if(resource.imported || resource.pooledIndex < 0)
+        {
+            continue;
+        }
+
+        auto& pooled = m_pool[resource.pooledIndex];
+        if(!pooled.storage)
+        {
+            pooled.storage = std::make_unique<Texture2D>(pooled.format, pooled.width, pooled.height);
+        }
+
+        // Filtering is per view, so resources sharing storage can still sample it differently
+        auto view = std::find_if(pooled.views.begin(), pooled.views.end(), [&](const auto& pooledView) {
+            return pooledView.format == resource.desc.format && pooledView.filter == resource.desc.filter;
+        });
+        if(view == pooled.views.end())
+        {
+            auto texture = std::make_unique<Texture2DView>(*pooled.storage, resource.desc.format);
+            texture->setMinFilter(resource.desc.filter);
+            texture->setMagFilter(resource.desc.filter);
+            pooled.views.push_back({resource.desc.format, resource.desc.filter, std::move(texture)});
+            view = pooled.views.end() - 1;
+        }
+
+        resource.texture = view->texture.get();
+    }
+}
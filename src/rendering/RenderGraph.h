@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GpuTimer;
+class RenderGraph;
+class Texture;
+class Texture2D;
+class Texture2DView;
+
+struct RenderGraphTextureDesc
+{
+    GLenum format{GL_RGBA8};
+    GLsizei width{0};
+    GLsizei height{0};
+    GLenum filter{GL_LINEAR};
+
+    bool operator==(const RenderGraphTextureDesc& other) const = default;
+};
+
+// Handed to a pass while it is being added so it can declare which resources it touches.
+// Declarations are by name, so passes can be added in any order and still resolve to the same graph.
+class RenderGraphBuilder
+{
+    public:
+        // Declares a transient texture owned by the graph, written first by this pass
+        void create(const std::string& name, const RenderGraphTextureDesc& desc);
+
+        // Declares that this pass samples a resource as the writes declared before it left it
+        void read(const std::string& name);
+
+        // Declares that this pass writes a resource, making a new version of it. The pass runs after the
+        // previous writer and after every pass that reads the previous version, so those see it unmodified
+        void write(const std::string& name);
+
+    private:
+        friend class RenderGraph;
+
+        RenderGraphBuilder(RenderGraph& graph, size_t passIndex);
+
+    private:
+        RenderGraph& m_graph;
+        size_t m_passIndex{0};
+};
+
+class RenderGraph
+{
+    public:
+        using SetupFunction = std::function<void(RenderGraphBuilder&)>;
+        using ExecuteFunction = std::function<void(const RenderGraph&)>;
+
+        struct PassTiming
+        {
+            std::string name;
+            double gpuMilliseconds{0.0};
+            // Time spent recording the pass on the CPU, which is mostly draw submission
+            double cpuMilliseconds{0.0};
+        };
+
+        RenderGraph();
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph& other) = delete;
+        RenderGraph(RenderGraph&& other) = delete;
+
+        RenderGraph& operator=(const RenderGraph& other) = delete;
+        RenderGraph& operator=(RenderGraph&& other) = delete;
+
+        // Clears all passes and resources. Pooled textures are kept so they can be reused by the next compile
+        void reset();
+
+        void addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+        // Registers a resource whose lifetime is managed outside the graph (may be null for the back buffer)
+        void importTexture(const std::string& name, Texture* texture);
+
+        // Registers a GL buffer written and read by passes, so it orders and keeps alive the passes like a texture would
+        void importBuffer(const std::string& name, GLuint buffer);
+
+        // Marks a resource as a result of the frame, so the passes producing it are never culled
+        void markOutput(const std::string& name);
+
+        void compile();
+        void execute();
+
+        // Culls and orders the passes and assigns transients to pool slots without creating any textures,
+        // so a graph can be checked without a GL context. Throws if the passes depend on each other in a cycle
+        void schedule();
+
+        template <typename TextureType>
+        TextureType* texture(const std::string& name) const
+        {
+            return static_cast<TextureType*>(resolveTexture(name));
+        }
+
+        GLuint buffer(const std::string& name) const;
+
+        // Pool slot of a transient, -1 for imported and unused resources. Transients given the same slot
+        // share one texture's memory, each through a view in its own format
+        int transientSlot(const std::string& name) const;
+
+        std::string dump() const;
+
+        // Names of the passes left after culling, in the order they run
+        std::vector<std::string> executionOrder() const;
+
+        // GPU time of each executed pass, in execution order, from the latest frames the GPU has finished
+        std::vector<PassTiming> passTimings() const;
+
+    private:
+        friend class RenderGraphBuilder;
+
+        struct ResourceRead
+        {
+            size_t pass{0};
+            // Writes declared before the read, 0 for the resource as imported
+            size_t version{0};
+        };
+
+        struct ResourceNode
+        {
+            std::string name;
+            RenderGraphTextureDesc desc{};
+            bool imported{false};
+            bool output{false};
+            bool used{false};
+            Texture* texture{nullptr};
+            GLuint buffer{0};
+            std::vector<size_t> writers;
+            std::vector<ResourceRead> readers;
+            int refCount{0};
+            size_t firstUse{0};
+            size_t lastUse{0};
+            int pooledIndex{-1};
+        };
+
+        struct PassNode
+        {
+            std::string name;
+            ExecuteFunction execute;
+            std::vector<size_t> creates;
+            std::vector<size_t> reads;
+            std::vector<size_t> writes;
+            int refCount{0};
+            bool culled{false};
+        };
+
+        struct PooledView
+        {
+            GLenum format{GL_RGBA8};
+            GLenum filter{GL_LINEAR};
+            std::unique_ptr<Texture2DView> texture{nullptr};
+        };
+
+        // Storage for transients whose lifetimes do not overlap. Any format of the same view class and size
+        // can be viewed into it, so a G-buffer target can take the memory of one of a different format
+        struct PooledTexture
+        {
+            GLenum viewClass{0};
+            // Format the storage is created with, that of the first transient given the slot
+            GLenum format{GL_RGBA8};
+            GLsizei width{0};
+            GLsizei height{0};
+            // Null until compile() creates it
+            std::unique_ptr<Texture2D> storage{nullptr};
+            std::vector<PooledView> views;
+            bool used{false};
+        };
+
+        size_t findOrAddResource(const std::string& name);
+        Texture* resolveTexture(const std::string& name) const;
+
+        void cullPasses();
+        void sortPasses();
+        void computeLifetimes();
+        void assignSlots();
+        void createTransients();
+
+    private:
+        std::vector<PassNode> m_passes;
+        std::vector<ResourceNode> m_resources;
+        std::unordered_map<std::string, size_t> m_resourceLookup;
+        std::vector<size_t> m_executionOrder;
+        std::vector<PooledTexture> m_pool;
+        std::unordered_map<std::string, std::unique_ptr<GpuTimer>> m_passTimers;
+        std::unordered_map<std::string, double> m_passCpuMilliseconds;
+        bool m_compiled{false};
+};
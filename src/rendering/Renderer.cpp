@@ -5,10 +5,21 @@
 
 #include "data/AssetDatabase.h"
 #include "data/Mesh.h"
+#include "data/Prefab.h"
+#include "data/Texture.h"
 #include "rendering/Camera.h"
+#include "rendering/FramePasses.h"
+#include "rendering/GlStateCache.h"
 #include "rendering/MeshBuffer.h"
 
-constexpr auto maxPointLights = 8;
+#include <iostream>
+
+// Mesh arenas are sized up front so prefabs can be streamed in later without reallocating
+constexpr auto meshVertexCapacity = size_t{4} * 1024 * 1024;
+constexpr auto meshIndexCapacity = size_t{48} * 1024 * 1024;
+
+// Bytes of mesh data compaction may copy each frame, a few milliseconds of bus time at worst
+constexpr auto meshCompactionBudget = size_t{4} * 1024 * 1024;
 
 void GLAPIENTRY MessageCallback(
     GLenum source,
@@ -33,52 +44,73 @@ Renderer::Renderer()
     glDebugMessageCallback(MessageCallback, 0);
     glDebugMessageControl(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_OTHER, GL_DONT_CARE, 0, NULL, GL_FALSE);
     glDebugMessageControl(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, NULL, GL_FALSE);
+}
+
+Renderer::~Renderer() = default;
+
+void Renderer::setAssets(const AssetDatabase& assetDb, VertexFormat vertexFormat)
+{
+    m_meshBuffer = std::make_unique<MeshBuffer>(vertexFormat, meshVertexCapacity, meshIndexCapacity);
+
+    for(const auto& [id, prefab] : assetDb.prefabs())
+    {
+        addPrefab(*prefab);
+    }
+}
 
-    m_lightingRenderPass.setInputBinding(
-        [
-            gbuffer = &m_gbufferRenderPass,
-            dirShadow = &m_directionalShadowRenderPass,
-            plShadow = &m_pointLightShadowRenderPass
-        ]
-        ()
+void Renderer::addPrefab(const Prefab& prefab)
+{
+    for(size_t lod = 0; lod < prefab.lodCount(); ++lod)
+    {
+        for(const auto& mesh : prefab.lodMeshes(lod))
         {
-            auto inputs = LightingRenderPass::Inputs{};
-            inputs.colorImage = gbuffer->colorImage();
-            inputs.normalImage = gbuffer->normalImage();
-            inputs.positionImage = gbuffer->positionImage();
-            inputs.directionalLightShadowMapImage = dirShadow->directionalLightShadowMapImage();
-            inputs.pointLightShadowMapImage = plShadow->pointLightShadowMapImage();
-            return inputs;
+            addMesh(mesh.get());
         }
-    );
+    }
 
-    m_skyboxRenderPass.setInputBinding(
-        [
-            lightingPass = &m_lightingRenderPass
-        ]
-        ()
+    if(prefab.impostorEnabled())
+    {
+        if(auto atlas = m_impostorBaker.bake(prefab, *m_meshBuffer))
         {
-            auto inputs = SkyboxRenderPass::Inputs{};
-            inputs.targetImage = lightingPass->colorImage();
-            return inputs;
+            m_impostorAtlases[&prefab] = std::move(atlas);
         }
-    );
+    }
 }
 
-Renderer::~Renderer() = default;
-
-void Renderer::setAssets(const AssetDatabase& assetDb)
+void Renderer::removePrefab(const Prefab& prefab)
 {
-    auto meshes = std::vector<Mesh*>{};
-    for(const auto& [id, prefab] : assetDb.prefabs())
+    for(size_t lod = 0; lod < prefab.lodCount(); ++lod)
     {
-        for(const auto& mesh : prefab->meshes())
+        for(const auto& mesh : prefab.lodMeshes(lod))
         {
-            meshes.push_back(mesh.get());
+            removeMesh(mesh.get());
         }
     }
 
-    m_meshBuffer = std::make_unique<MeshBuffer>(meshes);
+    m_impostorAtlases.erase(&prefab);
+}
+
+bool Renderer::hasImpostor(const Prefab& prefab) const
+{
+    return m_impostorAtlases.contains(&prefab);
+}
+
+bool Renderer::addMesh(Mesh* mesh)
+{
+    if(!m_meshBuffer->addMesh(mesh))
+    {
+        std::cerr << "Mesh buffer is full, a mesh of " << mesh->vertices.size() << " vertices will not be drawn\n";
+        return false;
+    }
+    return true;
+}
+
+void Renderer::removeMesh(Mesh* mesh)
+{
+    if(const auto handle = m_meshBuffer->handleOfMesh(mesh))
+    {
+        m_meshBuffer->removeMesh(*handle);
+    }
 }
 
 void Renderer::resizeDisplay(GLuint width, GLuint height)
@@ -86,9 +118,18 @@ void Renderer::resizeDisplay(GLuint width, GLuint height)
     m_width = width;
     m_height = height;
 
+    m_directionalShadowRenderPass.onViewportResize(width, height);
+    m_depthPrePassRenderPass.onViewportResize(width, height);
     m_gbufferRenderPass.onViewportResize(width, height);
+    m_impostorRenderPass.onViewportResize(width, height);
+    m_lightCullingRenderPass.onViewportResize(width, height);
     m_lightingRenderPass.onViewportResize(width, height);
+    m_pointLightVolumeRenderPass.onViewportResize(width, height);
+    m_overdrawRenderPass.onViewportResize(width, height);
     m_skyboxRenderPass.onViewportResize(width, height);
+    m_hiZPyramid.resize(static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+
+    buildRenderGraph();
 }
 
 void Renderer::setDirectionalLight(const DirectionalLight& light)
@@ -103,26 +144,38 @@ void Renderer::addPointLight(const PointLight& light)
 
 void Renderer::queueDrawCommand(const DrawCommand& command)
 {
-    m_drawCommands.push_back(command);
+    // Whole meshes, which is what the CPU culled passes draw. The instance buffer splits them into meshlets
+    // for the GPU culled passes
+    // Meshes that did not fit are left out
+    const auto handle = m_meshBuffer->handleOfMesh(command.mesh);
+    if(!handle)
+    {
+        return;
+    }
+
+    auto& queued = m_drawCommands.emplace_back(command);
+    queued.gpuMesh = m_meshBuffer->gpuMesh(*handle);
 }
 
-void Renderer::render(const Camera& camera)
+void Renderer::queueImpostor(const Prefab& prefab, const glm::mat4& transform)
 {
-    m_directionalShadowRenderPass.execute(m_drawCommands, camera, m_directionalLight, m_pointLights, *m_meshBuffer);
-    m_pointLightShadowRenderPass.execute(m_drawCommands, camera, m_directionalLight, m_pointLights, *m_meshBuffer);
-    m_gbufferRenderPass.execute(m_drawCommands, camera, m_directionalLight, m_pointLights, *m_meshBuffer);
-    m_lightingRenderPass.execute(m_drawCommands, camera, m_directionalLight, m_pointLights, *m_meshBuffer);
-
-    if(camera.skybox)
-    {
-        m_skyboxRenderPass.execute(m_drawCommands, camera, m_directionalLight, m_pointLights, *m_meshBuffer);
-    }
+    m_impostorCommands.push_back({m_impostorAtlases.at(&prefab).get(), transform});
+}
 
-    present();
+void Renderer::render(const Camera& camera)
+{
+    m_camera = &camera;
+    m_renderGraph.execute();
+    m_camera = nullptr;
 }
 
 void Renderer::beginFrame()
 {
+    GlStateCache::instance().beginFrame();
+
+    // Before anything is queued, as moved meshes have new offsets
+    m_meshBuffer->compact(meshCompactionBudget);
+
     glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -130,14 +183,240 @@ void Renderer::beginFrame()
 void Renderer::endFrame()
 {
     m_drawCommands.clear();
+    m_impostorCommands.clear();
     m_pointLights.clear();
 }
 
-void Renderer::present() const
+std::string Renderer::renderGraphDump() const
+{
+    return m_renderGraph.dump();
+}
+
+ShadowScheduler& Renderer::pointLightShadowScheduler() const
+{
+    return m_pointLightShadowRenderPass.shadowScheduler();
+}
+
+void Renderer::setPointLightShading(PointLightShading shading)
+{
+    if(shading == m_pointLightShading)
+    {
+        return;
+    }
+
+    m_pointLightShading = shading;
+    buildRenderGraph();
+}
+
+void Renderer::setDepthPrePass(bool enabled)
+{
+    if(enabled == m_depthPrePass)
+    {
+        return;
+    }
+
+    m_depthPrePass = enabled;
+    buildRenderGraph();
+}
+
+void Renderer::setOverdrawVisualisation(bool enabled)
+{
+    if(enabled == m_overdrawVisualisation)
+    {
+        return;
+    }
+
+    m_overdrawVisualisation = enabled;
+    buildRenderGraph();
+}
+
+void Renderer::setGpuCulling(bool enabled)
+{
+    if(enabled == m_gpuCulling)
+    {
+        return;
+    }
+
+    m_gpuCulling = enabled;
+    buildRenderGraph();
+}
+
+void Renderer::setOcclusionCulling(bool enabled)
+{
+    if(enabled == m_occlusionCulling)
+    {
+        return;
+    }
+
+    m_occlusionCulling = enabled;
+    buildRenderGraph();
+}
+
+std::vector<RenderGraph::PassTiming> Renderer::passTimings() const
+{
+    return m_renderGraph.passTimings();
+}
+
+void Renderer::buildRenderGraph()
+{
+    m_renderGraph.reset();
+
+    m_renderGraph.importTexture("shadow.directional", m_directionalShadowRenderPass.directionalLightShadowMapImage());
+    m_renderGraph.importTexture("shadow.point", m_pointLightShadowRenderPass.pointLightShadowMapImage());
+    m_renderGraph.importTexture("backbuffer", nullptr);
+    m_renderGraph.importBuffer("lights.list", m_lightCullingRenderPass.lightBufferHandle());
+    m_renderGraph.importBuffer("lights.grid", m_lightCullingRenderPass.lightGridBufferHandle());
+    m_renderGraph.importBuffer("lights.indices", m_lightCullingRenderPass.lightIndexBufferHandle());
+    m_renderGraph.importBuffer("scene.instances", m_instanceBuffer.instanceBufferHandle());
+    m_renderGraph.importTexture("scene.hiz", m_hiZPyramid.texture());
+
+    auto options = FramePassOptions{};
+    options.width = static_cast<GLsizei>(m_width);
+    options.height = static_cast<GLsizei>(m_height);
+    options.lightVolumes = m_pointLightShading == PointLightShading::LightVolumes;
+    options.depthPrePass = m_depthPrePass;
+    options.countOverdraw = m_overdrawVisualisation;
+    options.gpuCulling = m_gpuCulling;
+    options.occlusionCulling = m_occlusionCulling;
+
+    const auto useLightVolumes = options.lightVolumes;
+    const auto useDepthPrePass = options.depthPrePass;
+    const auto countOverdraw = options.countOverdraw;
+    const auto useGpuCulling = options.gpuCulling;
+    auto* hiZPyramid = options.gpuCulling && options.occlusionCulling ? &m_hiZPyramid : nullptr;
+
+    auto executes = std::unordered_map<std::string, RenderGraph::ExecuteFunction>{};
+
+    executes["Instances"] = [this, useGpuCulling](const RenderGraph&)
+    {
+        m_instanceBuffer.upload(m_drawCommands, useGpuCulling);
+    };
+
+    executes["DirectionalShadow"] = [this, useGpuCulling](const RenderGraph&)
+    {
+        m_directionalShadowRenderPass.setInputs({&m_instanceBuffer, useGpuCulling});
+        m_directionalShadowRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["PointLightShadow"] = [this](const RenderGraph&)
+    {
+        m_pointLightShadowRenderPass.setInputs({&m_instanceBuffer});
+        m_pointLightShadowRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["DepthPrePass"] = [this, useGpuCulling, hiZPyramid](const RenderGraph& graph)
+    {
+        m_depthPrePassRenderPass.setInputs({&m_instanceBuffer, useGpuCulling, hiZPyramid});
+        m_depthPrePassRenderPass.setOutputs({graph.texture<Texture2D>("gbuffer.depth")});
+        m_depthPrePassRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["GBuffer"] = [this, useDepthPrePass, countOverdraw, useGpuCulling, hiZPyramid](const RenderGraph& graph)
+    {
+        auto outputs = GBufferRenderPass::Outputs{};
+        outputs.colorImage = graph.texture<Texture2D>("gbuffer.color");
+        outputs.normalImage = graph.texture<Texture2D>("gbuffer.normal");
+        outputs.depthImage = graph.texture<Texture2D>("gbuffer.depth");
+        outputs.overdrawImage = countOverdraw ? graph.texture<Texture2D>("gbuffer.overdraw") : nullptr;
+
+        m_gbufferRenderPass.setInputs({useDepthPrePass, &m_instanceBuffer, useGpuCulling, hiZPyramid});
+        m_gbufferRenderPass.setOutputs(outputs);
+        m_gbufferRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["Impostors"] = [this](const RenderGraph& graph)
+    {
+        auto outputs = ImpostorRenderPass::Outputs{};
+        outputs.colorImage = graph.texture<Texture2D>("gbuffer.color");
+        outputs.normalImage = graph.texture<Texture2D>("gbuffer.normal");
+        outputs.depthImage = graph.texture<Texture2D>("gbuffer.depth");
+
+        m_impostorRenderPass.setInputs({&m_impostorCommands});
+        m_impostorRenderPass.setOutputs(outputs);
+        m_impostorRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["HiZ"] = [this](const RenderGraph& graph)
+    {
+        m_hiZPyramid.build(*graph.texture<Texture2D>("gbuffer.depth"), m_gbufferRenderPass.viewProjection());
+    };
+
+    executes["LightCulling"] = [this, useLightVolumes](const RenderGraph&)
+    {
+        m_lightCullingRenderPass.setInputs({&m_pointLightShadowRenderPass.lightShadowIndices(), !useLightVolumes});
+        m_lightCullingRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["Lighting"] = [this, useLightVolumes](const RenderGraph& graph)
+    {
+        auto inputs = LightingRenderPass::Inputs{};
+        inputs.colorImage = graph.texture<Texture2D>("gbuffer.color");
+        inputs.normalImage = graph.texture<Texture2D>("gbuffer.normal");
+        inputs.depthImage = graph.texture<Texture2D>("gbuffer.depth");
+        inputs.directionalLightShadowMapImage = graph.texture<Texture2DArray>("shadow.directional");
+        inputs.directionalShadowCascades = &m_directionalShadowRenderPass.cascades();
+        inputs.pointLightShadowMapImage = graph.texture<TextureCubeMapArray>("shadow.point");
+        inputs.clusterParameters = &m_lightCullingRenderPass.clusterParameters();
+        inputs.lightBuffer = graph.buffer("lights.list");
+        inputs.lightGridBuffer = graph.buffer("lights.grid");
+        inputs.lightIndexBuffer = graph.buffer("lights.indices");
+        inputs.shadePointLights = !useLightVolumes;
+
+        m_lightingRenderPass.setInputs(inputs);
+        m_lightingRenderPass.setOutputs({graph.texture<Texture2D>("scene.color")});
+        m_lightingRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["PointLightVolumes"] = [this](const RenderGraph& graph)
+    {
+        auto inputs = PointLightVolumeRenderPass::Inputs{};
+        inputs.colorImage = graph.texture<Texture2D>("gbuffer.color");
+        inputs.normalImage = graph.texture<Texture2D>("gbuffer.normal");
+        inputs.depthImage = graph.texture<Texture2D>("gbuffer.depth");
+        inputs.pointLightShadowMapImage = graph.texture<TextureCubeMapArray>("shadow.point");
+        inputs.lightBuffer = graph.buffer("lights.list");
+        inputs.lightCount = m_lightCullingRenderPass.clusterParameters().lightCount;
+
+        auto outputs = PointLightVolumeRenderPass::Outputs{};
+        outputs.colorImage = graph.texture<Texture2D>("scene.color");
+        outputs.depthStencilImage = graph.texture<Texture2D>("gbuffer.depth");
+
+        m_pointLightVolumeRenderPass.setInputs(inputs);
+        m_pointLightVolumeRenderPass.setOutputs(outputs);
+        m_pointLightVolumeRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["Skybox"] = [this](const RenderGraph& graph)
+    {
+        m_skyboxRenderPass.setInputs({graph.texture<Texture2D>("scene.color")});
+        m_skyboxRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["Overdraw"] = [this](const RenderGraph& graph)
+    {
+        m_overdrawRenderPass.setInputs({graph.texture<Texture2D>("gbuffer.overdraw")});
+        m_overdrawRenderPass.setOutputs({graph.texture<Texture2D>("scene.color")});
+        m_overdrawRenderPass.execute(m_drawCommands, *m_camera, m_directionalLight, m_pointLights, *m_meshBuffer);
+    };
+
+    executes["Present"] = [this](const RenderGraph& graph)
+    {
+        present(graph.texture<Texture2D>("scene.color"));
+    };
+
+    addFramePasses(m_renderGraph, options, executes);
+
+    m_renderGraph.compile();
+}
+
+void Renderer::present(Texture2D* image) const
 {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_lightingRenderPass.framebufferHandle());
+    m_presentFramebuffer.attachTexture(GL_COLOR_ATTACHMENT0, *image, 0);
+    m_presentFramebuffer.setReadBuffer(GL_COLOR_ATTACHMENT0);
 
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    auto& glState = GlStateCache::instance();
+    glState.bindFramebuffer(GL_READ_FRAMEBUFFER, m_presentFramebuffer.handle());
+    glState.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
     glBlitFramebuffer(
         0,
@@ -151,6 +430,5 @@ void Renderer::present() const
         GL_COLOR_BUFFER_BIT,
         GL_NEAREST);
 
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glState.bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -7,21 +7,44 @@
 #include "data/PointLight.h"
 #include "rendering/Buffer.h"
 #include "rendering/DrawCommand.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/HiZPyramid.h"
+#include "rendering/ImpostorBaker.h"
+#include "rendering/InstanceBuffer.h"
+#include "rendering/MeshBuffer.h"
+#include "rendering/RenderGraph.h"
+#include "rendering/renderpasses/DepthPrePassRenderPass.h"
 #include "rendering/renderpasses/DirectionalShadowRenderPass.h"
 #include "rendering/renderpasses/GBufferRenderPass.h"
+#include "rendering/renderpasses/ImpostorRenderPass.h"
+#include "rendering/renderpasses/LightCullingRenderPass.h"
 #include "rendering/renderpasses/LightingRenderPass.h"
+#include "rendering/renderpasses/OverdrawRenderPass.h"
 #include "rendering/renderpasses/PointLightShadowRenderPass.h"
+#include "rendering/renderpasses/PointLightVolumeRenderPass.h"
 #include "rendering/renderpasses/SkyboxRenderPass.h"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class AssetDatabase;
-class MeshBuffer;
+class Prefab;
+class ShadowScheduler;
+class Texture2D;
 
 struct Camera;
 struct SceneData;
 
+enum class PointLightShading
+{
+    // A full-screen pass loops over the lights culled into each pixel's cluster
+    Clustered,
+    // Each light is drawn as a stencil-masked sphere blended over the lit scene
+    LightVolumes
+};
+
 class Renderer
 {
     public:
@@ -34,34 +57,123 @@ class Renderer
         Renderer& operator=(const Renderer& other) = delete;
         Renderer& operator=(Renderer&& other) = delete;   
 
-        void setAssets(const AssetDatabase& assetDb);
+        void setAssets(const AssetDatabase& assetDb, VertexFormat vertexFormat);
+
+        // Streams a prefab's meshes in or out of the mesh buffer, uploading only that prefab's data.
+        // Prefabs with impostors enabled also have their atlas baked here
+        void addPrefab(const Prefab& prefab);
+        void removePrefab(const Prefab& prefab);
+
+        bool hasImpostor(const Prefab& prefab) const;
+
+        // Streams a single mesh, for geometry that belongs to no prefab. It must stay alive until removed.
+        // Returns false if the mesh buffer is full, and the mesh is not drawn
+        bool addMesh(Mesh* mesh);
+        void removeMesh(Mesh* mesh);
 
         void resizeDisplay(GLuint width, GLuint height);
 
         void setDirectionalLight(const DirectionalLight& light);
         void addPointLight(const PointLight& light);
         void queueDrawCommand(const DrawCommand& command);
+        // Draws an instance of the prefab as a single quad from its atlas, which it must have
+        void queueImpostor(const Prefab& prefab, const glm::mat4& transform);
 
         void render(const Camera& camera);
 
         void beginFrame();
         void endFrame();
 
+        std::string renderGraphDump() const;
+
+        ShadowScheduler& pointLightShadowScheduler() const;
+
+        void setPointLightShading(PointLightShading shading);
+
+        inline PointLightShading pointLightShading() const
+        {
+            return m_pointLightShading;
+        }
+
+        void setDepthPrePass(bool enabled);
+
+        inline bool depthPrePass() const
+        {
+            return m_depthPrePass;
+        }
+
+        // Shows how many G-buffer fragments are shaded per pixel instead of the lit scene
+        void setOverdrawVisualisation(bool enabled);
+
+        inline bool overdrawVisualisation() const
+        {
+            return m_overdrawVisualisation;
+        }
+
+        // Frustum culls the mesh passes in compute shaders and draws them with indirect multi-draws
+        void setGpuCulling(bool enabled);
+
+        inline bool gpuCulling() const
+        {
+            return m_gpuCulling;
+        }
+
+        // Also skips draws hidden behind the previous frame's depth. Needs GPU culling
+        void setOcclusionCulling(bool enabled);
+
+        inline bool occlusionCulling() const
+        {
+            return m_occlusionCulling;
+        }
+
+        // Width over height of the display, which the camera passes project with
+        inline float aspectRatio() const
+        {
+            return m_height == 0 ? 1.0f : static_cast<float>(m_width) / static_cast<float>(m_height);
+        }
+
+        std::vector<RenderGraph::PassTiming> passTimings() const;
+
+        // Commands queued so far this frame
+        inline const std::vector<DrawCommand>& drawCommands() const
+        {
+            return m_drawCommands;
+        }
+
     private:
-        void rebuildBuffers();
-        void present() const;
+        void buildRenderGraph();
+        void present(Texture2D* image) const;
 
     private:
         SkyboxRenderPass m_skyboxRenderPass;
         DirectionalShadowRenderPass m_directionalShadowRenderPass;
         PointLightShadowRenderPass m_pointLightShadowRenderPass;
+        DepthPrePassRenderPass m_depthPrePassRenderPass;
         GBufferRenderPass m_gbufferRenderPass;
+        ImpostorRenderPass m_impostorRenderPass;
+        LightCullingRenderPass m_lightCullingRenderPass;
         LightingRenderPass m_lightingRenderPass;
-        
+        PointLightVolumeRenderPass m_pointLightVolumeRenderPass;
+        OverdrawRenderPass m_overdrawRenderPass;
+        Framebuffer m_presentFramebuffer;
+        InstanceBuffer m_instanceBuffer;
+        HiZPyramid m_hiZPyramid;
+        ImpostorBaker m_impostorBaker;
+
+        RenderGraph m_renderGraph;
+
         std::unique_ptr<MeshBuffer> m_meshBuffer{nullptr};
         DirectionalLight m_directionalLight;
         std::vector<PointLight> m_pointLights;
         std::vector<DrawCommand> m_drawCommands;
+        std::unordered_map<const Prefab*, std::unique_ptr<ImpostorAtlas>> m_impostorAtlases;
+        std::vector<ImpostorDrawCommand> m_impostorCommands;
+        const Camera* m_camera{nullptr};
+        PointLightShading m_pointLightShading{PointLightShading::Clustered};
+        bool m_depthPrePass{false};
+        bool m_overdrawVisualisation{false};
+        bool m_gpuCulling{false};
+        bool m_occlusionCulling{false};
 
         GLuint m_width{0};
         GLuint m_height{0};
@@ -4,6 +4,7 @@
 #include "Shader.h"
 
 #include "data/Texture.h"
+#include "rendering/GlStateCache.h"
 
 #include <fstream>
 #include <stdexcept>
@@ -22,10 +23,33 @@ std::string readFile(const std::filesystem::path& path)
     return buffer.str();
 }
 
-unsigned int loadShader(const std::filesystem::path& path, unsigned int type)
+std::string injectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+    if (defines.empty())
+    {
+        return source;
+    }
+
+    // GLSL requires #version to come first, so the defines go straight after it
+    const auto versionEnd = source.find('\n') + 1;
+
+    auto injected = source.substr(0, versionEnd);
+    for (const auto& define : defines)
+    {
+        injected += "#define " + define + "\n";
+    }
+
+    // Keep the line numbers in compile errors matching the file
+    injected += "#line 2\n";
+    injected += source.substr(versionEnd);
+
+    return injected;
+}
+
+unsigned int loadShader(const std::filesystem::path& path, unsigned int type, const std::vector<std::string>& defines = {})
 {
     const auto id = glCreateShader(type);
-    const auto source = readFile(path);
+    const auto source = injectDefines(readFile(path), defines);
     const auto rawSource = source.c_str();
     glShaderSource(id, 1, &rawSource, nullptr);
     glCompileShader(id);
@@ -46,11 +70,68 @@ Shader::Shader(const std::filesystem::path& vsPath, const std::filesystem::path&
 {
     m_programHandle = glCreateProgram();
 
-    m_vsHandle = loadShader(vsPath, GL_VERTEX_SHADER);
-    glAttachShader(m_programHandle, m_vsHandle);
+    m_stageHandles.push_back(loadShader(vsPath, GL_VERTEX_SHADER));
+    m_stageHandles.push_back(loadShader(fsPath, GL_FRAGMENT_SHADER));
+
+    link();
+}
+
+Shader::Shader(const std::filesystem::path& vsPath,
+               const std::filesystem::path& fsPath,
+               const std::vector<std::string>& defines)
+{
+    m_programHandle = glCreateProgram();
 
-    m_fsHandle = loadShader(fsPath, GL_FRAGMENT_SHADER);
-    glAttachShader(m_programHandle, m_fsHandle);
+    m_stageHandles.push_back(loadShader(vsPath, GL_VERTEX_SHADER, defines));
+    m_stageHandles.push_back(loadShader(fsPath, GL_FRAGMENT_SHADER, defines));
+
+    link();
+}
+
+Shader::Shader(const std::filesystem::path& vsPath, const std::filesystem::path& gsPath, const std::filesystem::path& fsPath)
+{
+    m_programHandle = glCreateProgram();
+
+    m_stageHandles.push_back(loadShader(vsPath, GL_VERTEX_SHADER));
+    m_stageHandles.push_back(loadShader(gsPath, GL_GEOMETRY_SHADER));
+    m_stageHandles.push_back(loadShader(fsPath, GL_FRAGMENT_SHADER));
+
+    link();
+}
+
+Shader::Shader(const std::filesystem::path& csPath)
+{
+    m_programHandle = glCreateProgram();
+
+    m_stageHandles.push_back(loadShader(csPath, GL_COMPUTE_SHADER));
+
+    link();
+}
+
+Shader::~Shader()
+{
+    for (const auto stageHandle : m_stageHandles)
+    {
+        glDetachShader(m_programHandle, stageHandle);
+        glDeleteShader(stageHandle);
+    }
+
+    glDeleteProgram(m_programHandle);
+    GlStateCache::instance().onProgramDeleted(m_programHandle);
+
+    for (const auto& [slot, ubo] : m_uniformSlots)
+    {
+        glDeleteBuffers(1, &ubo);
+        GlStateCache::instance().onBufferDeleted(ubo);
+    }
+}
+
+void Shader::link()
+{
+    for (const auto stageHandle : m_stageHandles)
+    {
+        glAttachShader(m_programHandle, stageHandle);
+    }
 
     glLinkProgram(m_programHandle);
 
@@ -65,59 +146,62 @@ Shader::Shader(const std::filesystem::path& vsPath, const std::filesystem::path&
     }
 }
 
-Shader::~Shader()
-{
-    glDetachShader(m_programHandle, m_vsHandle);
-    glDeleteShader(m_vsHandle);
-
-    glDetachShader(m_programHandle, m_fsHandle);
-    glDeleteShader(m_fsHandle);
-
-    glDeleteProgram(m_programHandle);
-}
-
-void Shader::registerUniformBuffer(const std::string& name, GLsizeiptr size, GLuint index)
+UniformBufferSlot Shader::registerUniformBuffer(const std::string& name, GLsizeiptr size, GLuint index)
 {
     auto ubo = GLuint{0};
     glCreateBuffers(1, &ubo);
     glNamedBufferData(ubo, size, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, index, ubo);
+    GlStateCache::instance().bindBufferBase(GL_UNIFORM_BUFFER, index, ubo);
 
     const auto blockIndex = glGetUniformBlockIndex(m_programHandle, name.c_str());
     glUniformBlockBinding(m_programHandle, blockIndex, index);
 
-    m_uniformBuffers[name] = ubo;
     m_uniformSlots[index] = ubo;
+
+    return UniformBufferSlot{ubo};
+}
+
+TextureSlot Shader::registerTextureSampler(const std::string& name, GLuint index)
+{
+    return TextureSlot{index};
+}
+
+StorageBufferSlot Shader::registerStorageBuffer(const std::string& name, GLuint index)
+{
+    const auto blockIndex = glGetProgramResourceIndex(m_programHandle, GL_SHADER_STORAGE_BLOCK, name.c_str());
+    glShaderStorageBlockBinding(m_programHandle, blockIndex, index);
+
+    return StorageBufferSlot{index};
 }
 
-void Shader::registerTextureSampler(const std::string& name, GLuint index)
+void Shader::writeUniformData(UniformBufferSlot slot, GLsizeiptr size, const void* data) const
 {
-    m_textureSamplers[name] = index;
+    glNamedBufferSubData(slot.buffer, 0, size, data);
 }
 
-void Shader::writeUniformData(const std::string& name, GLsizeiptr size, const void* data)
+void Shader::bindTexture(TextureSlot slot, Texture* texture) const
 {
-    const auto ubo = m_uniformBuffers.at(name);
-    glNamedBufferSubData(ubo, 0, size, data);
+    GlStateCache::instance().bindTextureUnit(slot.unit, texture->handle());
 }
 
-void Shader::bindTexture(const std::string& name, Texture* texture)
+void Shader::bindStorageBuffer(StorageBufferSlot slot, GLuint bufferHandle) const
 {
-    const auto slot = m_textureSamplers.at(name);
-    glBindTextureUnit(slot, texture->handle());
+    GlStateCache::instance().bindBufferBase(GL_SHADER_STORAGE_BUFFER, slot.binding, bufferHandle);
 }
 
 void Shader::bind() const
 {
-    glUseProgram(m_programHandle);
+    auto& glState = GlStateCache::instance();
+    glState.useProgram(m_programHandle);
 
+    // Slots can be shared with other shaders, the cache drops the ones that are already bound
     for (const auto& [slot, ubo] : m_uniformSlots)
     {
-        glBindBufferBase(GL_UNIFORM_BUFFER, slot, ubo);
+        glState.bindBufferBase(GL_UNIFORM_BUFFER, slot, ubo);
     }
 }
 
 void Shader::unbind() const
 {
-    glUseProgram(0);
+    GlStateCache::instance().useProgram(0);
 }
@@ -8,13 +8,36 @@
 #include <filesystem>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class Texture;
 
+// Handles returned on registration, so per-draw updates skip the name lookup
+struct UniformBufferSlot
+{
+    GLuint buffer{0};
+};
+
+struct TextureSlot
+{
+    GLuint unit{0};
+};
+
+struct StorageBufferSlot
+{
+    GLuint binding{0};
+};
+
 class Shader
 {
     public:
         Shader(const std::filesystem::path& vsPath, const std::filesystem::path& fsPath);
+        // Compiles a variant of the shader, with each define inserted after the #version line of both stages
+        Shader(const std::filesystem::path& vsPath,
+               const std::filesystem::path& fsPath,
+               const std::vector<std::string>& defines);
+        Shader(const std::filesystem::path& vsPath, const std::filesystem::path& gsPath, const std::filesystem::path& fsPath);
+        explicit Shader(const std::filesystem::path& csPath);
         ~Shader();
 
         Shader(const Shader& other) = delete;
@@ -23,19 +46,24 @@ class Shader
         Shader& operator=(const Shader& other) = delete;
         Shader& operator=(Shader&& other) = delete;
 
-        void registerUniformBuffer(const std::string& name, GLsizeiptr size, GLuint index);
-        void registerTextureSampler(const std::string& name, GLuint index);
-        void writeUniformData(const std::string& name, GLsizeiptr size, const void* data);
-        void bindTexture(const std::string& name, Texture* texture);
+        UniformBufferSlot registerUniformBuffer(const std::string& name, GLsizeiptr size, GLuint index);
+        // Samplers take their unit from the binding in the shader source, the name only labels the call
+        TextureSlot registerTextureSampler(const std::string& name, GLuint index);
+        StorageBufferSlot registerStorageBuffer(const std::string& name, GLuint index);
+
+        void writeUniformData(UniformBufferSlot slot, GLsizeiptr size, const void* data) const;
+        void bindTexture(TextureSlot slot, Texture* texture) const;
+        void bindStorageBuffer(StorageBufferSlot slot, GLuint bufferHandle) const;
 
         void bind() const;
         void unbind() const;
 
+    private:
+        void link();
+
     private:
         GLuint m_programHandle{0};
-        GLuint m_vsHandle{0};
-        GLuint m_fsHandle{0};
-        std::unordered_map<std::string, GLuint> m_uniformBuffers;
+        std::vector<GLuint> m_stageHandles;
+        // Binding index to the buffer this shader created for it
         std::unordered_map<GLuint, GLuint> m_uniformSlots;
-        std::unordered_map<std::string, GLuint> m_textureSamplers;
 };
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "ShadowScheduler.h"
+
+#include <algorithm>
+#include <bit>
+
+constexpr auto allFacesMask = uint32_t{0x3f};
+
+// Lights covering more than this much of the view have all their faces updated together,
+// since a cube with faces from different frames would show visible seams up close
+constexpr auto wholeCubeScreenSize = 0.25f;
+
+ShadowScheduler::ShadowScheduler(int shadowCount, uint32_t faceBudget)
+    : m_cubes(shadowCount)
+    , m_faceBudget{faceBudget}
+{
+    for(auto& cube : m_cubes)
+    {
+        cube.staleFaces = allFacesMask;
+    }
+}
+
+void ShadowScheduler::invalidate(int shadowIndex)
+{
+    m_cubes.at(shadowIndex).staleFaces = allFacesMask;
+}
+
+const std::vector<ShadowScheduler::Decision>& ShadowScheduler::schedule(const std::vector<Request>& requests)
+{
+    m_decisions.clear();
+    m_stats = FrameStats{};
+    m_stats.budget = m_faceBudget;
+
+    auto candidates = std::vector<Decision>{};
+    for(const auto& request : requests)
+    {
+        auto& cube = m_cubes.at(request.shadowIndex);
+        if(cube.staleFaces == 0)
+        {
+            continue;
+        }
+
+        cube.framesStale++;
+
+        auto candidate = Decision{};
+        candidate.shadowIndex = request.shadowIndex;
+        candidate.faceMask = cube.staleFaces;
+        candidate.screenSize = request.screenSize;
+        candidate.priority = request.screenSize * static_cast<float>(cube.framesStale);
+        candidate.framesStale = cube.framesStale;
+        candidates.push_back(candidate);
+    }
+
+    m_stats.staleLights = static_cast<uint32_t>(candidates.size());
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Decision& a, const Decision& b) {
+        return a.priority > b.priority;
+    });
+
+    auto remainingFaces = m_faceBudget;
+    for(auto& candidate : candidates)
+    {
+        const auto staleFaceCount = static_cast<uint32_t>(std::popcount(candidate.faceMask));
+
+        auto faceMask = uint32_t{0};
+        if(candidate.screenSize >= wholeCubeScreenSize)
+        {
+            // The first light is always scheduled, so a budget smaller than a cube cannot starve it
+            if(staleFaceCount <= remainingFaces || m_decisions.empty())
+            {
+                faceMask = candidate.faceMask;
+            }
+        }
+        else
+        {
+            // Distant lights take whatever is left, lowest faces first, and finish on later frames
+            for(auto face = 0; face < 6 && std::popcount(faceMask) < static_cast<int>(remainingFaces); ++face)
+            {
+                faceMask |= candidate.faceMask & (1u << face);
+            }
+        }
+
+        const auto scheduledFaceCount = static_cast<uint32_t>(std::popcount(faceMask));
+        m_stats.deferredFaces += staleFaceCount - scheduledFaceCount;
+
+        if(faceMask == 0)
+        {
+            continue;
+        }
+
+        auto& cube = m_cubes[candidate.shadowIndex];
+        cube.staleFaces &= ~faceMask;
+        if(cube.staleFaces == 0)
+        {
+            cube.framesStale = 0;
+        }
+
+        remainingFaces -= std::min(remainingFaces, scheduledFaceCount);
+
+        candidate.faceMask = faceMask;
+        m_decisions.push_back(candidate);
+
+        m_stats.scheduledLights++;
+        m_stats.scheduledFaces += scheduledFaceCount;
+    }
+
+    return m_decisions;
+}
+
+void ShadowScheduler::setFaceBudget(uint32_t faceBudget)
+{
+    m_faceBudget = faceBudget;
+}
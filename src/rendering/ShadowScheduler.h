@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Decides which shadow cube faces are re-rendered each frame, within a fixed budget of faces.
+// Stale cubes are ranked by their screen-space influence weighted by how long they have been waiting,
+// so large on-screen lights update first and distant lights still catch up over the following frames
+class ShadowScheduler
+{
+    public:
+        struct Request
+        {
+            int shadowIndex{-1};
+            float screenSize{0.0f};
+        };
+
+        struct Decision
+        {
+            int shadowIndex{-1};
+            uint32_t faceMask{0};
+            float screenSize{0.0f};
+            float priority{0.0f};
+            uint32_t framesStale{0};
+        };
+
+        struct FrameStats
+        {
+            uint32_t budget{0};
+            uint32_t staleLights{0};
+            uint32_t scheduledLights{0};
+            uint32_t scheduledFaces{0};
+            uint32_t deferredFaces{0};
+        };
+
+        ShadowScheduler(int shadowCount, uint32_t faceBudget);
+
+        ShadowScheduler(const ShadowScheduler& other) = delete;
+        ShadowScheduler(ShadowScheduler&& other) = delete;
+
+        ShadowScheduler& operator=(const ShadowScheduler& other) = delete;
+        ShadowScheduler& operator=(ShadowScheduler&& other) = delete;
+
+        // Marks every face of a cube as out of date
+        void invalidate(int shadowIndex);
+
+        // Picks this frame's faces from the cubes requested by visible lights
+        const std::vector<Decision>& schedule(const std::vector<Request>& requests);
+
+        void setFaceBudget(uint32_t faceBudget);
+
+        inline uint32_t faceBudget() const
+        {
+            return m_faceBudget;
+        }
+
+        inline const std::vector<Decision>& decisions() const
+        {
+            return m_decisions;
+        }
+
+        inline const FrameStats& stats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        struct CubeState
+        {
+            uint32_t staleFaces{0};
+            uint32_t framesStale{0};
+        };
+
+    private:
+        std::vector<CubeState> m_cubes;
+        std::vector<Decision> m_decisions;
+        FrameStats m_stats{};
+        uint32_t m_faceBudget{0};
+};
@@ -3,6 +3,8 @@
 
 #include "VertexLayout.h"
 
+#include "rendering/GlStateCache.h"
+
 VertexLayout::VertexLayout()
 {
     glCreateVertexArrays(1, &m_handle);
@@ -11,12 +13,29 @@ VertexLayout::VertexLayout()
 VertexLayout::~VertexLayout()
 {
     glDeleteVertexArrays(1, &m_handle);
+    GlStateCache::instance().onVertexArrayDeleted(m_handle);
 }
 
-void VertexLayout::registerAttribute(GLuint index, GLint size, GLenum type, GLuint offset) const
+void VertexLayout::registerAttribute(GLuint index,
+                                     GLint size,
+                                     GLenum type,
+                                     GLuint offset,
+                                     GLuint bindingIndex,
+                                     AttributeFormat format) const
 {
-    glVertexArrayAttribFormat(m_handle, index, size, type, GL_FALSE, offset);
-    glVertexArrayAttribBinding(m_handle, index, 0);
+    switch (format)
+    {
+        case AttributeFormat::Float:
+            glVertexArrayAttribFormat(m_handle, index, size, type, GL_FALSE, offset);
+            break;
+        case AttributeFormat::Normalised:
+            glVertexArrayAttribFormat(m_handle, index, size, type, GL_TRUE, offset);
+            break;
+        case AttributeFormat::Integer:
+            glVertexArrayAttribIFormat(m_handle, index, size, type, offset);
+            break;
+    }
+    glVertexArrayAttribBinding(m_handle, index, bindingIndex);
     glEnableVertexArrayAttrib(m_handle, index);
 }
 
@@ -25,6 +44,11 @@ void VertexLayout::bindVertexBuffer(GLuint index, GLuint bufferHandle, GLintptr
     glVertexArrayVertexBuffer(m_handle, index, bufferHandle, offset, stride);
 }
 
+void VertexLayout::setBindingDivisor(GLuint index, GLuint divisor) const
+{
+    glVertexArrayBindingDivisor(m_handle, index, divisor);
+}
+
 void VertexLayout::bindElementBuffer(GLuint bufferHandle) const
 {
     glVertexArrayElementBuffer(m_handle, bufferHandle);
@@ -32,10 +56,10 @@ void VertexLayout::bindElementBuffer(GLuint bufferHandle) const
 
 void VertexLayout::bind() const
 {
-    glBindVertexArray(m_handle);
+    GlStateCache::instance().bindVertexArray(m_handle);
 }
 
 void VertexLayout::unbind() const
 {
-    glBindVertexArray(0);
+    GlStateCache::instance().bindVertexArray(0);
 }
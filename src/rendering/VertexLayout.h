@@ -5,6 +5,17 @@
 
 #include <glad/gl.h>
 
+// How the shader sees an attribute's stored values
+enum class AttributeFormat
+{
+    // Converted to float as is
+    Float,
+    // Integers mapped to [0, 1], or [-1, 1] for signed types
+    Normalised,
+    // Kept as integers, for int and uint shader inputs
+    Integer
+};
+
 class VertexLayout
 {
 public:
@@ -17,8 +28,17 @@ public:
         VertexLayout& operator=(const VertexLayout& other) = delete;
         VertexLayout& operator=(VertexLayout&& other) = delete;
 
-        void registerAttribute(GLuint index, GLint size, GLenum type, GLuint offset) const;
+        // Attributes read from the buffer bound at bindingIndex, so several streams can feed one layout
+        void registerAttribute(GLuint index,
+                               GLint size,
+                               GLenum type,
+                               GLuint offset,
+                               GLuint bindingIndex = 0,
+                               AttributeFormat format = AttributeFormat::Float) const;
         void bindVertexBuffer(GLuint index, GLuint bufferHandle, GLintptr offset, GLsizei stride) const;
+
+        // Advances the binding once per this many instances rather than once per vertex
+        void setBindingDivisor(GLuint index, GLuint divisor) const;
         void bindElementBuffer(GLuint bufferHandle) const;
 
         void bind() const;
@@ -0,0 +1,167 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "DepthPrePassRenderPass.h"
+
+#include "core/FileSystem.h"
+#include "data/Mesh.h"
+#include "data/Texture.h"
+#include "rendering/Camera.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/GpuCuller.h"
+#include "rendering/HiZPyramid.h"
+#include "rendering/InstanceBuffer.h"
+#include "rendering/LightTransform.h"
+#include "rendering/MeshBuffer.h"
+#include "rendering/Shader.h"
+#include "rendering/VertexLayout.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+struct alignas(16) TransformUbo
+{
+        glm::mat4 projection;
+        glm::mat4 view;
+};
+
+DepthPrePassRenderPass::DepthPrePassRenderPass()
+    : RenderPass()
+{
+    const auto shaderDir = GetShaderDir();
+    const auto vsPath = shaderDir / "depth_prepass_vertex.glsl";
+    const auto fsPath = shaderDir / "depth_prepass_fragment.glsl";
+
+    m_shader = std::make_unique<Shader>(vsPath, fsPath);
+    m_transformBlock = m_shader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
+    m_instanceSlot = m_shader->registerStorageBuffer("InstanceBuffer", 3);
+
+    m_framebuffer = std::make_unique<Framebuffer>();
+    m_framebuffer->setDrawBuffer(GL_NONE);
+    m_framebuffer->setReadBuffer(GL_NONE);
+
+    m_vertexLayout = std::make_unique<VertexLayout>();
+
+    m_culler = std::make_unique<GpuCuller>(true);
+}
+
+DepthPrePassRenderPass::~DepthPrePassRenderPass() = default;
+
+void DepthPrePassRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
+                                     const Camera& camera,
+                                     const DirectionalLight& directionalLight,
+                                     const std::vector<PointLight>& pointLights,
+                                     const MeshBuffer& buffer)
+{
+    const auto& instances = *m_inputs.instances;
+
+    auto transformUbo = TransformUbo{};
+    transformUbo.projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
+    transformUbo.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+
+    const auto viewProjection = transformUbo.projection * transformUbo.view;
+    const auto frustum = getFrustumPlanes(viewProjection);
+    m_culler->setViewerPosition(camera.position);
+
+    auto* pyramid = m_inputs.gpuCulling ? m_inputs.hiZPyramid : nullptr;
+    const auto testOcclusion = pyramid && pyramid->valid();
+
+    if (testOcclusion)
+    {
+        m_culler->cull(instances, {frustum}, {pyramid, pyramid->viewProjection(), GpuCuller::OcclusionTest::Test});
+    }
+    else if (m_inputs.gpuCulling)
+    {
+        m_culler->cull(instances, {frustum});
+    }
+
+    m_shader->bind();
+    m_framebuffer->bind();
+
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    m_vertexLayout->bind();
+    buffer.bindPositionsToVertexLayout(*m_vertexLayout);
+    instances.bindToVertexLayout(*m_vertexLayout);
+
+    m_shader->writeUniformData(m_transformBlock, sizeof(TransformUbo), &transformUbo);
+    m_shader->bindStorageBuffer(m_instanceSlot, instances.instanceBufferHandle());
+
+    if (m_inputs.gpuCulling)
+    {
+        drawCulledBuckets();
+
+        if (testOcclusion)
+        {
+            // The G-buffer tests against this pyramid too, so it needs no retest of its own
+            pyramid->build(*m_depthImage, viewProjection);
+            m_culler->cull(instances, {frustum}, {pyramid, viewProjection, GpuCuller::OcclusionTest::Retest});
+
+            m_shader->bind();
+            drawCulledBuckets();
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < drawQueue.size(); ++i)
+    {
+        if (!drawQueue[i].mesh->material || drawQueue[i].hiddenFromCamera)
+        {
+            continue;
+        }
+
+        const auto& gpuMesh = drawQueue[i].gpuMesh;
+
+        glDrawElementsInstancedBaseVertexBaseInstance(
+            GL_TRIANGLES,
+            gpuMesh.indexCount,
+            gpuMesh.indexType,
+            gpuMesh.indexPointer(),
+            1,
+            gpuMesh.baseVertex,
+            static_cast<GLuint>(i));
+    }
+}
+
+void DepthPrePassRenderPass::drawCulledBuckets() const
+{
+    const auto& instances = *m_inputs.instances;
+    m_culler->bindIndirectBuffer();
+
+    const auto& buckets = instances.buckets();
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        // Meshes the G-buffer skips must not occlude anything either
+        if (buckets[i].material)
+        {
+            m_culler->drawBucket(instances, i);
+        }
+    }
+}
+
+void DepthPrePassRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+}
+
+void DepthPrePassRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+void DepthPrePassRenderPass::setOutputs(const Outputs& outputs)
+{
+    m_framebuffer->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, *outputs.depthImage, 0);
+    m_depthImage = outputs.depthImage;
+}
@@ -0,0 +1,71 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <memory>
+
+#include <glad/gl.h>
+
+class Framebuffer;
+class GpuCuller;
+class HiZPyramid;
+class InstanceBuffer;
+class MeshBuffer;
+class Texture2D;
+class VertexLayout;
+
+// Lays down the scene depth with positions only, so the G-buffer pass can test with GL_EQUAL
+// and shade each pixel exactly once, however much the geometry overlaps
+class DepthPrePassRenderPass : public RenderPass
+{
+    public:
+        struct Inputs
+        {
+            const InstanceBuffer* instances{nullptr};
+            bool gpuCulling{false};
+            // Skips instances hidden in last frame's pyramid, then rebuilds it from this frame's depth
+            // and draws any of them it no longer hides. Only with GPU culling
+            HiZPyramid* hiZPyramid{nullptr};
+        };
+
+        struct Outputs
+        {
+            Texture2D* depthImage;
+        };
+
+        DepthPrePassRenderPass();
+        ~DepthPrePassRenderPass() override;
+
+        void execute(const std::vector<DrawCommand>& drawQueue,
+                     const Camera& camera,
+                     const DirectionalLight& directionalLight,
+                     const std::vector<PointLight>& pointLights,
+                     const MeshBuffer& buffer) override;
+
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
+
+    private:
+        void drawCulledBuckets() const;
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_transformBlock{};
+        StorageBufferSlot m_instanceSlot{};
+        std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
+        std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
+        std::unique_ptr<GpuCuller> m_culler{nullptr};
+
+        Inputs m_inputs{};
+        Texture2D* m_depthImage{nullptr};
+
+        GLuint m_viewportWidth{0};
+        GLuint m_viewportHeight{0};
+        float m_aspectRatio{0.0f};
+};
@@ -4,47 +4,60 @@
 #include "DirectionalShadowRenderPass.h"
 
 #include "core/FileSystem.h"
-#include "core/Vertex.h"
+#include "data/Box.h"
 #include "data/DirectionalLight.h"
 #include "data/Mesh.h"
 #include "data/Texture.h"
+#include "rendering/Camera.h"
 #include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/GpuCuller.h"
+#include "rendering/InstanceBuffer.h"
 #include "rendering/LightTransform.h"
 #include "rendering/MeshBuffer.h"
 #include "rendering/Shader.h"
 #include "rendering/VertexLayout.h"
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
-struct alignas(16) LightTransformUbo
+#include <algorithm>
+#include <cmath>
+
+constexpr auto cascadeCount = 4;
+constexpr auto shadowMapWidth = 2048;
+constexpr auto shadowMapHeight = 2048;
+
+// Cascades stop well before the camera far plane, beyond this distance nothing is shadowed
+constexpr auto maxShadowDistance = 150.0f;
+constexpr auto cascadeSplitLambda = 0.75f;
+
+struct alignas(16) CascadeUbo
 {
-        glm::mat4 lightSpaceMatrix;
-        glm::mat4 model;
+        glm::mat4 lightSpaceMatrices[cascadeCount];
 };
 
-constexpr auto ShadowMapWidth = 2048;
-constexpr auto ShadowMapHeight = 2048;
-
 DirectionalShadowRenderPass::DirectionalShadowRenderPass()
     : RenderPass()
 {
     const auto shaderDir = GetShaderDir();
     const auto vsPath = shaderDir / "mesh_shadow_vertex.glsl";
+    const auto gsPath = shaderDir / "mesh_shadow_geometry.glsl";
     const auto fsPath = shaderDir / "mesh_shadow_fragment.glsl";
 
-    m_shader = std::make_unique<Shader>(vsPath, fsPath);
-    m_shader->registerUniformBuffer("LightTransformBlock", sizeof(LightTransformUbo), 0);
+    m_shader = std::make_unique<Shader>(vsPath, gsPath, fsPath);
+    m_cascadeBlock = m_shader->registerUniformBuffer("CascadeBlock", sizeof(CascadeUbo), 1);
+    m_instanceSlot = m_shader->registerStorageBuffer("InstanceBuffer", 3);
+    m_cascadeMaskSlot = m_shader->registerStorageBuffer("ViewMaskBuffer", 4);
 
     m_framebuffer = std::make_unique<Framebuffer>();
     m_framebuffer->setDrawBuffer(GL_NONE);
     m_framebuffer->setReadBuffer(GL_NONE);
 
     m_vertexLayout = std::make_unique<VertexLayout>();
-    m_vertexLayout->registerAttribute(0, 3, GL_FLOAT, offsetof(Vertex, position));
-    m_vertexLayout->registerAttribute(1, 2, GL_FLOAT, offsetof(Vertex, textureUV));
-    m_vertexLayout->registerAttribute(2, 3, GL_FLOAT, offsetof(Vertex, normal));
 
-    m_shadowMapDepthImage = std::make_unique<Texture2D>(GL_DEPTH_COMPONENT24, ShadowMapWidth, ShadowMapHeight);
+    m_shadowMapDepthImage = std::make_unique<Texture2DArray>(GL_DEPTH_COMPONENT24, shadowMapWidth, shadowMapHeight, cascadeCount);
     m_shadowMapDepthImage->setMinFilter(GL_LINEAR);
     m_shadowMapDepthImage->setMagFilter(GL_LINEAR);
     m_shadowMapDepthImage->setWrapS(GL_CLAMP_TO_BORDER);
@@ -52,53 +65,205 @@ DirectionalShadowRenderPass::DirectionalShadowRenderPass()
     m_shadowMapDepthImage->setBorderColor(glm::vec4{1.0f, 1.0f, 1.0f, 1.0f});
     m_shadowMapDepthImage->setComparisonMode(GL_COMPARE_REF_TO_TEXTURE);
     m_shadowMapDepthImage->setComparisonFunction(GL_LEQUAL);
+
+    m_framebuffer->attachTexture(GL_DEPTH_ATTACHMENT, *m_shadowMapDepthImage.get(), 0);
+
+    m_culler = std::make_unique<GpuCuller>();
 }
 
 DirectionalShadowRenderPass::~DirectionalShadowRenderPass() = default;
 
-void DirectionalShadowRenderPass::execute(const std::vector<DrawCommand>& drawQueue, 
+void DirectionalShadowRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
                                           const Camera& camera,
                                           const DirectionalLight& directionalLight,
                                           const std::vector<PointLight>& pointLights,
                                           const MeshBuffer& buffer)
 {
+    const auto& instances = *m_inputs.instances;
+    const auto lightView = getDirectionalLightView(directionalLight.direction);
+
+    // Caster bounds in light space, so each cascade can cull them against its ortho box.
+    // The GPU path culls against the cascade frusta instead and never needs them
+    auto casterBounds = std::vector<Box>{};
+    if (!m_inputs.gpuCulling)
+    {
+        casterBounds.reserve(drawQueue.size());
+        for (const auto& drawCommand : drawQueue)
+        {
+            auto bounds = drawCommand.mesh->boundingBox;
+            bounds.transform(lightView * drawCommand.transform);
+            casterBounds.push_back(bounds);
+        }
+    }
+
+    const auto shadowDistance = std::min(camera.farPlane, maxShadowDistance);
+    const auto splitDepths = getCascadeSplitDepths(camera.nearPlane, shadowDistance, cascadeCount, cascadeSplitLambda);
+    const auto cameraView = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+
+    m_cascadeMasks.assign(drawQueue.size(), 0);
+    auto cascadeUbo = CascadeUbo{};
+    auto cullViews = std::vector<GpuCuller::Frustum>{};
+    m_cascades.clear();
+
+    for (auto cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex)
+    {
+        const auto sliceNear = cascadeIndex == 0 ? camera.nearPlane : splitDepths[cascadeIndex - 1];
+        const auto sliceFar = splitDepths[cascadeIndex];
+
+        const auto sliceProjection = glm::perspective(camera.fieldOfView, m_aspectRatio, sliceNear, sliceFar);
+        const auto corners = getFrustumCorners(sliceProjection * cameraView);
+
+        // Fit a sphere rather than a box around the slice, so the ortho size does not change as the camera rotates
+        auto center = glm::vec3{0.0f};
+        for (const auto& corner : corners)
+        {
+            center += corner;
+        }
+        center /= static_cast<float>(corners.size());
+
+        auto radius = 0.0f;
+        for (const auto& corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // Snap the box to whole texels in light space, so shadow edges do not shimmer as the camera moves
+        const auto texelSize = (2.0f * radius) / static_cast<float>(shadowMapWidth);
+        auto lightSpaceCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+        lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+
+        const auto cascadeBounds = Box{lightSpaceCenter - glm::vec3{radius}, lightSpaceCenter + glm::vec3{radius}};
+
+        // The light looks down -z, so casters anywhere between the light and the far side of the slice can cast into it
+        auto maxZ = cascadeBounds.max().z;
+        for (size_t i = 0; i < casterBounds.size(); ++i)
+        {
+            const auto& bounds = casterBounds[i];
+            const auto overlaps = bounds.min().x <= cascadeBounds.max().x && bounds.max().x >= cascadeBounds.min().x
+                               && bounds.min().y <= cascadeBounds.max().y && bounds.max().y >= cascadeBounds.min().y
+                               && bounds.max().z >= cascadeBounds.min().z;
+            if (!overlaps)
+            {
+                continue;
+            }
+
+            m_cascadeMasks[i] |= 1u << cascadeIndex;
+            maxZ = std::max(maxZ, bounds.max().z);
+        }
+
+        const auto nearDistance = -maxZ;
+        const auto farDistance = -cascadeBounds.min().z;
+        const auto lightProjection = glm::ortho(cascadeBounds.min().x, cascadeBounds.max().x,
+                                                cascadeBounds.min().y, cascadeBounds.max().y,
+                                                nearDistance, farDistance);
+
+        auto cascade = Cascade{};
+        cascade.lightSpaceMatrix = lightProjection * lightView;
+
+        if (m_inputs.gpuCulling)
+        {
+            // Casters between the light and the cascade still cast into it, so the near plane never rejects
+            auto planes = getFrustumPlanes(cascade.lightSpaceMatrix);
+            planes[4] = glm::vec4{0.0f, 0.0f, 0.0f, 1.0f};
+            cullViews.push_back(planes);
+        }
+        cascade.splitDepth = sliceFar;
+        // A couple of texels of world space bias, expressed in this cascade's [0, 1] depth range
+        cascade.depthBias = (2.0f * texelSize) / (farDistance - nearDistance);
+        m_cascades.push_back(cascade);
+
+        cascadeUbo.lightSpaceMatrices[cascadeIndex] = cascade.lightSpaceMatrix;
+    }
+
+    if (m_inputs.gpuCulling)
+    {
+        m_culler->cull(instances, cullViews);
+    }
+
     m_shader->bind();
     m_framebuffer->bind();
-    m_framebuffer->attachTexture(GL_DEPTH_ATTACHMENT, *m_shadowMapDepthImage.get(), 0);
 
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
+
+    // The whole array is attached, so every cascade is cleared at once and the geometry shader picks one with gl_Layer
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    glViewport(0, 0, ShadowMapWidth, ShadowMapHeight);
+    glState.setViewport(0, 0, shadowMapWidth, shadowMapHeight);
     m_vertexLayout->bind();
-    buffer.bindToVertexLayout(*m_vertexLayout);
+    buffer.bindPositionsToVertexLayout(*m_vertexLayout);
+    instances.bindToVertexLayout(*m_vertexLayout);
+
+    m_shader->writeUniformData(m_cascadeBlock, sizeof(CascadeUbo), &cascadeUbo);
+    m_shader->bindStorageBuffer(m_instanceSlot, instances.instanceBufferHandle());
+
+    if (m_inputs.gpuCulling)
+    {
+        m_shader->bindStorageBuffer(m_cascadeMaskSlot, m_culler->viewMaskBufferHandle());
+        m_culler->bindIndirectBuffer();
 
-    auto lightTransformUbo = LightTransformUbo{};
-    lightTransformUbo.lightSpaceMatrix = getLightSpaceMatrix(directionalLight.direction);
+        // The cascades' near planes are not fitted to the casters, so casters in front of them are clamped onto them
+        glState.setEnabled(GL_DEPTH_CLAMP, true);
+        for (size_t i = 0; i < instances.buckets().size(); ++i)
+        {
+            m_culler->drawBucket(instances, i);
+        }
+        glState.setEnabled(GL_DEPTH_CLAMP, false);
+        return;
+    }
 
-    for (const auto& drawCommand : drawQueue)
+    if (m_cascadeMaskCapacity < instances.capacity())
+    {
+        m_cascadeMaskBuffer = std::make_unique<Buffer<GLuint>>(instances.capacity());
+        m_cascadeMaskCapacity = instances.capacity();
+    }
+    if (!m_cascadeMasks.empty())
     {
-        const auto indexCount = drawCommand.mesh->indices.size();
-        const auto indexOffset = buffer.indexOffsetOfMesh(drawCommand.mesh);
-        const auto vertexOffset = buffer.vertexOffsetOfMesh(drawCommand.mesh);
+        m_cascadeMaskBuffer->write(m_cascadeMasks);
+    }
+    m_shader->bindStorageBuffer(m_cascadeMaskSlot, m_cascadeMaskBuffer->handle());
 
-        lightTransformUbo.model = drawCommand.transform;
+    for (size_t i = 0; i < drawQueue.size(); ++i)
+    {
+        if (m_cascadeMasks[i] == 0)
+        {
+            continue;
+        }
 
-        m_shader->writeUniformData("LightTransformBlock", sizeof(LightTransformUbo), &lightTransformUbo);
+        const auto& gpuMesh = drawQueue[i].gpuMesh;
 
-        glDrawElementsBaseVertex(
+        glDrawElementsInstancedBaseVertexBaseInstance(
             GL_TRIANGLES,
-            static_cast<GLsizei>(indexCount),
-            GL_UNSIGNED_INT,
-            reinterpret_cast<const void*>(indexOffset * sizeof(GLuint)),
-            vertexOffset);
+            gpuMesh.indexCount,
+            gpuMesh.indexType,
+            gpuMesh.indexPointer(),
+            1,
+            gpuMesh.baseVertex,
+            static_cast<GLuint>(i));
     }
 }
 
-Texture2D* DirectionalShadowRenderPass::directionalLightShadowMapImage() const
+void DirectionalShadowRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+}
+
+void DirectionalShadowRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+Texture2DArray* DirectionalShadowRenderPass::directionalLightShadowMapImage() const
 {
     return m_shadowMapDepthImage.get();
 }
+
+const std::vector<DirectionalShadowRenderPass::Cascade>& DirectionalShadowRenderPass::cascades() const
+{
+    return m_cascades;
+}
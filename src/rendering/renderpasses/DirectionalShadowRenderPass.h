@@ -3,33 +3,75 @@
 
 #pragma once
 
+#include "rendering/Buffer.h"
 #include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
 
 #include <memory>
+#include <vector>
 
 class Framebuffer;
+class GpuCuller;
+class InstanceBuffer;
 class MeshBuffer;
-class Shader;
-class Texture2D;
+class Texture2DArray;
 class VertexLayout;
 
 class DirectionalShadowRenderPass : public RenderPass
 {
     public:
+        struct Inputs
+        {
+            const InstanceBuffer* instances{nullptr};
+            // Cull the casters against every cascade in one dispatch and draw them with multi-draws
+            bool gpuCulling{false};
+        };
+
+        struct Cascade
+        {
+            glm::mat4 lightSpaceMatrix{1.0f};
+            float splitDepth{0.0f};
+            float depthBias{0.0f};
+        };
+
         DirectionalShadowRenderPass();
-        ~DirectionalShadowRenderPass() override;   
+        ~DirectionalShadowRenderPass() override;
 
-        void execute(const std::vector<DrawCommand>& drawQueue, 
+        void execute(const std::vector<DrawCommand>& drawQueue,
                      const Camera& camera,
                      const DirectionalLight& directionalLight,
                      const std::vector<PointLight>& pointLights,
                      const MeshBuffer& buffer) override;
 
-        Texture2D* directionalLightShadowMapImage() const;
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+
+        Texture2DArray* directionalLightShadowMapImage() const;
+
+        // Cascades used by the last execute, ordered near to far along the camera view
+        const std::vector<Cascade>& cascades() const;
 
     private:
         std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_cascadeBlock{};
+        StorageBufferSlot m_instanceSlot{};
+        StorageBufferSlot m_cascadeMaskSlot{};
         std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
         std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
-        std::unique_ptr<Texture2D> m_shadowMapDepthImage{nullptr};
+        std::unique_ptr<Texture2DArray> m_shadowMapDepthImage{nullptr};
+        std::unique_ptr<GpuCuller> m_culler{nullptr};
+        // Cascades each caster overlaps, when they are culled on the CPU
+        std::unique_ptr<Buffer<GLuint>> m_cascadeMaskBuffer{nullptr};
+        std::vector<GLuint> m_cascadeMasks;
+        size_t m_cascadeMaskCapacity{0};
+        std::vector<Cascade> m_cascades;
+
+        Inputs m_inputs{};
+
+        float m_aspectRatio{1.0f};
 };
@@ -4,12 +4,16 @@
 #include "GBufferRenderPass.h"
 
 #include "core/FileSystem.h"
-#include "core/Vertex.h"
 #include "data/Material.h"
 #include "data/Mesh.h"
 #include "data/Texture.h"
 #include "rendering/Camera.h"
 #include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/GpuCuller.h"
+#include "rendering/HiZPyramid.h"
+#include "rendering/InstanceBuffer.h"
+#include "rendering/LightTransform.h"
 #include "rendering/MeshBuffer.h"
 #include "rendering/Shader.h"
 #include "rendering/VertexLayout.h"
@@ -22,7 +26,7 @@ struct alignas(16) TransformUbo
 {
         glm::mat4 projection;
         glm::mat4 view;
-        glm::mat4 model;
+        int octahedralNormals;
 };
 
 struct alignas(16) MaterialUbo
@@ -40,17 +44,25 @@ GBufferRenderPass::GBufferRenderPass()
     const auto fsPath = shaderDir / "mesh_deferred_fragment.glsl";
 
     m_shader = std::make_unique<Shader>(vsPath, fsPath);
-    m_shader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
-    m_shader->registerTextureSampler("diffuseTexture", 1);
-    m_shader->registerUniformBuffer("MaterialBlock", sizeof(MaterialUbo), 2);
+    m_slots.transformBlock = m_shader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
+    m_slots.diffuseTexture = m_shader->registerTextureSampler("diffuseTexture", 1);
+    m_slots.materialBlock = m_shader->registerUniformBuffer("MaterialBlock", sizeof(MaterialUbo), 2);
+    m_slots.instanceBuffer = m_shader->registerStorageBuffer("InstanceBuffer", 3);
+
+    const auto overdrawDefines = std::vector<std::string>{"COUNT_OVERDRAW"};
+    m_overdrawShader = std::make_unique<Shader>(vsPath, fsPath, overdrawDefines);
+    m_overdrawSlots.transformBlock = m_overdrawShader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
+    m_overdrawSlots.diffuseTexture = m_overdrawShader->registerTextureSampler("diffuseTexture", 1);
+    m_overdrawSlots.materialBlock = m_overdrawShader->registerUniformBuffer("MaterialBlock", sizeof(MaterialUbo), 2);
+    m_overdrawSlots.instanceBuffer = m_overdrawShader->registerStorageBuffer("InstanceBuffer", 3);
 
     m_framebuffer = std::make_unique<Framebuffer>();
-    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2});
+    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
 
+    // Attribute formats depend on the mesh buffer's vertex format and are set when it is bound
     m_vertexLayout = std::make_unique<VertexLayout>();
-    m_vertexLayout->registerAttribute(0, 3, GL_FLOAT, offsetof(Vertex, position));
-    m_vertexLayout->registerAttribute(1, 2, GL_FLOAT, offsetof(Vertex, textureUV));
-    m_vertexLayout->registerAttribute(2, 3, GL_FLOAT, offsetof(Vertex, normal));
+
+    m_culler = std::make_unique<GpuCuller>(true);
 }
 
 GBufferRenderPass::~GBufferRenderPass() = default;
@@ -61,109 +73,181 @@ void GBufferRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
                                 const std::vector<PointLight>& pointLights,
                                 const MeshBuffer& buffer)
 {
-    m_shader->bind();
+    const auto& instances = *m_inputs.instances;
+
+    auto transformUbo = TransformUbo{};
+    transformUbo.projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
+    transformUbo.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+    transformUbo.octahedralNormals = buffer.octahedralNormals() ? 1 : 0;
+
+    const auto viewProjection = transformUbo.projection * transformUbo.view;
+    const auto frustum = getFrustumPlanes(viewProjection);
+    m_viewProjection = viewProjection;
+    m_culler->setViewerPosition(camera.position);
+
+    // A pre-pass has already built the pyramid from this frame's depth, so nothing it hides needs a retest
+    auto* pyramid = m_inputs.gpuCulling ? m_inputs.hiZPyramid : nullptr;
+    const auto testOcclusion = pyramid && pyramid->valid();
+    const auto retestOcclusion = testOcclusion && !m_inputs.depthPrePass;
+
+    // The cull dispatch binds its own program, so it runs before this pass binds anything
+    if (testOcclusion)
+    {
+        m_culler->cull(instances, {frustum}, {pyramid, pyramid->viewProjection(), GpuCuller::OcclusionTest::Test});
+    }
+    else if (m_inputs.gpuCulling)
+    {
+        m_culler->cull(instances, {frustum});
+    }
+
+    auto& shader = m_countOverdraw ? *m_overdrawShader : *m_shader;
+    const auto& slots = m_countOverdraw ? m_overdrawSlots : m_slots;
+    shader.bind();
     m_framebuffer->bind();
 
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    if (m_inputs.depthPrePass)
+    {
+        // Keep the pre-pass depth, only the nearest surface of each pixel passes
+        glState.setDepthFunc(GL_EQUAL);
+        glState.setDepthMask(false);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    else
+    {
+        glState.setDepthFunc(GL_LESS);
+        glState.setDepthMask(true);
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    }
 
-    glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    if (m_countOverdraw)
+    {
+        // Blending is enabled for the counter target only. The cache tracks blending as disabled,
+        // which holds for every target once it is switched off again below
+        glState.setBlendFunc(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+        glEnablei(GL_BLEND, 2);
+    }
+
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
     m_vertexLayout->bind();
     buffer.bindToVertexLayout(*m_vertexLayout);
+    instances.bindToVertexLayout(*m_vertexLayout);
+
+    shader.writeUniformData(slots.transformBlock, sizeof(TransformUbo), &transformUbo);
+    shader.bindStorageBuffer(slots.instanceBuffer, instances.instanceBufferHandle());
 
-    for (const auto& drawCommand : drawQueue)
+    if (m_inputs.gpuCulling)
     {
-        const auto indexCount = drawCommand.mesh->indices.size();
-        const auto indexOffset = buffer.indexOffsetOfMesh(drawCommand.mesh);
-        const auto vertexOffset = buffer.vertexOffsetOfMesh(drawCommand.mesh);
+        drawCulledBuckets(shader, slots);
 
-        const auto* material = drawCommand.mesh->material;
-        if(!material)
+        if (retestOcclusion)
         {
-            continue;
-        }
-
-        auto transformUbo = TransformUbo{};
-        transformUbo.projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
-        transformUbo.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
-        transformUbo.model = drawCommand.transform;
+            // The depth so far holds what was visible last frame. Whatever it no longer hides was disoccluded
+            pyramid->build(*m_depthImage, viewProjection);
+            m_culler->cull(instances, {frustum}, {pyramid, viewProjection, GpuCuller::OcclusionTest::Retest});
 
-        auto materialUbo = MaterialUbo{};
-        materialUbo.diffuseColor = glm::vec4{material->diffuse, 1.0f};
-        if (material->diffuseTexture)
-        {
-            materialUbo.hasTexture = 1;
-            m_shader->bindTexture("diffuseTexture", material->diffuseTexture.value());
+            shader.bind();
+            drawCulledBuckets(shader, slots);
         }
-        else
+    }
+    else
+    {
+        for (size_t i = 0; i < drawQueue.size(); ++i)
         {
-            materialUbo.hasTexture = 0;
+            if (drawQueue[i].hiddenFromCamera)
+            {
+                continue;
+            }
+
+            const auto& gpuMesh = drawQueue[i].gpuMesh;
+
+            const auto* material = drawQueue[i].mesh->material;
+            if(!material)
+            {
+                continue;
+            }
+
+            bindMaterial(shader, slots, *material);
+
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                GL_TRIANGLES,
+                gpuMesh.indexCount,
+                gpuMesh.indexType,
+                gpuMesh.indexPointer(),
+                1,
+                gpuMesh.baseVertex,
+                static_cast<GLuint>(i));
         }
-        m_shader->writeUniformData("TransformBlock", sizeof(TransformUbo), &transformUbo);
-        m_shader->writeUniformData("MaterialBlock", sizeof(MaterialUbo), &materialUbo);
-
-        glDrawElementsBaseVertex(
-            GL_TRIANGLES,
-            static_cast<GLsizei>(indexCount),
-            GL_UNSIGNED_INT,
-            reinterpret_cast<const void*>(indexOffset * sizeof(GLuint)),
-            vertexOffset);
     }
-}
 
-void GBufferRenderPass::onViewportResize(GLuint width, GLuint height)
-{
-    m_viewportWidth = width;
-    m_viewportHeight = height;
-
-    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
-
-    rebuildImages();
+    if (m_countOverdraw)
+    {
+        glDisablei(GL_BLEND, 2);
+    }
 }
 
-Texture2D* GBufferRenderPass::colorImage() const
+void GBufferRenderPass::bindMaterial(const Shader& shader, const ShaderSlots& slots, const Material& material) const
 {
-    return m_colorImage.get();
+    auto materialUbo = MaterialUbo{};
+    materialUbo.diffuseColor = glm::vec4{material.diffuse, 1.0f};
+    if (material.diffuseTexture)
+    {
+        materialUbo.hasTexture = 1;
+        shader.bindTexture(slots.diffuseTexture, material.diffuseTexture.value());
+    }
+    shader.writeUniformData(slots.materialBlock, sizeof(MaterialUbo), &materialUbo);
 }
 
-Texture2D* GBufferRenderPass::normalImage() const
+void GBufferRenderPass::drawCulledBuckets(const Shader& shader, const ShaderSlots& slots) const
 {
-    return m_normalImage.get();
+    const auto& instances = *m_inputs.instances;
+    m_culler->bindIndirectBuffer();
+
+    const auto& buckets = instances.buckets();
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        if (!buckets[i].material)
+        {
+            continue;
+        }
+
+        bindMaterial(shader, slots, *buckets[i].material);
+        m_culler->drawBucket(instances, i);
+    }
 }
 
-Texture2D* GBufferRenderPass::positionImage() const
+void GBufferRenderPass::onViewportResize(GLuint width, GLuint height)
 {
-    return m_positionImage.get();
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
 }
 
-Texture2D* GBufferRenderPass::depthImage() const
+void GBufferRenderPass::setInputs(const Inputs& inputs)
 {
-    return m_depthImage.get();
+    m_inputs = inputs;
 }
 
-void GBufferRenderPass::rebuildImages()
+void GBufferRenderPass::setOutputs(const Outputs& outputs)
 {
-    m_colorImage = std::make_unique<Texture2D>(GL_RGBA16F, m_viewportWidth, m_viewportHeight);
-    m_colorImage->setMinFilter(GL_LINEAR);
-    m_colorImage->setMagFilter(GL_LINEAR);
-
-    m_normalImage = std::make_unique<Texture2D>(GL_RGBA16F, m_viewportWidth, m_viewportHeight);
-    m_normalImage->setMinFilter(GL_LINEAR);
-    m_normalImage->setMagFilter(GL_LINEAR);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *outputs.colorImage, 0);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT1, *outputs.normalImage, 0);
+    m_framebuffer->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, *outputs.depthImage, 0);
+    m_depthImage = outputs.depthImage;
 
-    m_positionImage = std::make_unique<Texture2D>(GL_RGBA32F, m_viewportWidth, m_viewportHeight);
-    m_positionImage->setMinFilter(GL_NEAREST);
-    m_positionImage->setMagFilter(GL_NEAREST);
-
-    m_depthImage = std::make_unique<Texture2D>(GL_DEPTH_COMPONENT24, m_viewportWidth, m_viewportHeight);
-
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *m_colorImage.get(), 0);
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT1, *m_normalImage.get(), 0);
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT2, *m_positionImage.get(), 0);
-    m_framebuffer->attachTexture(GL_DEPTH_ATTACHMENT, *m_depthImage.get(), 0);
+    m_countOverdraw = outputs.overdrawImage != nullptr;
+    if (m_countOverdraw)
+    {
+        m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT2, *outputs.overdrawImage, 0);
+        m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2});
+    }
+    else
+    {
+        m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+    }
 }
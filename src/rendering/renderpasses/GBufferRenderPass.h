@@ -4,20 +4,47 @@
 #pragma once
 
 #include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glm/glm.hpp>
 
 #include <memory>
 
 #include <glad/gl.h>
 
 class Framebuffer;
+class GpuCuller;
+class HiZPyramid;
+class InstanceBuffer;
+struct Material;
 class MeshBuffer;
-class Shader;
 class Texture2D;
 class VertexLayout;
 
 class GBufferRenderPass : public RenderPass
 {
     public:
+        struct Inputs
+        {
+            // The depth image already holds the scene depth, so only fragments equal to it are shaded
+            bool depthPrePass{false};
+            const InstanceBuffer* instances{nullptr};
+            // Cull the instances on the GPU and draw the survivors with one multi-draw per bucket
+            bool gpuCulling{false};
+            // Also skips instances hidden in the pyramid, only with GPU culling. Without a pre-pass the pyramid
+            // is last frame's, so the instances it rejects are retested against this frame's depth and drawn late
+            HiZPyramid* hiZPyramid{nullptr};
+        };
+
+        struct Outputs
+        {
+            Texture2D* colorImage;
+            Texture2D* normalImage;
+            Texture2D* depthImage;
+            // Optional, counts the fragments shaded per pixel
+            Texture2D* overdrawImage{nullptr};
+        };
+
         GBufferRenderPass();
         ~GBufferRenderPass() override;   
 
@@ -29,23 +56,41 @@ class GBufferRenderPass : public RenderPass
 
         void onViewportResize(GLuint width, GLuint height);
 
-        Texture2D* colorImage() const;
-        Texture2D* normalImage() const;
-        Texture2D* positionImage() const;
-        Texture2D* depthImage() const;
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
+
+        // Camera view projection of the last execute
+        inline const glm::mat4& viewProjection() const
+        {
+            return m_viewProjection;
+        }
 
     private:
-        void rebuildImages();
+        struct ShaderSlots
+        {
+            UniformBufferSlot transformBlock{};
+            TextureSlot diffuseTexture{};
+            UniformBufferSlot materialBlock{};
+            StorageBufferSlot instanceBuffer{};
+        };
+
+        void bindMaterial(const Shader& shader, const ShaderSlots& slots, const Material& material) const;
+        void drawCulledBuckets(const Shader& shader, const ShaderSlots& slots) const;
 
     private:
         std::unique_ptr<Shader> m_shader{nullptr};
+        std::unique_ptr<Shader> m_overdrawShader{nullptr};
+        ShaderSlots m_slots{};
+        ShaderSlots m_overdrawSlots{};
         std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
         std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
-        std::unique_ptr<Texture2D> m_colorImage{nullptr};
-        std::unique_ptr<Texture2D> m_normalImage{nullptr};
-        std::unique_ptr<Texture2D> m_positionImage{nullptr};
-        std::unique_ptr<Texture2D> m_depthImage{nullptr};
-        
+        std::unique_ptr<GpuCuller> m_culler{nullptr};
+
+        Inputs m_inputs{};
+        Texture2D* m_depthImage{nullptr};
+        glm::mat4 m_viewProjection{1.0f};
+        bool m_countOverdraw{false};
+
         GLuint m_viewportWidth{0};
         GLuint m_viewportHeight{0};
         float m_aspectRatio{0.0f};
@@ -0,0 +1,164 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "ImpostorRenderPass.h"
+
+#include "core/FileSystem.h"
+#include "data/Texture.h"
+#include "rendering/Camera.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/ImpostorBaker.h"
+#include "rendering/Shader.h"
+#include "rendering/VertexLayout.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+
+constexpr auto initialImpostorCapacity = size_t{1024};
+
+struct alignas(16) ImpostorUbo
+{
+        glm::mat4 viewProjection;
+        glm::vec4 cameraPosition;
+        glm::vec4 boundingSphere;
+        int frameCount;
+        // GL 4.5 has no gl_BaseInstance, so each atlas's draw is told where its instances start
+        int firstInstance;
+};
+
+ImpostorRenderPass::ImpostorRenderPass()
+    : RenderPass()
+{
+    const auto shaderDir = GetShaderDir();
+
+    m_shader = std::make_unique<Shader>(shaderDir / "impostor_vertex.glsl", shaderDir / "impostor_fragment.glsl");
+    m_slots.impostorBlock = m_shader->registerUniformBuffer("ImpostorBlock", sizeof(ImpostorUbo), 0);
+    m_slots.colorAtlas = m_shader->registerTextureSampler("colorAtlas", 0);
+    m_slots.normalAtlas = m_shader->registerTextureSampler("normalAtlas", 1);
+    m_slots.depthAtlas = m_shader->registerTextureSampler("depthAtlas", 2);
+    m_slots.impostorBuffer = m_shader->registerStorageBuffer("ImpostorBuffer", 3);
+
+    m_framebuffer = std::make_unique<Framebuffer>();
+    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+
+    // The quads are built from gl_VertexID, so the layout has no attributes
+    m_vertexLayout = std::make_unique<VertexLayout>();
+
+    reserve(initialImpostorCapacity);
+}
+
+ImpostorRenderPass::~ImpostorRenderPass() = default;
+
+void ImpostorRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
+                                 const Camera& camera,
+                                 const DirectionalLight& directionalLight,
+                                 const std::vector<PointLight>& pointLights,
+                                 const MeshBuffer& buffer)
+{
+    if (!m_inputs.impostors || m_inputs.impostors->empty())
+    {
+        return;
+    }
+
+    // Grouped by atlas, so each atlas is bound once and draws all its instances together
+    auto order = std::vector<const ImpostorDrawCommand*>{};
+    order.reserve(m_inputs.impostors->size());
+    for (const auto& command : *m_inputs.impostors)
+    {
+        order.push_back(&command);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const ImpostorDrawCommand* a, const ImpostorDrawCommand* b) {
+        return a->atlas < b->atlas;
+    });
+
+    m_impostors.clear();
+    for (const auto* command : order)
+    {
+        auto impostor = GpuImpostor{};
+        impostor.model = command->transform;
+        impostor.normalMatrix = glm::mat4{glm::transpose(glm::inverse(glm::mat3{command->transform}))};
+        m_impostors.push_back(impostor);
+    }
+
+    reserve(m_impostors.size());
+    m_impostorBuffer->write(m_impostors);
+
+    auto impostorUbo = ImpostorUbo{};
+    const auto projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
+    impostorUbo.viewProjection = projection * glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+    impostorUbo.cameraPosition = glm::vec4{camera.position, 1.0f};
+    impostorUbo.frameCount = ImpostorBaker::frameCount;
+
+    m_shader->bind();
+    m_framebuffer->bind();
+
+    // Drawn over the meshes already in the G-buffer, so the depth is kept and tested as usual
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
+
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    m_vertexLayout->bind();
+    m_shader->bindStorageBuffer(m_slots.impostorBuffer, m_impostorBuffer->handle());
+
+    for (size_t first = 0; first < order.size();)
+    {
+        const auto* atlas = order[first]->atlas;
+        auto end = first + 1;
+        while (end < order.size() && order[end]->atlas == atlas)
+        {
+            ++end;
+        }
+
+        impostorUbo.boundingSphere = atlas->boundingSphere;
+        impostorUbo.firstInstance = static_cast<int>(first);
+        m_shader->writeUniformData(m_slots.impostorBlock, sizeof(ImpostorUbo), &impostorUbo);
+        m_shader->bindTexture(m_slots.colorAtlas, atlas->colorImage.get());
+        m_shader->bindTexture(m_slots.normalAtlas, atlas->normalImage.get());
+        m_shader->bindTexture(m_slots.depthAtlas, atlas->depthImage.get());
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(end - first));
+        first = end;
+    }
+}
+
+void ImpostorRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+}
+
+void ImpostorRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+void ImpostorRenderPass::setOutputs(const Outputs& outputs)
+{
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *outputs.colorImage, 0);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT1, *outputs.normalImage, 0);
+    m_framebuffer->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, *outputs.depthImage, 0);
+}
+
+void ImpostorRenderPass::reserve(size_t impostorCount)
+{
+    if (impostorCount <= m_capacity)
+    {
+        return;
+    }
+
+    auto capacity = std::max(m_capacity, initialImpostorCapacity);
+    while (capacity < impostorCount)
+    {
+        capacity *= 2;
+    }
+
+    m_impostorBuffer = std::make_unique<Buffer<GpuImpostor>>(capacity);
+    m_capacity = capacity;
+}
@@ -0,0 +1,85 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <glad/gl.h>
+
+class Framebuffer;
+class Texture2D;
+class VertexLayout;
+
+// Draws distant prefab instances into the G-buffer as single quads, each showing the atlas frame baked
+// nearest to its view direction. Depth and normals come from the atlas, so lighting cannot tell them from meshes
+class ImpostorRenderPass : public RenderPass
+{
+    public:
+        struct Inputs
+        {
+            const std::vector<ImpostorDrawCommand>* impostors{nullptr};
+        };
+
+        struct Outputs
+        {
+            Texture2D* colorImage;
+            Texture2D* normalImage;
+            Texture2D* depthImage;
+        };
+
+        ImpostorRenderPass();
+        ~ImpostorRenderPass() override;
+
+        void execute(const std::vector<DrawCommand>& drawQueue,
+                     const Camera& camera,
+                     const DirectionalLight& directionalLight,
+                     const std::vector<PointLight>& pointLights,
+                     const MeshBuffer& buffer) override;
+
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
+
+    private:
+        // Matches the ImpostorInstance struct in impostor_vertex.glsl
+        struct alignas(16) GpuImpostor
+        {
+                glm::mat4 model{1.0f};
+                glm::mat4 normalMatrix{1.0f};
+        };
+
+        struct ShaderSlots
+        {
+            UniformBufferSlot impostorBlock{};
+            TextureSlot colorAtlas{};
+            TextureSlot normalAtlas{};
+            TextureSlot depthAtlas{};
+            StorageBufferSlot impostorBuffer{};
+        };
+
+        void reserve(size_t impostorCount);
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        ShaderSlots m_slots{};
+        std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
+        std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
+        std::unique_ptr<Buffer<GpuImpostor>> m_impostorBuffer{nullptr};
+        size_t m_capacity{0};
+
+        Inputs m_inputs{};
+        std::vector<GpuImpostor> m_impostors;
+
+        GLuint m_viewportWidth{0};
+        GLuint m_viewportHeight{0};
+        float m_aspectRatio{0.0f};
+};
@@ -0,0 +1,138 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "LightCullingRenderPass.h"
+
+#include "core/FileSystem.h"
+#include "data/PointLight.h"
+#include "rendering/Camera.h"
+#include "rendering/LightTransform.h"
+#include "rendering/Shader.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// These must match the defines in light_culling_compute.glsl and lighting_deferred_fragment.glsl
+constexpr auto clusterGridX = 16;
+constexpr auto clusterGridY = 9;
+constexpr auto clusterGridZ = 24;
+constexpr auto clusterCount = clusterGridX * clusterGridY * clusterGridZ;
+constexpr auto maxLightsPerCluster = 256;
+constexpr auto clusterWorkgroupSize = 128;
+
+constexpr auto maxPointLights = 4096;
+
+LightCullingRenderPass::LightCullingRenderPass()
+    : RenderPass()
+{
+    const auto shaderDir = GetShaderDir();
+    const auto csPath = shaderDir / "light_culling_compute.glsl";
+
+    m_shader = std::make_unique<Shader>(csPath);
+    m_lightSlot = m_shader->registerStorageBuffer("LightBuffer", 0);
+    m_lightGridSlot = m_shader->registerStorageBuffer("LightGridBuffer", 1);
+    m_lightIndexSlot = m_shader->registerStorageBuffer("LightIndexBuffer", 2);
+    m_clusterBlock = m_shader->registerUniformBuffer("ClusterBlock", sizeof(ClusterParameters), 3);
+
+    m_lightBuffer = std::make_unique<Buffer<GpuPointLight>>(maxPointLights);
+    m_lightGridBuffer = std::make_unique<Buffer<GLuint>>(clusterCount);
+    m_lightIndexBuffer = std::make_unique<Buffer<GLuint>>(clusterCount * maxLightsPerCluster);
+
+    m_gpuLights.reserve(maxPointLights);
+}
+
+LightCullingRenderPass::~LightCullingRenderPass() = default;
+
+void LightCullingRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
+                                     const Camera& camera,
+                                     const DirectionalLight& directionalLight,
+                                     const std::vector<PointLight>& pointLights,
+                                     const MeshBuffer& buffer)
+{
+    const auto lightCount = std::min(pointLights.size(), static_cast<size_t>(maxPointLights));
+
+    m_gpuLights.clear();
+    for (size_t i = 0; i < lightCount; ++i)
+    {
+        const auto& light = pointLights[i];
+
+        auto gpuLight = GpuPointLight{};
+        gpuLight.positionAndRadius = glm::vec4{light.position, light.radius};
+        gpuLight.colorAndRange = glm::vec4{light.color, getPointLightRange(light.radius)};
+        gpuLight.shadowIndex = m_inputs.pointLightShadowIndices->at(i);
+        m_gpuLights.push_back(gpuLight);
+    }
+
+    if (!m_gpuLights.empty())
+    {
+        m_lightBuffer->write(m_gpuLights);
+    }
+
+    // Depth slices are spaced exponentially, so slice = log(depth) * sliceScale - sliceBias
+    const auto depthRatio = std::log(camera.farPlane / camera.nearPlane);
+    const auto projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
+
+    m_clusterParameters.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+    m_clusterParameters.inverseProjection = glm::inverse(projection);
+    m_clusterParameters.gridSize = glm::uvec4{clusterGridX, clusterGridY, clusterGridZ, 0};
+    m_clusterParameters.screenSize = glm::vec4{m_viewportWidth, m_viewportHeight, 0.0f, 0.0f};
+    m_clusterParameters.nearPlane = camera.nearPlane;
+    m_clusterParameters.farPlane = camera.farPlane;
+    m_clusterParameters.sliceScale = static_cast<float>(clusterGridZ) / depthRatio;
+    m_clusterParameters.sliceBias = static_cast<float>(clusterGridZ) * std::log(camera.nearPlane) / depthRatio;
+    m_clusterParameters.lightCount = static_cast<uint32_t>(lightCount);
+
+    // The light list is still needed by the light volumes, but they do not use the clusters
+    if (!m_inputs.buildClusters)
+    {
+        return;
+    }
+
+    m_shader->bind();
+    m_shader->writeUniformData(m_clusterBlock, sizeof(ClusterParameters), &m_clusterParameters);
+    m_shader->bindStorageBuffer(m_lightSlot, m_lightBuffer->handle());
+    m_shader->bindStorageBuffer(m_lightGridSlot, m_lightGridBuffer->handle());
+    m_shader->bindStorageBuffer(m_lightIndexSlot, m_lightIndexBuffer->handle());
+
+    glDispatchCompute((clusterCount + clusterWorkgroupSize - 1) / clusterWorkgroupSize, 1, 1);
+
+    // The lighting pass reads the light lists from its fragment shader
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void LightCullingRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+}
+
+void LightCullingRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+const LightCullingRenderPass::ClusterParameters& LightCullingRenderPass::clusterParameters() const
+{
+    return m_clusterParameters;
+}
+
+GLuint LightCullingRenderPass::lightBufferHandle() const
+{
+    return m_lightBuffer->handle();
+}
+
+GLuint LightCullingRenderPass::lightGridBufferHandle() const
+{
+    return m_lightGridBuffer->handle();
+}
+
+GLuint LightCullingRenderPass::lightIndexBufferHandle() const
+{
+    return m_lightIndexBuffer->handle();
+}
@@ -0,0 +1,88 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct alignas(16) GpuPointLight
+{
+        glm::vec4 positionAndRadius;
+        glm::vec4 colorAndRange;
+        int shadowIndex{-1};
+        int _padding[3];
+};
+
+// Assigns the point lights to view space froxels with a compute shader, so lighting only evaluates
+// the lights whose range reaches each pixel's cluster
+class LightCullingRenderPass : public RenderPass
+{
+    public:
+        struct Inputs
+        {
+            const std::vector<int>* pointLightShadowIndices;
+            bool buildClusters{true};
+        };
+
+        // Matches ClusterBlock in the culling and lighting shaders
+        struct alignas(16) ClusterParameters
+        {
+                glm::mat4 view{1.0f};
+                glm::mat4 inverseProjection{1.0f};
+                glm::uvec4 gridSize{0};
+                glm::vec4 screenSize{0.0f};
+                float nearPlane{0.0f};
+                float farPlane{0.0f};
+                float sliceScale{0.0f};
+                float sliceBias{0.0f};
+                uint32_t lightCount{0};
+                uint32_t _padding[3];
+        };
+
+        LightCullingRenderPass();
+        ~LightCullingRenderPass() override;
+
+        void execute(const std::vector<DrawCommand>& drawQueue,
+                     const Camera& camera,
+                     const DirectionalLight& directionalLight,
+                     const std::vector<PointLight>& pointLights,
+                     const MeshBuffer& buffer) override;
+
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+
+        const ClusterParameters& clusterParameters() const;
+
+        GLuint lightBufferHandle() const;
+        GLuint lightGridBufferHandle() const;
+        GLuint lightIndexBufferHandle() const;
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_clusterBlock{};
+        StorageBufferSlot m_lightSlot{};
+        StorageBufferSlot m_lightGridSlot{};
+        StorageBufferSlot m_lightIndexSlot{};
+        std::unique_ptr<Buffer<GpuPointLight>> m_lightBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_lightGridBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_lightIndexBuffer{nullptr};
+
+        Inputs m_inputs{};
+        ClusterParameters m_clusterParameters{};
+        std::vector<GpuPointLight> m_gpuLights;
+
+        GLuint m_viewportWidth{0};
+        GLuint m_viewportHeight{0};
+        float m_aspectRatio{1.0f};
+};
@@ -7,47 +7,38 @@
 #include "data/DirectionalLight.h"
 #include "data/PointLight.h"
 #include "data/Texture.h"
+#include "rendering/Camera.h"
 #include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
 #include "rendering/LightTransform.h"
 #include "rendering/Shader.h"
 #include "rendering/VertexLayout.h"
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
-constexpr auto maxPointLights = 8;
-
 const auto quadVertices =
     std::vector<float>{-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f,
                        1.0f,  -1.0f, 1.0f, 0.0f, 1.0f, 1.0f,  1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f};
 
+constexpr auto cascadeCount = 4;
 
 struct alignas(16) DirectionalLightUbo
 {
         glm::vec3 dirLightDirection;
-        float _padding;
+        int shadePointLights{1};
         glm::vec4 dirLightDiffuseColor;
-        glm::mat4 dirLightSpaceMatrix;
-};
-
-struct alignas(16) FarPlaneUbo
-{
-        float farPlane;
-        float _padding[3];
-};
-
-struct alignas(16) AlignedPointLight
-{
-        glm::vec3 position;
-        float _padding;
-        glm::vec3 color;
-        float radius{1.0f};
+        glm::mat4 cascadeLightSpaceMatrices[cascadeCount];
+        glm::vec4 cascadeSplitDepths{0.0f};
+        glm::vec4 cascadeDepthBiases{0.0f};
+        glm::vec4 cameraPosition;
+        glm::vec4 cameraFront;
 };
 
-struct alignas(16) PointLightUbo
+struct alignas(16) CameraUbo
 {
-        int numPointLights;
-        float _padding[3];
-        AlignedPointLight lights[maxPointLights];
+        glm::mat4 inverseViewProjection;
 };
 
 LightingRenderPass::LightingRenderPass()
@@ -58,14 +49,17 @@ LightingRenderPass::LightingRenderPass()
     const auto fsPath = shaderDir / "lighting_deferred_fragment.glsl";
 
     m_shader = std::make_unique<Shader>(vsPath, fsPath);
-    m_shader->registerTextureSampler("colorTexture", 0);
-    m_shader->registerTextureSampler("normalTexture", 1);
-    m_shader->registerTextureSampler("positionTexture", 2);
-    m_shader->registerTextureSampler("directionalShadowMap", 3);
-    m_shader->registerTextureSampler("pointLightShadowMap", 4);
-    m_shader->registerUniformBuffer("DirectionalLightBlock", sizeof(DirectionalLightUbo), 5);
-    m_shader->registerUniformBuffer("FarPlaneBlock", sizeof(FarPlaneUbo), 6);
-    m_shader->registerUniformBuffer("PointLightBlock", sizeof(PointLightUbo), 7);
+    m_slots.colorTexture = m_shader->registerTextureSampler("colorTexture", 0);
+    m_slots.normalTexture = m_shader->registerTextureSampler("normalTexture", 1);
+    m_slots.depthTexture = m_shader->registerTextureSampler("depthTexture", 2);
+    m_slots.directionalShadowMap = m_shader->registerTextureSampler("directionalShadowMap", 3);
+    m_slots.pointLightShadowMap = m_shader->registerTextureSampler("pointLightShadowMap", 4);
+    m_slots.directionalLightBlock = m_shader->registerUniformBuffer("DirectionalLightBlock", sizeof(DirectionalLightUbo), 5);
+    m_slots.clusterBlock = m_shader->registerUniformBuffer("ClusterBlock", sizeof(LightCullingRenderPass::ClusterParameters), 6);
+    m_slots.cameraBlock = m_shader->registerUniformBuffer("CameraBlock", sizeof(CameraUbo), 7);
+    m_slots.lightBuffer = m_shader->registerStorageBuffer("LightBuffer", 0);
+    m_slots.lightGridBuffer = m_shader->registerStorageBuffer("LightGridBuffer", 1);
+    m_slots.lightIndexBuffer = m_shader->registerStorageBuffer("LightIndexBuffer", 2);
 
     m_framebuffer = std::make_unique<Framebuffer>();
     m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0});
@@ -89,43 +83,50 @@ void LightingRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
     m_shader->bind();
     m_framebuffer->bind();
 
-    glDisable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, false);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-    glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
     m_vertexLayout->bind();
 
-    const auto inputs = m_inputBinding();
-
-    m_shader->bindTexture("colorTexture", inputs.colorImage);
-    m_shader->bindTexture("normalTexture", inputs.normalImage);
-    m_shader->bindTexture("positionTexture", inputs.positionImage);
-    m_shader->bindTexture("directionalShadowMap", inputs.directionalLightShadowMapImage);
-    m_shader->bindTexture("pointLightShadowMap", inputs.pointLightShadowMapImage);
+    m_shader->bindTexture(m_slots.colorTexture, m_inputs.colorImage);
+    m_shader->bindTexture(m_slots.normalTexture, m_inputs.normalImage);
+    m_shader->bindTexture(m_slots.depthTexture, m_inputs.depthImage);
+    m_shader->bindTexture(m_slots.directionalShadowMap, m_inputs.directionalLightShadowMapImage);
+    m_shader->bindTexture(m_slots.pointLightShadowMap, m_inputs.pointLightShadowMapImage);
 
     auto directionalLightUbo = DirectionalLightUbo{};
     directionalLightUbo.dirLightDiffuseColor = glm::vec4{directionalLight.color, 1.0f};
     directionalLightUbo.dirLightDirection = directionalLight.direction;
-    directionalLightUbo.dirLightSpaceMatrix = getLightSpaceMatrix(directionalLight.direction);
-    m_shader->writeUniformData("DirectionalLightBlock", sizeof(DirectionalLightUbo), &directionalLightUbo);
-
-    const auto farPlaneUbo = FarPlaneUbo{.farPlane = 50.0f};
-    m_shader->writeUniformData("FarPlaneBlock", sizeof(FarPlaneUbo), &farPlaneUbo);
-
-    auto pointLightUbo = PointLightUbo{};
-    pointLightUbo.numPointLights = static_cast<int>(pointLights.size());
+    directionalLightUbo.shadePointLights = m_inputs.shadePointLights ? 1 : 0;
+    directionalLightUbo.cameraPosition = glm::vec4{camera.position, 1.0f};
+    directionalLightUbo.cameraFront = glm::vec4{glm::normalize(camera.front), 0.0f};
 
-    for (size_t i = 0; i < pointLights.size() && i < maxPointLights; i++)
+    const auto& cascades = *m_inputs.directionalShadowCascades;
+    for (size_t i = 0; i < cascades.size() && i < cascadeCount; ++i)
     {
-        pointLightUbo.lights[i].position = pointLights[i].position;
-        pointLightUbo.lights[i].color = pointLights[i].color;
-        pointLightUbo.lights[i].radius = pointLights[i].radius;
+        directionalLightUbo.cascadeLightSpaceMatrices[i] = cascades[i].lightSpaceMatrix;
+        directionalLightUbo.cascadeSplitDepths[i] = cascades[i].splitDepth;
+        directionalLightUbo.cascadeDepthBiases[i] = cascades[i].depthBias;
     }
+    m_shader->writeUniformData(m_slots.directionalLightBlock, sizeof(DirectionalLightUbo), &directionalLightUbo);
 
-    m_shader->writeUniformData("PointLightBlock", sizeof(PointLightUbo), &pointLightUbo);
+    const auto aspectRatio = static_cast<float>(m_viewportWidth) / static_cast<float>(m_viewportHeight);
+    const auto projection = glm::perspective(camera.fieldOfView, aspectRatio, camera.nearPlane, camera.farPlane);
+    const auto view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+
+    auto cameraUbo = CameraUbo{};
+    cameraUbo.inverseViewProjection = glm::inverse(projection * view);
+    m_shader->writeUniformData(m_slots.cameraBlock, sizeof(CameraUbo), &cameraUbo);
+
+    m_shader->writeUniformData(m_slots.clusterBlock, sizeof(LightCullingRenderPass::ClusterParameters), m_inputs.clusterParameters);
+    m_shader->bindStorageBuffer(m_slots.lightBuffer, m_inputs.lightBuffer);
+    m_shader->bindStorageBuffer(m_slots.lightGridBuffer, m_inputs.lightGridBuffer);
+    m_shader->bindStorageBuffer(m_slots.lightIndexBuffer, m_inputs.lightIndexBuffer);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
@@ -134,30 +135,14 @@ void LightingRenderPass::onViewportResize(GLuint width, GLuint height)
 {
     m_viewportWidth = width;
     m_viewportHeight = height;
-
-    rebuildImages();
-}
-
-void LightingRenderPass::setInputBinding(InputBinding binding)
-{
-    m_inputBinding = std::move(binding);
 }
 
-Texture2D* LightingRenderPass::colorImage() const
+void LightingRenderPass::setInputs(const Inputs& inputs)
 {
-    return m_colorImage.get();
+    m_inputs = inputs;
 }
 
-GLuint LightingRenderPass::framebufferHandle() const
+void LightingRenderPass::setOutputs(const Outputs& outputs)
 {
-    return m_framebuffer->handle();
-}
-
-void LightingRenderPass::rebuildImages()
-{
-    m_colorImage = std::make_unique<Texture2D>(GL_RGBA16F, m_viewportWidth, m_viewportHeight);
-    m_colorImage->setMinFilter(GL_LINEAR);
-    m_colorImage->setMagFilter(GL_LINEAR);
-
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *m_colorImage.get(), 0);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *outputs.colorImage, 0);
 }
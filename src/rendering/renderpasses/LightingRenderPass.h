@@ -5,16 +5,19 @@
 
 #include "rendering/Buffer.h"
 #include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+#include "rendering/renderpasses/DirectionalShadowRenderPass.h"
+#include "rendering/renderpasses/LightCullingRenderPass.h"
 
-#include <functional>
 #include <memory>
+#include <vector>
 
 #include <glad/gl.h>
 
 class Framebuffer;
 class MeshBuffer;
-class Shader;
 class Texture2D;
+class Texture2DArray;
 class TextureCubeMapArray;
 class VertexLayout;
 
@@ -25,12 +28,21 @@ class LightingRenderPass : public RenderPass
         {
             Texture2D* colorImage;
             Texture2D* normalImage;
-            Texture2D* positionImage;
-            Texture2D* directionalLightShadowMapImage;
+            Texture2D* depthImage;
+            Texture2DArray* directionalLightShadowMapImage;
+            const std::vector<DirectionalShadowRenderPass::Cascade>* directionalShadowCascades;
             TextureCubeMapArray* pointLightShadowMapImage;
+            const LightCullingRenderPass::ClusterParameters* clusterParameters;
+            GLuint lightBuffer;
+            GLuint lightGridBuffer;
+            GLuint lightIndexBuffer;
+            bool shadePointLights;
         };
 
-         using InputBinding = std::function<Inputs(void)>; 
+        struct Outputs
+        {
+            Texture2D* colorImage;
+        };
 
         LightingRenderPass();
         ~LightingRenderPass() override;   
@@ -43,23 +55,33 @@ class LightingRenderPass : public RenderPass
 
         void onViewportResize(GLuint width, GLuint height);
 
-        void setInputBinding(InputBinding binding);
-
-        Texture2D* colorImage() const;
-        
-        GLuint framebufferHandle() const;
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
 
     private:
-        void rebuildImages();
+        struct ShaderSlots
+        {
+            TextureSlot colorTexture{};
+            TextureSlot normalTexture{};
+            TextureSlot depthTexture{};
+            TextureSlot directionalShadowMap{};
+            TextureSlot pointLightShadowMap{};
+            UniformBufferSlot directionalLightBlock{};
+            UniformBufferSlot clusterBlock{};
+            UniformBufferSlot cameraBlock{};
+            StorageBufferSlot lightBuffer{};
+            StorageBufferSlot lightGridBuffer{};
+            StorageBufferSlot lightIndexBuffer{};
+        };
 
     private:
         std::unique_ptr<Shader> m_shader{nullptr};
+        ShaderSlots m_slots{};
         std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
         std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
-        std::unique_ptr<Texture2D> m_colorImage{nullptr};
         std::unique_ptr<Buffer<float>> m_vertexBuffer{nullptr};
 
-        InputBinding m_inputBinding;
+        Inputs m_inputs{};
         
         GLuint m_viewportWidth{0};
         GLuint m_viewportHeight{0};
@@ -0,0 +1,75 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "OverdrawRenderPass.h"
+
+#include "core/FileSystem.h"
+#include "data/Texture.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/Shader.h"
+#include "rendering/VertexLayout.h"
+
+const auto quadVertices =
+    std::vector<float>{-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f,
+                       1.0f,  -1.0f, 1.0f, 0.0f, 1.0f, 1.0f,  1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f};
+
+OverdrawRenderPass::OverdrawRenderPass()
+    : RenderPass()
+{
+    const auto shaderDir = GetShaderDir();
+    const auto vsPath = shaderDir / "lighting_deferred_vertex.glsl";
+    const auto fsPath = shaderDir / "overdraw_fragment.glsl";
+
+    m_shader = std::make_unique<Shader>(vsPath, fsPath);
+    m_overdrawTexture = m_shader->registerTextureSampler("overdrawTexture", 0);
+
+    m_framebuffer = std::make_unique<Framebuffer>();
+    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0});
+
+    m_vertexLayout = std::make_unique<VertexLayout>();
+    m_vertexLayout->registerAttribute(0, 2, GL_FLOAT, 0);
+    m_vertexLayout->registerAttribute(1, 2, GL_FLOAT, 2 * sizeof(float));
+
+    m_vertexBuffer = std::make_unique<Buffer<float>>(quadVertices);
+    m_vertexLayout->bindVertexBuffer(0, m_vertexBuffer->handle(), 0, 4 * sizeof(float));
+}
+
+OverdrawRenderPass::~OverdrawRenderPass() = default;
+
+void OverdrawRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
+                                 const Camera& camera,
+                                 const DirectionalLight& directionalLight,
+                                 const std::vector<PointLight>& pointLights,
+                                 const MeshBuffer& buffer)
+{
+    m_shader->bind();
+    m_framebuffer->bind();
+
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, false);
+
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    m_vertexLayout->bind();
+
+    m_shader->bindTexture(m_overdrawTexture, m_inputs.overdrawImage);
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+void OverdrawRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+}
+
+void OverdrawRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+void OverdrawRenderPass::setOutputs(const Outputs& outputs)
+{
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *outputs.colorImage, 0);
+}
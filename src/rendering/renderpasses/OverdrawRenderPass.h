@@ -0,0 +1,59 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <memory>
+#include <vector>
+
+#include <glad/gl.h>
+
+class Framebuffer;
+class MeshBuffer;
+class Texture2D;
+class VertexLayout;
+
+// Replaces the lit scene with a heat map of how many G-buffer fragments were shaded per pixel
+class OverdrawRenderPass : public RenderPass
+{
+    public:
+        struct Inputs
+        {
+            Texture2D* overdrawImage;
+        };
+
+        struct Outputs
+        {
+            Texture2D* colorImage;
+        };
+
+        OverdrawRenderPass();
+        ~OverdrawRenderPass() override;
+
+        void execute(const std::vector<DrawCommand>& drawQueue,
+                     const Camera& camera,
+                     const DirectionalLight& directionalLight,
+                     const std::vector<PointLight>& pointLights,
+                     const MeshBuffer& buffer) override;
+
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
+
+    private:
+        std::unique_ptr<Shader> m_shader{nullptr};
+        TextureSlot m_overdrawTexture{};
+        std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
+        std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
+        std::unique_ptr<Buffer<float>> m_vertexBuffer{nullptr};
+
+        Inputs m_inputs{};
+
+        GLuint m_viewportWidth{0};
+        GLuint m_viewportHeight{0};
+};
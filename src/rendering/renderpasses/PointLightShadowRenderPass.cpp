@@ -4,67 +4,73 @@
 #include "PointLightShadowRenderPass.h"
 
 #include "core/FileSystem.h"
-#include "core/Vertex.h"
+#include "data/Box.h"
 #include "data/PointLight.h"
 #include "data/Mesh.h"
+#include "data/Sphere.h"
+#include "physics/Collision.h"
 #include "data/Texture.h"
+#include "rendering/Camera.h"
 #include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/InstanceBuffer.h"
 #include "rendering/LightTransform.h"
 #include "rendering/MeshBuffer.h"
 #include "rendering/Shader.h"
+#include "rendering/ShadowScheduler.h"
 #include "rendering/VertexLayout.h"
 
 #include <glm/glm.hpp>
 
-struct alignas(16) LightTransformUbo
-{
-        glm::mat4 lightSpaceMatrix;
-        glm::mat4 model;
-};
+#include <algorithm>
 
-struct alignas(16) LightPositionUbo
+struct alignas(16) ShadowLight
 {
-        glm::vec3 lightPosition;
-        float _padding;
+        glm::vec4 positionAndFarPlane;
+        glm::mat4 faceMatrices[6];
+        int cubeIndex;
+        int faceMask;
+        int _padding[2];
 };
 
-struct alignas(16) FarPlaneUbo
+constexpr auto maxShadowedPointLights = 64;
+constexpr auto maxShadowLightsPerBatch = 16;
+constexpr auto defaultShadowFaceBudget = 48;
+constexpr auto shadowMapWidth = 512;
+constexpr auto shadowMapHeight = 512;
+
+struct alignas(16) PointLightShadowUbo
 {
-        float farPlane;
-        float _padding[3];
+        ShadowLight lights[maxShadowLightsPerBatch];
 };
 
-constexpr auto maxPointLights = 8;
-constexpr auto shadowMapWidth = 2048;
-constexpr auto shadowMapHeight = 2048;
-
 PointLightShadowRenderPass::PointLightShadowRenderPass()
  : RenderPass()
 {
     const auto shaderDir = GetShaderDir();
     const auto vsPath = shaderDir / "mesh_pointlight_shadow_vertex.glsl";
+    const auto gsPath = shaderDir / "mesh_pointlight_shadow_geometry.glsl";
     const auto fsPath = shaderDir / "mesh_pointlight_shadow_fragment.glsl";
 
-    m_shader = std::make_unique<Shader>(vsPath, fsPath);
-    m_shader->registerUniformBuffer("LightTransformBlock", sizeof(LightTransformUbo), 0);
-    m_shader->registerUniformBuffer("LightPositionBlock", sizeof(LightPositionUbo), 1);
-    m_shader->registerUniformBuffer("FarPlaneBlock", sizeof(FarPlaneUbo), 2);
+    m_shader = std::make_unique<Shader>(vsPath, gsPath, fsPath);
+    m_shadowBlock = m_shader->registerUniformBuffer("PointLightShadowBlock", sizeof(PointLightShadowUbo), 1);
+    m_instanceSlot = m_shader->registerStorageBuffer("InstanceBuffer", 3);
 
     m_framebuffer = std::make_unique<Framebuffer>();
     m_framebuffer->setDrawBuffer(GL_NONE);
     m_framebuffer->setReadBuffer(GL_NONE);
 
     m_vertexLayout = std::make_unique<VertexLayout>();
-    m_vertexLayout->registerAttribute(0, 3, GL_FLOAT, offsetof(Vertex, position));
-    m_vertexLayout->registerAttribute(1, 2, GL_FLOAT, offsetof(Vertex, textureUV));
-    m_vertexLayout->registerAttribute(2, 3, GL_FLOAT, offsetof(Vertex, normal));
 
-    m_pointLightDepthImage = std::make_unique<TextureCubeMapArray>(GL_DEPTH_COMPONENT24, shadowMapWidth, shadowMapHeight, 6 * maxPointLights);
+    m_pointLightDepthImage = std::make_unique<TextureCubeMapArray>(GL_DEPTH_COMPONENT16, shadowMapWidth, shadowMapHeight, 6 * maxShadowedPointLights);
     m_pointLightDepthImage->setMinFilter(GL_LINEAR);
     m_pointLightDepthImage->setMagFilter(GL_LINEAR);
     m_pointLightDepthImage->setWrapS(GL_CLAMP_TO_EDGE);
     m_pointLightDepthImage->setWrapT(GL_CLAMP_TO_EDGE);
     m_pointLightDepthImage->setWrapR(GL_CLAMP_TO_EDGE);
+
+    m_shadowScheduler = std::make_unique<ShadowScheduler>(maxShadowedPointLights, defaultShadowFaceBudget);
+    m_shadowCache.resize(maxShadowedPointLights);
 }
 
 PointLightShadowRenderPass::~PointLightShadowRenderPass() = default;
@@ -76,59 +82,179 @@ void PointLightShadowRenderPass::execute(const std::vector<DrawCommand>& drawQue
                                const std::vector<PointLight>& pointLights,
                                const MeshBuffer& buffer)
 {
+    // Casters are found here rather than by a GpuCuller. The cache needs each cube's caster list on the CPU to
+    // tell whether the cube is stale, and a caster is drawn instanced across its batch's lights, which the
+    // culler's one instance commands cannot express
+    auto casterBounds = std::vector<Box>{};
+    casterBounds.reserve(drawQueue.size());
+    for (const auto& drawCommand : drawQueue)
+    {
+        auto bounds = drawCommand.mesh->boundingBox;
+        bounds.transform(drawCommand.transform);
+        casterBounds.push_back(bounds);
+    }
+
+    // Give each shadowed light a cube, and mark the cubes whose light or casters changed as stale
+    m_lightShadowIndices.assign(pointLights.size(), -1);
+
+    auto requests = std::vector<ShadowScheduler::Request>{};
+    auto requestLights = std::vector<size_t>(maxShadowedPointLights);
+    auto shadowIndex = 0;
+
+    for (size_t lightIndex = 0; lightIndex < pointLights.size() && shadowIndex < maxShadowedPointLights; ++lightIndex)
+    {
+        const auto& light = pointLights[lightIndex];
+        if (!light.castShadows)
+        {
+            continue;
+        }
+
+        const auto range = getPointLightRange(light.radius);
+        const auto lightBounds = Sphere{light.position, range};
+
+        auto casters = std::vector<ShadowCaster>{};
+        for (size_t i = 0; i < drawQueue.size(); ++i)
+        {
+            if (collision::intersects(lightBounds, casterBounds[i]))
+            {
+                casters.push_back({drawQueue[i].mesh, drawQueue[i].transform});
+            }
+        }
+
+        m_lightShadowIndices[lightIndex] = shadowIndex;
+        requestLights[shadowIndex] = lightIndex;
+
+        // Rough angular size of the light's influence, which is all the scheduler needs to rank lights
+        const auto distanceToCamera = glm::length(light.position - camera.position);
+        const auto screenSize = distanceToCamera <= light.radius ? 1.0f : std::min(1.0f, light.radius / distanceToCamera);
+        requests.push_back({shadowIndex, screenSize});
+
+        auto& cacheEntry = m_shadowCache[shadowIndex];
+        ++shadowIndex;
+
+        if (cacheEntry.valid && cacheEntry.lightPosition == light.position && cacheEntry.range == range && cacheEntry.casters == casters)
+        {
+            continue;
+        }
+
+        cacheEntry.valid = true;
+        cacheEntry.lightPosition = light.position;
+        cacheEntry.range = range;
+        cacheEntry.casters = std::move(casters);
+
+        m_shadowScheduler->invalidate(shadowIndex - 1);
+    }
+
+    // Unused cubes may be handed to a different light next frame
+    for (auto i = shadowIndex; i < maxShadowedPointLights; ++i)
+    {
+        m_shadowCache[i].valid = false;
+    }
+
+    const auto& decisions = m_shadowScheduler->schedule(requests);
+    if (decisions.empty())
+    {
+        return;
+    }
+
     m_shader->bind();
     m_framebuffer->bind();
 
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, false);
+    glState.setEnabled(GL_DEPTH_TEST, true);
+    glState.setDepthFunc(GL_LESS);
+    glState.setDepthMask(true);
+
+    // Attaching the whole array makes the framebuffer layered, so the geometry shader picks the cube and face with gl_Layer
+    m_framebuffer->attachTexture(GL_DEPTH_ATTACHMENT, *m_pointLightDepthImage.get(), 0);
+    glState.setViewport(0, 0, shadowMapWidth, shadowMapHeight);
 
-    const float farPlane = 50.0f;
+    m_vertexLayout->bind();
+    buffer.bindPositionsToVertexLayout(*m_vertexLayout);
+    // A divisor past the batch size keeps every light's copy of a caster on the caster's instance
+    m_inputs.instances->bindToVertexLayout(*m_vertexLayout, maxShadowLightsPerBatch);
+    m_shader->bindStorageBuffer(m_instanceSlot, m_inputs.instances->instanceBufferHandle());
 
-    auto lightIndex = 0;
-    for (const auto& light : pointLights)
+    const auto clearDepth = 1.0f;
+
+    // Scheduled lights are drawn in batches, instance i of a batch renders the scheduled faces of its i-th light
+    for (size_t batchStart = 0; batchStart < decisions.size(); batchStart += maxShadowLightsPerBatch)
     {
-        const auto lightTransforms = getPointLightShadowTransforms(light.position, farPlane);
+        const auto batchSize = std::min(decisions.size() - batchStart, static_cast<size_t>(maxShadowLightsPerBatch));
+
+        auto pointLightShadowUbo = PointLightShadowUbo{};
+        auto batchBounds = std::vector<Sphere>{};
 
-        for (auto i = 0; i < 6; ++i)
+        for (size_t i = 0; i < batchSize; ++i)
         {
-            m_framebuffer->attachTextureLayer(GL_DEPTH_ATTACHMENT, *m_pointLightDepthImage.get(), 0, (6 * lightIndex) + i);
-            glViewport(0, 0, shadowMapWidth, shadowMapHeight);
-            glClear(GL_DEPTH_BUFFER_BIT);
+            const auto& decision = decisions[batchStart + i];
+            const auto& light = pointLights[requestLights[decision.shadowIndex]];
+            const auto range = getPointLightRange(light.radius);
+            const auto lightTransforms = getPointLightShadowTransforms(light.position, range);
 
+            auto& shadowLight = pointLightShadowUbo.lights[i];
+            shadowLight.positionAndFarPlane = glm::vec4{light.position, range};
+            shadowLight.cubeIndex = decision.shadowIndex;
+            shadowLight.faceMask = static_cast<int>(decision.faceMask);
+            std::copy(lightTransforms.begin(), lightTransforms.end(), shadowLight.faceMatrices);
 
-            const auto lightPosUbo = LightPositionUbo{.lightPosition = light.position};
-            m_shader->writeUniformData("LightPositionBlock", sizeof(LightPositionUbo), &lightPosUbo);
+            for (auto face = 0; face < 6; ++face)
+            {
+                if (decision.faceMask & (1u << face))
+                {
+                    const auto layer = (6 * decision.shadowIndex) + face;
+                    glClearTexSubImage(m_pointLightDepthImage->handle(), 0, 0, 0, layer, shadowMapWidth, shadowMapHeight, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+                }
+            }
 
-            const auto farPlaneUbo = FarPlaneUbo{.farPlane = farPlane};
-            m_shader->writeUniformData("FarPlaneBlock", sizeof(FarPlaneUbo), &farPlaneUbo);
+            batchBounds.emplace_back(light.position, range);
+        }
+        m_shader->writeUniformData(m_shadowBlock, sizeof(PointLightShadowUbo), &pointLightShadowUbo);
 
-            for (const auto& drawCommand : drawQueue)
+        // Each caster is submitted once per batch, instanced across its lights and expanded to the scheduled faces in the geometry shader
+        for (size_t i = 0; i < drawQueue.size(); ++i)
+        {
+            const auto& drawCommand = drawQueue[i];
+
+            const auto affectsBatch = std::any_of(batchBounds.begin(), batchBounds.end(), [&](const Sphere& bounds) {
+                return collision::intersects(bounds, casterBounds[i]);
+            });
+            if (!affectsBatch)
             {
-                const auto indexCount = drawCommand.mesh->indices.size();
-                const auto indexOffset = buffer.indexOffsetOfMesh(drawCommand.mesh);
-                const auto vertexOffset = buffer.vertexOffsetOfMesh(drawCommand.mesh);
-
-                auto pointLightTransformUbo = LightTransformUbo{};
-                pointLightTransformUbo.lightSpaceMatrix = lightTransforms.at(i);
-                pointLightTransformUbo.model = drawCommand.transform;
-                m_shader->writeUniformData("LightTransformBlock", sizeof(LightTransformUbo), &pointLightTransformUbo);
-
-                glDrawElementsBaseVertex(
-                    GL_TRIANGLES,
-                    static_cast<GLsizei>(indexCount),
-                    GL_UNSIGNED_INT,
-                    reinterpret_cast<const void*>(indexOffset * sizeof(GLuint)),
-                    vertexOffset);
+                continue;
             }
-            
+
+            const auto& gpuMesh = drawCommand.gpuMesh;
+
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                GL_TRIANGLES,
+                gpuMesh.indexCount,
+                gpuMesh.indexType,
+                gpuMesh.indexPointer(),
+                static_cast<GLsizei>(batchSize),
+                gpuMesh.baseVertex,
+                static_cast<GLuint>(i));
         }
-        ++lightIndex;
     }
 }
 
+void PointLightShadowRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
 TextureCubeMapArray* PointLightShadowRenderPass::pointLightShadowMapImage() const
 {
     return m_pointLightDepthImage.get();
 }
+
+const std::vector<int>& PointLightShadowRenderPass::lightShadowIndices() const
+{
+    return m_lightShadowIndices;
+}
+
+ShadowScheduler& PointLightShadowRenderPass::shadowScheduler() const
+{
+    return *m_shadowScheduler;
+}
@@ -4,18 +4,29 @@
 #pragma once
 
 #include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glm/glm.hpp>
 
 #include <memory>
+#include <vector>
 
 class Framebuffer;
+class InstanceBuffer;
+class Mesh;
 class MeshBuffer;
-class Shader;
+class ShadowScheduler;
 class TextureCubeMapArray;
 class VertexLayout;
 
 class PointLightShadowRenderPass : public RenderPass
 {
     public:
+        struct Inputs
+        {
+            const InstanceBuffer* instances;
+        };
+
         PointLightShadowRenderPass();
         ~PointLightShadowRenderPass() override;   
 
@@ -25,11 +36,43 @@ class PointLightShadowRenderPass : public RenderPass
                      const std::vector<PointLight>& pointLights,
                      const MeshBuffer& buffer) override;
 
+        void setInputs(const Inputs& inputs);
+
         TextureCubeMapArray* pointLightShadowMapImage() const;
 
+        // Cube index in the shadow map of each light passed to the last execute, or -1 if the light has no shadow
+        const std::vector<int>& lightShadowIndices() const;
+
+        ShadowScheduler& shadowScheduler() const;
+
+    private:
+        struct ShadowCaster
+        {
+            Mesh* mesh;
+            glm::mat4 transform;
+
+            bool operator==(const ShadowCaster& other) const = default;
+        };
+
+        // What a cube was last rendered with, so it is only re-rendered when the light or its casters change
+        struct ShadowCacheEntry
+        {
+            bool valid{false};
+            glm::vec3 lightPosition{0.0f};
+            float range{0.0f};
+            std::vector<ShadowCaster> casters;
+        };
+
     private:
         std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_shadowBlock{};
+        StorageBufferSlot m_instanceSlot{};
         std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
         std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
         std::unique_ptr<TextureCubeMapArray> m_pointLightDepthImage{nullptr};
+        std::unique_ptr<ShadowScheduler> m_shadowScheduler{nullptr};
+        std::vector<ShadowCacheEntry> m_shadowCache;
+        std::vector<int> m_lightShadowIndices;
+
+        Inputs m_inputs{};
 };
@@ -0,0 +1,251 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "PointLightVolumeRenderPass.h"
+
+#include "core/FileSystem.h"
+#include "data/Texture.h"
+#include "rendering/Camera.h"
+#include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
+#include "rendering/Shader.h"
+#include "rendering/VertexLayout.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+constexpr auto volumeSegments = 12;
+constexpr auto volumeRings = 8;
+
+// One bit of the 8-bit stencil per light
+constexpr auto lightsPerStencilBatch = uint32_t{8};
+
+constexpr auto lightIndexStream = 1;
+constexpr auto lightIndexAttribute = 1;
+
+struct alignas(16) VolumeUbo
+{
+        glm::mat4 projection;
+        glm::mat4 view;
+        glm::mat4 inverseViewProjection;
+        glm::vec4 screenSize;
+};
+
+// Low-poly unit sphere with its faces pushed out to enclose the true sphere, so no lit pixel is clipped at the edges
+void buildVolumeSphere(std::vector<float>& vertices, std::vector<GLuint>& indices)
+{
+    const auto pi = glm::pi<float>();
+    const auto scale = 1.0f / (std::cos(pi / volumeSegments) * std::cos(pi / (2.0f * volumeRings)));
+
+    for (auto ring = 0; ring <= volumeRings; ++ring)
+    {
+        const auto phi = pi * static_cast<float>(ring) / volumeRings;
+        for (auto segment = 0; segment <= volumeSegments; ++segment)
+        {
+            const auto theta = 2.0f * pi * static_cast<float>(segment) / volumeSegments;
+            vertices.push_back(scale * std::sin(phi) * std::cos(theta));
+            vertices.push_back(scale * std::cos(phi));
+            vertices.push_back(scale * std::sin(phi) * std::sin(theta));
+        }
+    }
+
+    // Wound counter-clockwise seen from outside
+    for (auto ring = 0; ring < volumeRings; ++ring)
+    {
+        for (auto segment = 0; segment < volumeSegments; ++segment)
+        {
+            const auto a = static_cast<GLuint>(ring * (volumeSegments + 1) + segment);
+            const auto b = a + volumeSegments + 1;
+            const auto c = b + 1;
+            const auto d = a + 1;
+            indices.insert(indices.end(), {a, c, b, a, d, c});
+        }
+    }
+}
+
+PointLightVolumeRenderPass::PointLightVolumeRenderPass()
+    : RenderPass()
+{
+    const auto shaderDir = GetShaderDir();
+    const auto vsPath = shaderDir / "lighting_volume_vertex.glsl";
+    const auto stencilFsPath = shaderDir / "lighting_volume_stencil_fragment.glsl";
+    const auto fsPath = shaderDir / "lighting_volume_fragment.glsl";
+
+    m_stencilShader = std::make_unique<Shader>(vsPath, stencilFsPath);
+    m_stencilSlots.volumeBlock = m_stencilShader->registerUniformBuffer("VolumeBlock", sizeof(VolumeUbo), 4);
+    m_stencilSlots.lightBuffer = m_stencilShader->registerStorageBuffer("LightBuffer", 0);
+
+    m_shader = std::make_unique<Shader>(vsPath, fsPath);
+    m_slots.colorTexture = m_shader->registerTextureSampler("colorTexture", 0);
+    m_slots.normalTexture = m_shader->registerTextureSampler("normalTexture", 1);
+    m_slots.depthTexture = m_shader->registerTextureSampler("depthTexture", 2);
+    m_slots.pointLightShadowMap = m_shader->registerTextureSampler("pointLightShadowMap", 3);
+    m_slots.volumeBlock = m_shader->registerUniformBuffer("VolumeBlock", sizeof(VolumeUbo), 4);
+    m_slots.lightBuffer = m_shader->registerStorageBuffer("LightBuffer", 0);
+
+    m_framebuffer = std::make_unique<Framebuffer>();
+    m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0});
+
+    auto vertices = std::vector<float>{};
+    auto indices = std::vector<GLuint>{};
+    buildVolumeSphere(vertices, indices);
+    m_indexCount = static_cast<GLsizei>(indices.size());
+
+    m_vertexBuffer = std::make_unique<Buffer<float>>(vertices);
+    m_indexBuffer = std::make_unique<Buffer<GLuint>>(indices);
+
+    m_vertexLayout = std::make_unique<VertexLayout>();
+    m_vertexLayout->registerAttribute(0, 3, GL_FLOAT, 0);
+    m_vertexLayout->bindVertexBuffer(0, m_vertexBuffer->handle(), 0, 3 * sizeof(float));
+    m_vertexLayout->bindElementBuffer(m_indexBuffer->handle());
+
+    m_vertexLayout->registerAttribute(lightIndexAttribute, 1, GL_UNSIGNED_INT, 0, lightIndexStream, AttributeFormat::Integer);
+    m_vertexLayout->setBindingDivisor(lightIndexStream, 1);
+}
+
+PointLightVolumeRenderPass::~PointLightVolumeRenderPass() = default;
+
+void PointLightVolumeRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
+                                         const Camera& camera,
+                                         const DirectionalLight& directionalLight,
+                                         const std::vector<PointLight>& pointLights,
+                                         const MeshBuffer& buffer)
+{
+    if (m_inputs.lightCount == 0)
+    {
+        return;
+    }
+
+    m_framebuffer->bind();
+
+    auto& glState = GlStateCache::instance();
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    m_vertexLayout->bind();
+
+    auto volumeUbo = VolumeUbo{};
+    volumeUbo.projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
+    volumeUbo.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+    volumeUbo.inverseViewProjection = glm::inverse(volumeUbo.projection * volumeUbo.view);
+    volumeUbo.screenSize = glm::vec4{m_viewportWidth, m_viewportHeight, 0.0f, 0.0f};
+
+    reserveLightIndices(m_inputs.lightCount);
+
+    // Both shaders keep their own block, rebound with the shader for each batch
+    m_stencilShader->bind();
+    m_stencilShader->writeUniformData(m_stencilSlots.volumeBlock, sizeof(VolumeUbo), &volumeUbo);
+    m_stencilShader->bindStorageBuffer(m_stencilSlots.lightBuffer, m_inputs.lightBuffer);
+
+    m_shader->bind();
+    m_shader->writeUniformData(m_slots.volumeBlock, sizeof(VolumeUbo), &volumeUbo);
+    m_shader->bindStorageBuffer(m_slots.lightBuffer, m_inputs.lightBuffer);
+    m_shader->bindTexture(m_slots.colorTexture, m_inputs.colorImage);
+    m_shader->bindTexture(m_slots.normalTexture, m_inputs.normalImage);
+    m_shader->bindTexture(m_slots.depthTexture, m_inputs.depthImage);
+    m_shader->bindTexture(m_slots.pointLightShadowMap, m_inputs.pointLightShadowMapImage);
+
+    glState.setEnabled(GL_STENCIL_TEST, true);
+
+    const auto drawVolume = [this](uint32_t light) {
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr, 1, light);
+    };
+
+    for (auto batchStart = uint32_t{0}; batchStart < m_inputs.lightCount; batchStart += lightsPerStencilBatch)
+    {
+        const auto batchEnd = std::min(batchStart + lightsPerStencilBatch, m_inputs.lightCount);
+
+        // Each light flips its bit wherever a face of its volume is behind the surface. Only a surface inside
+        // the volume has one face behind it and one in front, so only it is left set. With the camera inside,
+        // the near plane clips the front faces and the back face alone still marks it
+        glState.setStencilMask(0xff);
+        const auto clearStencil = GLint{0};
+        glClearNamedFramebufferiv(m_framebuffer->handle(), GL_STENCIL, 0, &clearStencil);
+
+        m_stencilShader->bind();
+        glState.setEnabled(GL_BLEND, false);
+        glState.setEnabled(GL_CULL_FACE, false);
+        glState.setEnabled(GL_DEPTH_TEST, true);
+        glState.setDepthFunc(GL_LESS);
+        glState.setDepthMask(false);
+        glState.setColorMask(false);
+        glState.setStencilFunc(GL_ALWAYS, 0, 0xff);
+        glState.setStencilOpSeparate(GL_FRONT_AND_BACK, GL_KEEP, GL_INVERT, GL_KEEP);
+
+        for (auto light = batchStart; light < batchEnd; ++light)
+        {
+            glState.setStencilMask(1u << (light - batchStart));
+            drawVolume(light);
+        }
+
+        // The shading draws sample depth from the texture they test against. Nothing writes it from here on,
+        // but the stencil just written shares its texels, so make those writes visible before sampling
+        glTextureBarrier();
+
+        // Shade from the back faces, so a volume still covers its pixels when the camera is inside it.
+        // Each light only passes the stencil where its own bit is set
+        m_shader->bind();
+        glState.setStencilMask(0);
+        glState.setColorMask(true);
+        glState.setEnabled(GL_CULL_FACE, true);
+        glState.setCullFace(GL_FRONT);
+        glState.setDepthFunc(GL_GEQUAL);
+        glState.setStencilOpSeparate(GL_FRONT_AND_BACK, GL_KEEP, GL_KEEP, GL_KEEP);
+        glState.setEnabled(GL_BLEND, true);
+        glState.setBlendFunc(GL_ONE, GL_ONE, GL_ZERO, GL_ONE);
+
+        for (auto light = batchStart; light < batchEnd; ++light)
+        {
+            const auto bit = 1u << (light - batchStart);
+            glState.setStencilFunc(GL_EQUAL, static_cast<GLint>(bit), bit);
+            drawVolume(light);
+        }
+    }
+
+    glState.setStencilMask(0xff);
+    glState.setEnabled(GL_STENCIL_TEST, false);
+    glState.setEnabled(GL_CULL_FACE, false);
+}
+
+void PointLightVolumeRenderPass::reserveLightIndices(uint32_t lightCount)
+{
+    if (lightCount <= m_lightIndexCapacity)
+    {
+        return;
+    }
+
+    auto capacity = std::max(m_lightIndexCapacity, lightsPerStencilBatch);
+    while (capacity < lightCount)
+    {
+        capacity *= 2;
+    }
+
+    auto lightIndices = std::vector<GLuint>(capacity);
+    std::iota(lightIndices.begin(), lightIndices.end(), 0u);
+
+    m_lightIndexBuffer = std::make_unique<Buffer<GLuint>>(lightIndices);
+    m_vertexLayout->bindVertexBuffer(lightIndexStream, m_lightIndexBuffer->handle(), 0, sizeof(GLuint));
+    m_lightIndexCapacity = capacity;
+}
+
+void PointLightVolumeRenderPass::onViewportResize(GLuint width, GLuint height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+
+    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+}
+
+void PointLightVolumeRenderPass::setInputs(const Inputs& inputs)
+{
+    m_inputs = inputs;
+}
+
+void PointLightVolumeRenderPass::setOutputs(const Outputs& outputs)
+{
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *outputs.colorImage, 0);
+    m_framebuffer->attachTexture(GL_DEPTH_STENCIL_ATTACHMENT, *outputs.depthStencilImage, 0);
+}
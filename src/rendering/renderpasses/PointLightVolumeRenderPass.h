@@ -0,0 +1,93 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "rendering/Buffer.h"
+#include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Framebuffer;
+class MeshBuffer;
+class Texture2D;
+class TextureCubeMapArray;
+class VertexLayout;
+
+// Adds the point lights to the lit scene by drawing a sphere per light over the G-buffer. Lights go in
+// batches of eight, each marking the pixels whose surface lies inside its volume in its own stencil bit,
+// so each light's shading draw only runs on its own pixels, however much the lights overlap
+class PointLightVolumeRenderPass : public RenderPass
+{
+    public:
+        struct Inputs
+        {
+            Texture2D* colorImage;
+            Texture2D* normalImage;
+            Texture2D* depthImage;
+            TextureCubeMapArray* pointLightShadowMapImage;
+            GLuint lightBuffer;
+            uint32_t lightCount;
+        };
+
+        struct Outputs
+        {
+            Texture2D* colorImage;
+            Texture2D* depthStencilImage;
+        };
+
+        PointLightVolumeRenderPass();
+        ~PointLightVolumeRenderPass() override;
+
+        void execute(const std::vector<DrawCommand>& drawQueue,
+                     const Camera& camera,
+                     const DirectionalLight& directionalLight,
+                     const std::vector<PointLight>& pointLights,
+                     const MeshBuffer& buffer) override;
+
+        void onViewportResize(GLuint width, GLuint height);
+
+        void setInputs(const Inputs& inputs);
+        void setOutputs(const Outputs& outputs);
+
+    private:
+        // Regrows the buffer of light indices the volumes find their light through
+        void reserveLightIndices(uint32_t lightCount);
+
+    private:
+        struct ShaderSlots
+        {
+            UniformBufferSlot volumeBlock{};
+            StorageBufferSlot lightBuffer{};
+            TextureSlot colorTexture{};
+            TextureSlot normalTexture{};
+            TextureSlot depthTexture{};
+            TextureSlot pointLightShadowMap{};
+        };
+
+    private:
+        std::unique_ptr<Shader> m_stencilShader{nullptr};
+        std::unique_ptr<Shader> m_shader{nullptr};
+        // The stencil shader samples nothing, so only its block and light buffer are set
+        ShaderSlots m_stencilSlots{};
+        ShaderSlots m_slots{};
+        std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
+        std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
+        std::unique_ptr<Buffer<float>> m_vertexBuffer{nullptr};
+        std::unique_ptr<Buffer<GLuint>> m_indexBuffer{nullptr};
+        // 0, 1, 2... read once per instance, so a draw of one volume picks its light with the base instance
+        std::unique_ptr<Buffer<GLuint>> m_lightIndexBuffer{nullptr};
+        uint32_t m_lightIndexCapacity{0};
+        GLsizei m_indexCount{0};
+
+        Inputs m_inputs{};
+
+        GLuint m_viewportWidth{0};
+        GLuint m_viewportHeight{0};
+        float m_aspectRatio{1.0f};
+};
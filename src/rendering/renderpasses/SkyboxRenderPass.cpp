@@ -9,6 +9,7 @@
 #include "data/Texture.h"
 #include "rendering/Camera.h"
 #include "rendering/Framebuffer.h"
+#include "rendering/GlStateCache.h"
 #include "rendering/MeshBuffer.h"
 #include "rendering/Shader.h"
 #include "rendering/VertexLayout.h"
@@ -35,8 +36,8 @@ SkyboxRenderPass::SkyboxRenderPass()
     const auto fsPath = shaderDir / "skybox_fragment.glsl";
 
     m_shader = std::make_unique<Shader>(vsPath, fsPath);
-    m_shader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
-    m_shader->registerTextureSampler("skyboxTexture", 1);
+    m_transformBlock = m_shader->registerUniformBuffer("TransformBlock", sizeof(TransformUbo), 0);
+    m_skyboxTexture = m_shader->registerTextureSampler("skyboxTexture", 1);
 
     m_framebuffer = std::make_unique<Framebuffer>();
     m_framebuffer->setDrawBuffers({GL_COLOR_ATTACHMENT0});
@@ -66,26 +67,26 @@ void SkyboxRenderPass::execute(const std::vector<DrawCommand>& drawQueue,
     m_shader->bind();
     m_framebuffer->bind();
 
-    const auto inputs = m_inputBinding();
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *inputs.targetImage, 0);
+    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *m_inputs.targetImage, 0);
 
-    m_shader->bindTexture("skyboxTexture", camera.skybox.value()->cubemapTexture.get());
+    m_shader->bindTexture(m_skyboxTexture, camera.skybox.value()->cubemapTexture.get());
 
-    glEnable(GL_BLEND);
-    glBlendFuncSeparate(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+    auto& glState = GlStateCache::instance();
+    glState.setEnabled(GL_BLEND, true);
+    glState.setBlendFunc(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA, GL_ONE, GL_ZERO);
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LEQUAL);
-    glDepthMask(GL_FALSE);
+    glState.setEnabled(GL_DEPTH_TEST, false);
+    glState.setDepthFunc(GL_LEQUAL);
+    glState.setDepthMask(false);
 
-    glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    glState.setViewport(0, 0, m_viewportWidth, m_viewportHeight);
     m_vertexLayout->bind();
 
     auto transformUbo = TransformUbo{};
     transformUbo.projection = glm::perspective(camera.fieldOfView, m_aspectRatio, camera.nearPlane, camera.farPlane);
     transformUbo.view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
 
-    m_shader->writeUniformData("TransformBlock", sizeof(TransformUbo), &transformUbo);
+    m_shader->writeUniformData(m_transformBlock, sizeof(TransformUbo), &transformUbo);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
@@ -96,30 +97,9 @@ void SkyboxRenderPass::onViewportResize(GLuint width, GLuint height)
     m_viewportHeight = height;
 
     m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
-
-    rebuildImages();
-}
-
-void SkyboxRenderPass::setInputBinding(InputBinding binding)
-{
-    m_inputBinding = std::move(binding);
 }
 
-Texture2D* SkyboxRenderPass::colorImage() const
+void SkyboxRenderPass::setInputs(const Inputs& inputs)
 {
-    return m_colorImage.get();
-}
-
-GLuint SkyboxRenderPass::framebufferHandle() const
-{
-    return m_framebuffer->handle();
-}
-
-void SkyboxRenderPass::rebuildImages()
-{
-    m_colorImage = std::make_unique<Texture2D>(GL_RGBA8, m_viewportWidth, m_viewportHeight);
-    m_colorImage->setMinFilter(GL_LINEAR);
-    m_colorImage->setMagFilter(GL_LINEAR);
-
-    m_framebuffer->attachTexture(GL_COLOR_ATTACHMENT0, *m_colorImage.get(), 0);
+    m_inputs = inputs;
 }
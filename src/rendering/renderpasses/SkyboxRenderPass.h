@@ -6,15 +6,14 @@
 #include "core/Vertex.h"
 #include "rendering/Buffer.h"
 #include "rendering/RenderPass.h"
+#include "rendering/Shader.h"
 
 #include <glad/gl.h>
 
-#include <functional>
 #include <memory>
 
 class Framebuffer;
 class MeshBuffer;
-class Shader;
 class Texture2D;
 class VertexLayout;
 
@@ -26,8 +25,6 @@ class SkyboxRenderPass : public RenderPass
             Texture2D* targetImage;
         };
 
-        using InputBinding = std::function<Inputs(void)>; 
-
         SkyboxRenderPass();
         ~SkyboxRenderPass() override;   
 
@@ -39,23 +36,17 @@ class SkyboxRenderPass : public RenderPass
 
         void onViewportResize(GLuint width, GLuint height); 
 
-        void setInputBinding(InputBinding binding);
-
-        Texture2D* colorImage() const;
-
-        GLuint framebufferHandle() const;
-
-    private:
-        void rebuildImages();
+        void setInputs(const Inputs& inputs);
 
     private:
         std::unique_ptr<Shader> m_shader{nullptr};
+        UniformBufferSlot m_transformBlock{};
+        TextureSlot m_skyboxTexture{};
         std::unique_ptr<Framebuffer> m_framebuffer{nullptr};
         std::unique_ptr<VertexLayout> m_vertexLayout{nullptr};
-        std::unique_ptr<Texture2D> m_colorImage{nullptr};
         std::unique_ptr<Buffer<float>> m_vertexBuffer{nullptr};
 
-        InputBinding m_inputBinding;
+        Inputs m_inputs{};
 
         GLuint m_viewportWidth{0};
         GLuint m_viewportHeight{0};
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "Terrain.h"
+
+#include "data/Material.h"
+#include "data/Mesh.h"
+#include "loaders/HeightmapStreamer.h"
+#include "rendering/LightTransform.h"
+#include "rendering/Renderer.h"
+#include "world/TerrainQuadtree.h"
+#include "world/components/TerrainComponent.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+// Streamed chunks kept at most, whether drawn or cached for when the camera comes back
+constexpr size_t maxResidentTerrainChunks = 512;
+
+// Whether the box is wholly behind one of the planes, testing only its corner furthest along the plane's normal
+bool isBoxOutsideFrustum(const std::array<glm::vec4, 6>& planes, const Box& box)
+{
+    for(const auto& plane : planes)
+    {
+        const auto corner = glm::vec3{plane.x >= 0.0f ? box.max().x : box.min().x,
+                                      plane.y >= 0.0f ? box.max().y : box.min().y,
+                                      plane.z >= 0.0f ? box.max().z : box.min().z};
+        if(glm::dot(glm::vec3{plane}, corner) + plane.w < 0.0f)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Terrain::Terrain(const TerrainComponent& component, Renderer& renderer)
+    : m_renderer{renderer}
+    , m_streamer{std::make_unique<HeightmapStreamer>(component.heightmapPath)}
+{
+    m_sampleCount = m_streamer->sampleCount();
+    m_sampleSpacing = component.size / static_cast<float>(m_sampleCount - 1);
+    m_heightScale = component.height / 65535.0f;
+
+    if(m_sampleCount - 1 < TerrainQuadtree::chunkResolution)
+    {
+        throw std::runtime_error("Heightmap " + component.heightmapPath.string() + " is smaller than a terrain chunk");
+    }
+
+    m_quadtree = std::make_unique<TerrainQuadtree>(m_sampleCount, m_sampleSpacing);
+
+    m_material = std::make_unique<Material>();
+    m_material->ambient = component.color;
+    m_material->diffuse = component.color;
+    m_material->specular = glm::vec3{0.0f};
+}
+
+Terrain::~Terrain()
+{
+    for(auto& [key, chunk] : m_chunks)
+    {
+        if(chunk.uploaded)
+        {
+            m_renderer.removeMesh(chunk.mesh.get());
+        }
+    }
+}
+
+void Terrain::update(const glm::mat4& transform, const glm::vec3& cameraPosition)
+{
+    m_frame++;
+    receiveChunks();
+
+    // Selection works in the terrain's own space, where chunk boxes are axis aligned
+    const auto localCamera = glm::vec3{glm::inverse(transform) * glm::vec4{cameraPosition, 1.0f}};
+
+    m_quadtree->select(localCamera, [this](int level, int x, int z) -> const Box* {
+        const auto& chunk = touchChunk(level, x, z);
+        return chunk.mesh ? &chunk.mesh->boundingBox : nullptr;
+    });
+
+    for(const auto key : m_quadtree->selected())
+    {
+        auto& chunk = m_chunks.at(key);
+
+        // Chunks sit in the mesh buffer only once drawn, with indices for the neighbours they have now
+        const auto stitch = m_quadtree->stitch(chunk.level, chunk.x, chunk.z);
+        if(!chunk.uploaded || chunk.stitch != stitch)
+        {
+            if(chunk.uploaded)
+            {
+                m_renderer.removeMesh(chunk.mesh.get());
+            }
+
+            // A full mesh buffer leaves the chunk out until a later frame finds room for it
+            chunk.mesh->indices = m_quadtree->stitchedIndices(stitch);
+            chunk.stitch = stitch;
+            chunk.uploaded = m_renderer.addMesh(chunk.mesh.get());
+        }
+    }
+
+    evictChunks();
+}
+
+void Terrain::queueDraws(const glm::mat4& transform, const glm::mat4& viewProjection) const
+{
+    const auto frustum = getFrustumPlanes(viewProjection);
+
+    for(const auto key : m_quadtree->selected())
+    {
+        const auto& chunk = m_chunks.at(key);
+        if(!chunk.uploaded)
+        {
+            continue;
+        }
+
+        // Chunks out of view still cast shadows into it
+        auto worldBox = chunk.mesh->boundingBox;
+        worldBox.transform(transform);
+
+        auto command = DrawCommand{};
+        command.mesh = chunk.mesh.get();
+        command.transform = transform;
+        command.hiddenFromCamera = isBoxOutsideFrustum(frustum, worldBox);
+        m_renderer.queueDrawCommand(command);
+    }
+}
+
+size_t Terrain::drawnChunkCount() const
+{
+    return m_quadtree->selected().size();
+}
+
+Terrain::Chunk& Terrain::touchChunk(int level, int x, int z)
+{
+    const auto key = TerrainQuadtree::chunkKey(level, x, z);
+    auto [entry, inserted] = m_chunks.try_emplace(key);
+    auto& chunk = entry->second;
+
+    if(inserted)
+    {
+        chunk.level = level;
+        chunk.x = x;
+        chunk.z = z;
+
+        // A sample of border all round, so normals at the edges see past them
+        const auto intervals = m_quadtree->chunkIntervals(level);
+        const auto step = intervals / TerrainQuadtree::chunkResolution;
+        m_streamer->request(key, x * intervals - step, z * intervals - step, step, TerrainQuadtree::chunkResolution + 3);
+    }
+
+    chunk.lastUsedFrame = m_frame;
+    return chunk;
+}
+
+void Terrain::receiveChunks()
+{
+    for(const auto& region : m_streamer->takeCompleted())
+    {
+        if(auto chunk = m_chunks.find(region.key); chunk != m_chunks.end())
+        {
+            buildChunkMesh(chunk->second, region);
+        }
+    }
+}
+
+void Terrain::buildChunkMesh(Chunk& chunk, const HeightmapRegion& region)
+{
+    const auto height = [&](int i, int j) {
+        return static_cast<float>(region.samples[static_cast<size_t>(j + 1) * region.count + (i + 1)]) * m_heightScale;
+    };
+
+    constexpr auto chunkResolution = TerrainQuadtree::chunkResolution;
+
+    auto mesh = std::make_unique<Mesh>();
+    mesh->material = m_material.get();
+    mesh->vertices.reserve(static_cast<size_t>(chunkResolution + 1) * (chunkResolution + 1));
+
+    const auto texelScale = 1.0f / static_cast<float>(m_sampleCount - 1);
+    const auto normalRun = 2.0f * static_cast<float>(region.step) * m_sampleSpacing;
+
+    for(auto j = 0; j <= chunkResolution; ++j)
+    {
+        for(auto i = 0; i <= chunkResolution; ++i)
+        {
+            const auto sampleX = static_cast<float>(region.firstX + (i + 1) * region.step);
+            const auto sampleZ = static_cast<float>(region.firstZ + (j + 1) * region.step);
+
+            auto vertex = Vertex{};
+            vertex.position = glm::vec3{sampleX * m_sampleSpacing, height(i, j), sampleZ * m_sampleSpacing};
+            vertex.normal = glm::normalize(glm::vec3{height(i - 1, j) - height(i + 1, j),
+                                                     normalRun,
+                                                     height(i, j - 1) - height(i, j + 1)});
+            vertex.textureUV = glm::vec2{sampleX, sampleZ} * texelScale;
+            mesh->vertices.push_back(vertex);
+        }
+    }
+
+    mesh->boundingBox = Box::enclose(mesh->vertices);
+    chunk.mesh = std::move(mesh);
+}
+
+void Terrain::evictChunks()
+{
+    if(m_chunks.size() <= maxResidentTerrainChunks)
+    {
+        return;
+    }
+
+    // Chunks still streaming in are left alone, their regions would arrive with nothing to go to
+    auto candidates = std::vector<std::pair<uint64_t, uint64_t>>{};
+    for(const auto& [key, chunk] : m_chunks)
+    {
+        if(chunk.mesh && chunk.lastUsedFrame < m_frame)
+        {
+            candidates.emplace_back(chunk.lastUsedFrame, key);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    const auto excess = m_chunks.size() - maxResidentTerrainChunks;
+    for(size_t i = 0; i < std::min(excess, candidates.size()); ++i)
+    {
+        auto& chunk = m_chunks.at(candidates[i].second);
+        if(chunk.uploaded)
+        {
+            m_renderer.removeMesh(chunk.mesh.get());
+        }
+        m_chunks.erase(candidates[i].second);
+    }
+}
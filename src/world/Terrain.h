@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class HeightmapStreamer;
+class Renderer;
+class TerrainQuadtree;
+struct HeightmapRegion;
+struct Material;
+struct Mesh;
+struct TerrainComponent;
+
+// Heightmap terrain drawn as the chunks a TerrainQuadtree picks. Chunks stream in from disk as the quadtree
+// asks for them and the least recently used are dropped once too many are resident, so memory and triangles
+// stay bounded however large the heightmap is
+class Terrain
+{
+    public:
+        Terrain(const TerrainComponent& component, Renderer& renderer);
+        ~Terrain();
+
+        Terrain(const Terrain& other) = delete;
+        Terrain(Terrain&& other) = delete;
+
+        Terrain& operator=(const Terrain& other) = delete;
+        Terrain& operator=(Terrain&& other) = delete;
+
+        // Picks the chunks to draw for a camera, requests any it is missing and uploads the rest.
+        // Until a chunk's children are resident it is drawn in their place
+        void update(const glm::mat4& transform, const glm::vec3& cameraPosition);
+
+        // Queues the chunks the last update picked and uploaded. Call it once every terrain is updated,
+        // so no draw is queued while the mesh buffer is still changing
+        void queueDraws(const glm::mat4& transform, const glm::mat4& viewProjection) const;
+
+        inline size_t residentChunkCount() const
+        {
+            return m_chunks.size();
+        }
+
+        size_t drawnChunkCount() const;
+
+    private:
+        struct Chunk
+        {
+            int level{0};
+            int x{0};
+            int z{0};
+            // Null until the heights are streamed in
+            std::unique_ptr<Mesh> mesh{nullptr};
+            bool uploaded{false};
+            // Levels the neighbour on each edge is coarser by, which the indices are stitched to
+            uint32_t stitch{0};
+            uint64_t lastUsedFrame{0};
+        };
+
+        Chunk& touchChunk(int level, int x, int z);
+        void receiveChunks();
+        void buildChunkMesh(Chunk& chunk, const HeightmapRegion& region);
+        void evictChunks();
+
+    private:
+        Renderer& m_renderer;
+        std::unique_ptr<HeightmapStreamer> m_streamer{nullptr};
+        std::unique_ptr<TerrainQuadtree> m_quadtree{nullptr};
+        std::unique_ptr<Material> m_material{nullptr};
+
+        int m_sampleCount{0};
+        float m_sampleSpacing{1.0f};
+        float m_heightScale{1.0f};
+
+        std::unordered_map<uint64_t, Chunk> m_chunks;
+        uint64_t m_frame{0};
+};
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TerrainQuadtree.h"
+
+#include "data/Box.h"
+
+#include <algorithm>
+
+// A chunk splits once the camera is within this many of its own widths of it. Neighbouring chunks then
+// rarely differ by more than a level, and stay a similar number of pixels per quad
+constexpr auto terrainSplitDistance = 2.0f;
+
+// Bits per edge in a chunk's stitch, ordered west, east, north, south
+constexpr uint32_t stitchEdgeBits = 4;
+
+TerrainQuadtree::TerrainQuadtree(int sampleCount, float sampleSpacing)
+    : m_sampleCount{sampleCount}
+    , m_sampleSpacing{sampleSpacing}
+{
+    // Levels until a chunk's vertices land on every sample
+    while(chunkIntervals(m_maxLevel) > chunkResolution)
+    {
+        m_maxLevel++;
+    }
+}
+
+uint64_t TerrainQuadtree::chunkKey(int level, int x, int z)
+{
+    return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(x) << 24) | static_cast<uint64_t>(z);
+}
+
+void TerrainQuadtree::select(const glm::vec3& cameraPosition, const ChunkBounds& chunkBounds)
+{
+    m_selected.clear();
+    m_selectedKeys.clear();
+    selectChunks(0, 0, 0, cameraPosition, chunkBounds);
+    m_selectedKeys.insert(m_selected.begin(), m_selected.end());
+}
+
+void TerrainQuadtree::selectChunks(int level, int x, int z, const glm::vec3& cameraPosition, const ChunkBounds& chunkBounds)
+{
+    const auto* box = chunkBounds(level, x, z);
+    if(!box)
+    {
+        return;
+    }
+
+    const auto offset = glm::max(glm::max(box->min() - cameraPosition, cameraPosition - box->max()), glm::vec3{0.0f});
+    const auto chunkSize = static_cast<float>(chunkIntervals(level)) * m_sampleSpacing;
+
+    if(level < m_maxLevel && glm::length(offset) < chunkSize * terrainSplitDistance)
+    {
+        // Every child is asked for before any is checked, so all four stream in together
+        auto childrenReady = true;
+        for(auto child = 0; child < 4; ++child)
+        {
+            childrenReady &= chunkBounds(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1)) != nullptr;
+        }
+
+        if(childrenReady)
+        {
+            for(auto child = 0; child < 4; ++child)
+            {
+                selectChunks(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1), cameraPosition, chunkBounds);
+            }
+            return;
+        }
+    }
+
+    m_selected.push_back(chunkKey(level, x, z));
+}
+
+uint32_t TerrainQuadtree::stitch(int level, int x, int z) const
+{
+    constexpr int edgeOffsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    // Dropping more levels than a chunk has edge vertices to snap would leave nothing on the edge
+    auto maxDrop = 0;
+    while((chunkResolution >> (maxDrop + 1)) > 0)
+    {
+        maxDrop++;
+    }
+
+    auto stitch = uint32_t{0};
+    for(auto edge = 0; edge < 4; ++edge)
+    {
+        const auto neighbourX = x + edgeOffsets[edge][0];
+        const auto neighbourZ = z + edgeOffsets[edge][1];
+        const auto levelWidth = 1 << level;
+        if(neighbourX < 0 || neighbourZ < 0 || neighbourX >= levelWidth || neighbourZ >= levelWidth)
+        {
+            continue;
+        }
+
+        // The neighbour is the selected chunk at or above this level that covers the adjacent square.
+        // If none is, the neighbour is finer, and it stitches to this chunk instead
+        for(auto drop = 0; drop <= level; ++drop)
+        {
+            if(m_selectedKeys.contains(chunkKey(level - drop, neighbourX >> drop, neighbourZ >> drop)))
+            {
+                stitch |= static_cast<uint32_t>(std::min(drop, maxDrop)) << (edge * stitchEdgeBits);
+                break;
+            }
+        }
+    }
+
+    return stitch;
+}
+
+const std::vector<GLuint>& TerrainQuadtree::stitchedIndices(uint32_t stitch)
+{
+    if(auto cached = m_stitchIndices.find(stitch); cached != m_stitchIndices.end())
+    {
+        return cached->second;
+    }
+
+    const auto edgeDrop = [&](int edge) { return (stitch >> (edge * stitchEdgeBits)) & ((1u << stitchEdgeBits) - 1); };
+
+    // Edge vertices between the coarser neighbour's slide back onto the one before them. The triangles that
+    // lose their edge collapse, and the rest fan out from the neighbour's vertices, so no T-junction is left
+    const auto vertexIndex = [&](int i, int j) {
+        if(i == 0 || i == chunkResolution)
+        {
+            const auto drop = edgeDrop(i == 0 ? 0 : 1);
+            j = (j >> drop) << drop;
+        }
+        if(j == 0 || j == chunkResolution)
+        {
+            const auto drop = edgeDrop(j == 0 ? 2 : 3);
+            i = (i >> drop) << drop;
+        }
+        return static_cast<GLuint>(j * (chunkResolution + 1) + i);
+    };
+
+    auto indices = std::vector<GLuint>{};
+    indices.reserve(static_cast<size_t>(chunkResolution) * chunkResolution * 6);
+
+    const auto addTriangle = [&](GLuint a, GLuint b, GLuint c) {
+        if(a != b && b != c && c != a)
+        {
+            indices.insert(indices.end(), {a, b, c});
+        }
+    };
+
+    // Counter-clockwise seen from above, x to the right and z towards the viewer
+    for(auto j = 0; j < chunkResolution; ++j)
+    {
+        for(auto i = 0; i < chunkResolution; ++i)
+        {
+            addTriangle(vertexIndex(i, j), vertexIndex(i, j + 1), vertexIndex(i + 1, j));
+            addTriangle(vertexIndex(i + 1, j), vertexIndex(i, j + 1), vertexIndex(i + 1, j + 1));
+        }
+    }
+
+    return m_stitchIndices.emplace(stitch, std::move(indices)).first->second;
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glad/gl.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Box;
+
+// Which chunks of a heightmap terrain to draw and how to stitch them together, apart from streaming and
+// drawing them, so the choice can be checked without a GL context. Every chunk has the same number of quads,
+// so a chunk covering four times the ground has a quarter the detail, and chunks split as the camera nears them
+class TerrainQuadtree
+{
+    public:
+        // Quads along each side of a chunk. A power of two, so stitching to a coarser neighbour always
+        // has vertices to snap onto
+        static constexpr int chunkResolution = 32;
+
+        // Bounds of a chunk in the terrain's own space, or null while its heights are not in yet.
+        // Called for every chunk the selection looks at, so it doubles as the request to stream one in
+        using ChunkBounds = std::function<const Box*(int level, int x, int z)>;
+
+        // sampleCount is along each side of the heightmap, 2^n + 1 of them
+        TerrainQuadtree(int sampleCount, float sampleSpacing);
+
+        static uint64_t chunkKey(int level, int x, int z);
+
+        // Picks the chunks to draw for a camera in the terrain's own space. A chunk is drawn in place of its
+        // children until all four have bounds
+        void select(const glm::vec3& cameraPosition, const ChunkBounds& chunkBounds);
+
+        // Keys of the chunks the last selection picked
+        inline const std::vector<uint64_t>& selected() const
+        {
+            return m_selected;
+        }
+
+        // Levels the neighbour on each edge is coarser by, 4 bits per edge ordered west, east, north, south
+        uint32_t stitch(int level, int x, int z) const;
+
+        // Indices into a chunk's (chunkResolution + 1)^2 vertices, row by row along x, with the edges
+        // of a stitch snapped onto the coarser neighbours' vertices
+        const std::vector<GLuint>& stitchedIndices(uint32_t stitch);
+
+        // Sample intervals a chunk of the level covers along each side
+        inline int chunkIntervals(int level) const
+        {
+            return (m_sampleCount - 1) >> level;
+        }
+
+        // Level whose chunks are drawn at full heightmap resolution
+        inline int maxLevel() const
+        {
+            return m_maxLevel;
+        }
+
+    private:
+        void selectChunks(int level, int x, int z, const glm::vec3& cameraPosition, const ChunkBounds& chunkBounds);
+
+    private:
+        int m_sampleCount{0};
+        int m_maxLevel{0};
+        float m_sampleSpacing{1.0f};
+
+        std::vector<uint64_t> m_selected;
+        std::unordered_set<uint64_t> m_selectedKeys;
+        // Indices for each stitch, shared by every chunk
+        std::unordered_map<uint32_t, std::vector<GLuint>> m_stitchIndices;
+};
@@ -7,8 +7,10 @@
 #include "world/components/BehaviourComponent.h"
 #include "world/components/CameraComponent.h"
 #include "world/components/DirectionalLightComponent.h"
+#include "world/components/HlodComponent.h"
 #include "world/components/MeshRenderingComponent.h"
 #include "world/components/PointLightComponent.h"
+#include "world/components/TerrainComponent.h"
 #include "world/components/TransformComponent.h"
 
 #include <stdexcept>
@@ -27,8 +29,10 @@ class World
             m_behaviourComponents.erase(entity);
             m_cameraComponents.erase(entity);
             m_directionalLightComponents.erase(entity);
+            m_hlodComponents.erase(entity);
             m_meshRendererComponents.erase(entity);
             m_pointLightComponents.erase(entity);
+            m_terrainComponents.erase(entity);
             m_transformComponents.erase(entity);
         }
 
@@ -39,6 +43,12 @@ class World
             return storage[entity] = Component(std::forward<Args>(args)...);
         }
 
+        template<typename Component>
+        void removeComponent(Entity entity)
+        {
+            getStorage<Component>().erase(entity);
+        }
+
         template<typename Component>
         Component* getComponent(Entity entity)
         {
@@ -72,6 +82,10 @@ class World
             {
                 return m_directionalLightComponents;
             }
+            if constexpr(std::is_same_v<Component, HlodComponent>)
+            {
+                return m_hlodComponents;
+            }
             if constexpr(std::is_same_v<Component, MeshRendererComponent>)
             {
                 return m_meshRendererComponents;
@@ -80,6 +94,10 @@ class World
             {
                 return m_pointLightComponents;
             }
+            if constexpr(std::is_same_v<Component, TerrainComponent>)
+            {
+                return m_terrainComponents;
+            }
             if constexpr(std::is_same_v<Component, TransformComponent>)
             {
                 return m_transformComponents;
@@ -92,8 +110,10 @@ class World
         std::unordered_map<Entity, BehaviourComponent> m_behaviourComponents;
         std::unordered_map<Entity, CameraComponent> m_cameraComponents;
         std::unordered_map<Entity, DirectionalLightComponent> m_directionalLightComponents;
+        std::unordered_map<Entity, HlodComponent> m_hlodComponents;
         std::unordered_map<Entity, MeshRendererComponent> m_meshRendererComponents;
         std::unordered_map<Entity, PointLightComponent> m_pointLightComponents;
+        std::unordered_map<Entity, TerrainComponent> m_terrainComponents;
         std::unordered_map<Entity, TransformComponent> m_transformComponents;
 
     private:
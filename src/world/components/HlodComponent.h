@@ -0,0 +1,31 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "data/Box.h"
+#include "data/Prefab.h"
+#include "world/Entity.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct HlodMember
+{
+    Entity entity{0};
+    Prefab* prefab{nullptr};
+    glm::mat4 transform{1.0f};
+    Box worldBox{};
+};
+
+// A grid cell of static entities, drawn as a single merged proxy once the camera is far enough away
+struct HlodComponent
+{
+    // World space, like the members it stands in for
+    Prefab* proxy{nullptr};
+    // World space, around every member
+    Box bounds{};
+    // The members hand their MeshRendererComponent over to the cell, which draws them while it is close
+    std::vector<HlodMember> members;
+};
@@ -0,0 +1,21 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <filesystem>
+
+// Heightmapped ground streamed in chunks around the camera, placed by the entity's transform with its
+// lowest corner at the origin
+struct TerrainComponent
+{
+    // See HeightmapStreamer for the format
+    std::filesystem::path heightmapPath;
+    // World units across the heightmap along x and z
+    float size{1024.0f};
+    // World units between the lowest and highest sample values
+    float height{128.0f};
+    glm::vec3 color{0.35f, 0.45f, 0.25f};
+};
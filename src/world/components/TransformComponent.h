@@ -4,10 +4,20 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 struct TransformComponent
 {
     glm::vec3 position{0.0f};
     glm::vec3 rotation{0.0f};
     glm::vec3 scale{1.0f};
+
+    // Scales, then rotates by the euler angles in degrees, then translates
+    glm::mat4 matrix() const
+    {
+        return glm::translate(glm::mat4(1.0f), position)
+             * glm::mat4_cast(glm::quat(glm::radians(rotation)))
+             * glm::scale(glm::mat4(1.0f), scale);
+    }
 };
@@ -3,23 +3,58 @@
 
 #include "RenderSystem.h"
 
+#include "core/WorkerPool.h"
 #include "data/Prefab.h"
 #include "rendering/Renderer.h"
 #include "world/World.h"
 
-#define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/quaternion.hpp>
-#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Small enough to rasterise in well under a millisecond, a tile row per 4 pixels and a tile per 32
+constexpr auto occlusionBufferWidth = 320;
+constexpr auto occlusionBufferHeight = 180;
+
+// Entities tested per worker task
+constexpr size_t occlusionTestBatch = 64;
+
+// Projected radius, as a fraction of half the screen height, below which level 0 gives way to level 1.
+// Each level after that holds until half the size of the one before, as each has about half the triangles
+constexpr auto lodFirstScreenSize = 0.4f;
+
+// How far past a threshold the size must go before the level changes, so objects sitting on one do not flicker
+constexpr auto lodHysteresis = 0.15f;
+
+// Fraction of the HLOD distance the camera must cross before a cell swaps between its proxy and its members
+constexpr auto hlodHysteresis = 0.1f;
 
 RenderSystem::RenderSystem(Renderer& renderer, World& world)
     : m_renderer{renderer}
     , m_world{world}
+    , m_occlusionRasteriser{occlusionBufferWidth, occlusionBufferHeight}
 {
+    // The calling thread works too, so one fewer worker than cores
+    const auto coreCount = static_cast<size_t>(std::thread::hardware_concurrency());
+    m_workerPool = std::make_unique<WorkerPool>(std::max<size_t>(coreCount, 2) - 1);
 }
 
+RenderSystem::~RenderSystem() = default;
+
 void RenderSystem::update()
 {
+    m_entities.clear();
+
+    // Matches the projection the camera passes draw with
+    const auto* camera = findActiveCamera();
+    auto projection = glm::mat4{1.0f};
+    if(camera)
+    {
+        projection = glm::perspective(camera->fieldOfView, m_renderer.aspectRatio(), camera->nearPlane, camera->farPlane);
+    }
+
     for(auto& [entity, meshComponent] : m_world.getAllComponents<MeshRendererComponent>())
     {
         if(!meshComponent.prefab)
@@ -33,17 +68,177 @@ void RenderSystem::update()
             continue;
         }
 
-        auto transformMatrix = glm::translate(glm::mat4(1.0f), transformComponent->position)
-                                  * glm::toMat4(glm::quat(glm::radians(transformComponent->rotation)))
-                                  * glm::scale(glm::mat4(1.0f), transformComponent->scale);
+        const auto transformMatrix = transformComponent->matrix();
+
+        auto worldBox = meshComponent.prefab->boundingBox();
+        worldBox.transform(transformMatrix);
+
+        m_entities.push_back({entity, meshComponent.prefab, transformMatrix, worldBox});
+    }
+
+    // A far cell is a single entity whatever it holds, and the proxy is already in world space
+    for(auto& [entity, hlodComponent] : m_world.getAllComponents<HlodComponent>())
+    {
+        if(camera && selectHlodProxy(entity, hlodComponent.bounds, *camera))
+        {
+            m_entities.push_back({entity, hlodComponent.proxy, glm::mat4{1.0f}, hlodComponent.bounds});
+            continue;
+        }
+
+        for(const auto& member : hlodComponent.members)
+        {
+            m_entities.push_back({member.entity, member.prefab, member.transform, member.worldBox});
+        }
+    }
+
+    m_hidden.assign(m_entities.size(), 0);
+    m_occlusionStats = OcclusionStats{};
+
+    if(m_occlusionCulling && camera)
+    {
+        const auto view = glm::lookAt(camera->position, camera->position + camera->front, camera->up);
+        testOcclusion(projection * view);
+    }
+
+    for(size_t i = 0; i < m_entities.size(); ++i)
+    {
+        const auto& entity = m_entities[i];
+        const auto lodCount = entity.prefab->lodCount();
+        const auto lod = camera ? selectLod(entity, *camera, projection) : 0;
+
+        // The quad stands in for the meshes in front of the camera. Shadows still need geometry,
+        // which the coarsest level gives cheaply at this distance
+        const auto impostor = lod == lodCount;
+        if(impostor && m_hidden[i] == 0)
+        {
+            m_renderer.queueImpostor(*entity.prefab, entity.transform);
+        }
 
-        for(auto& mesh : meshComponent.prefab->meshes())
+        for(auto& mesh : entity.prefab->lodMeshes(impostor ? lodCount - 1 : lod))
         {
             auto cmd = DrawCommand{};
             cmd.mesh = mesh.get();
-            cmd.transform = transformMatrix;
-            
+            cmd.transform = entity.transform;
+            cmd.hiddenFromCamera = impostor || m_hidden[i] != 0;
+
             m_renderer.queueDrawCommand(cmd);
         }
     }
 }
+
+void RenderSystem::setOcclusionCulling(bool enabled)
+{
+    m_occlusionCulling = enabled;
+}
+
+void RenderSystem::setImpostorScreenSize(float screenSize)
+{
+    m_impostorScreenSize = screenSize;
+}
+
+void RenderSystem::setHlodDistance(float distance)
+{
+    m_hlodDistance = distance;
+}
+
+const Camera* RenderSystem::findActiveCamera()
+{
+    for(auto& [entity, cameraComponent] : m_world.getAllComponents<CameraComponent>())
+    {
+        if(cameraComponent.active())
+        {
+            return &cameraComponent.camera();
+        }
+    }
+
+    return nullptr;
+}
+
+size_t RenderSystem::selectLod(const RenderableEntity& entity, const Camera& camera, const glm::mat4& projection)
+{
+    const auto lodCount = entity.prefab->lodCount();
+    const auto hasImpostor = m_impostorScreenSize > 0.0f && m_renderer.hasImpostor(*entity.prefab);
+    const auto levelCount = hasImpostor ? lodCount + 1 : lodCount;
+    auto& lod = m_entityLods[entity.entity];
+    lod = std::min(lod, levelCount - 1);
+
+    // The bounding sphere's radius over its distance, scaled by the projection into half screen heights
+    const auto radius = 0.5f * glm::length(entity.worldBox.max() - entity.worldBox.min());
+    const auto distance = glm::length(entity.worldBox.center() - camera.position);
+    const auto screenSize = distance <= radius ? 1.0f : radius * projection[1][1] / distance;
+
+    // The last level gives way to the impostor at its own size rather than the halving series
+    const auto switchSize = [&](size_t level) {
+        if(hasImpostor && level + 1 == lodCount)
+        {
+            return m_impostorScreenSize;
+        }
+        return lodFirstScreenSize / static_cast<float>(1u << level);
+    };
+
+    while(lod + 1 < levelCount && screenSize < switchSize(lod) * (1.0f - lodHysteresis))
+    {
+        ++lod;
+    }
+    while(lod > 0 && screenSize > switchSize(lod - 1) * (1.0f + lodHysteresis))
+    {
+        --lod;
+    }
+
+    return lod;
+}
+
+bool RenderSystem::selectHlodProxy(Entity cell, const Box& bounds, const Camera& camera)
+{
+    auto& proxy = m_hlodProxies[cell];
+    if(m_hlodDistance <= 0.0f)
+    {
+        proxy = false;
+        return proxy;
+    }
+
+    // To the nearest point of the bounds, so a large cell does not swap while the camera is next to its edge
+    const auto nearest = glm::clamp(camera.position, bounds.min(), bounds.max());
+    const auto distance = glm::length(nearest - camera.position);
+
+    const auto threshold = m_hlodDistance * (proxy ? 1.0f - hlodHysteresis : 1.0f + hlodHysteresis);
+    proxy = distance > threshold;
+    return proxy;
+}
+
+void RenderSystem::testOcclusion(const glm::mat4& viewProjection)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    m_occlusionRasteriser.begin(viewProjection);
+    for(const auto& entity : m_entities)
+    {
+        if(const auto* occluder = entity.prefab->occluder())
+        {
+            m_occlusionRasteriser.addOccluder(*occluder, entity.transform);
+        }
+    }
+
+    // Bands of tile rows, one per thread, so no two threads write the same tile
+    const auto tileRowCount = static_cast<size_t>(m_occlusionRasteriser.tileRowCount());
+    const auto bandCount = std::min(m_workerPool->threadCount(), tileRowCount);
+    m_workerPool->run(bandCount, [&](size_t band) {
+        const auto firstRow = band * tileRowCount / bandCount;
+        const auto endRow = (band + 1) * tileRowCount / bandCount;
+        m_occlusionRasteriser.rasteriseTileRows(static_cast<int>(firstRow), static_cast<int>(endRow));
+    });
+
+    const auto batchCount = (m_entities.size() + occlusionTestBatch - 1) / occlusionTestBatch;
+    m_workerPool->run(batchCount, [&](size_t batch) {
+        const auto end = std::min((batch + 1) * occlusionTestBatch, m_entities.size());
+        for(auto i = batch * occlusionTestBatch; i < end; ++i)
+        {
+            m_hidden[i] = m_occlusionRasteriser.isVisible(m_entities[i].worldBox) ? 0 : 1;
+        }
+    });
+
+    m_occlusionStats.occluderTriangles = static_cast<uint32_t>(m_occlusionRasteriser.triangleCount());
+    m_occlusionStats.testedEntities = static_cast<uint32_t>(m_entities.size());
+    m_occlusionStats.hiddenEntities = static_cast<uint32_t>(std::count(m_hidden.begin(), m_hidden.end(), 1));
+    m_occlusionStats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
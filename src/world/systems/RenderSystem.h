@@ -3,17 +3,107 @@
 
 #pragma once
 
+#include "data/Box.h"
+#include "rendering/OcclusionRasteriser.h"
+#include "world/Entity.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Prefab;
 class Renderer;
+struct Camera;
 class World;
+class WorkerPool;
 
 class RenderSystem
 {
     public:
+        struct OcclusionStats
+        {
+            uint32_t occluderTriangles{0};
+            uint32_t testedEntities{0};
+            uint32_t hiddenEntities{0};
+            float milliseconds{0.0f};
+        };
+
         RenderSystem(Renderer& renderer, World& world);
+        ~RenderSystem();
+
+        RenderSystem(const RenderSystem& other) = delete;
+        RenderSystem(RenderSystem&& other) = delete;
+
+        RenderSystem& operator=(const RenderSystem& other) = delete;
+        RenderSystem& operator=(RenderSystem&& other) = delete;
 
         void update();
 
+        // Draws prefab occluders into a CPU depth buffer on worker threads and marks the entities
+        // they hide, so camera passes skip them without reading anything back from the GPU
+        void setOcclusionCulling(bool enabled);
+
+        inline bool occlusionCulling() const
+        {
+            return m_occlusionCulling;
+        }
+
+        inline const OcclusionStats& occlusionStats() const
+        {
+            return m_occlusionStats;
+        }
+
+        // Projected radius, as a fraction of half the screen height, below which prefabs with an impostor atlas
+        // are drawn from it instead of their meshes. 0 never draws impostors
+        void setImpostorScreenSize(float screenSize);
+
+        inline float impostorScreenSize() const
+        {
+            return m_impostorScreenSize;
+        }
+
+        // Distance from the camera to an HLOD cell's bounds beyond which the cell draws its proxy instead of its members
+        void setHlodDistance(float distance);
+
+        inline float hlodDistance() const
+        {
+            return m_hlodDistance;
+        }
+
+    private:
+        struct RenderableEntity
+        {
+            Entity entity{0};
+            const Prefab* prefab{nullptr};
+            glm::mat4 transform{1.0f};
+            Box worldBox{};
+        };
+
+        const Camera* findActiveCamera();
+        // The prefab's lodCount when the entity is small enough for its impostor
+        size_t selectLod(const RenderableEntity& entity, const Camera& camera, const glm::mat4& projection);
+        bool selectHlodProxy(Entity cell, const Box& bounds, const Camera& camera);
+        void testOcclusion(const glm::mat4& viewProjection);
+
     private:
         Renderer& m_renderer;
         World& m_world;
+
+        std::unique_ptr<WorkerPool> m_workerPool{nullptr};
+        OcclusionRasteriser m_occlusionRasteriser;
+        std::vector<RenderableEntity> m_entities;
+        // One per entity, set when the occluders hide it
+        std::vector<uint8_t> m_hidden;
+        // Level of detail each entity was drawn at last frame, which a new level must clearly beat.
+        // One past the prefab's last level is its impostor
+        std::unordered_map<Entity, size_t> m_entityLods;
+        // HLOD cells drawn as their proxy last frame
+        std::unordered_map<Entity, bool> m_hlodProxies;
+        OcclusionStats m_occlusionStats{};
+        bool m_occlusionCulling{false};
+        float m_impostorScreenSize{0.0f};
+        float m_hlodDistance{0.0f};
 };
@@ -0,0 +1,75 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TerrainSystem.h"
+
+#include "rendering/Renderer.h"
+#include "world/Terrain.h"
+#include "world/World.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iterator>
+
+TerrainSystem::TerrainSystem(Renderer& renderer, World& world)
+    : m_renderer{renderer}
+    , m_world{world}
+{
+}
+
+TerrainSystem::~TerrainSystem() = default;
+
+void TerrainSystem::update()
+{
+    // Terrain whose component is gone gives its chunks back to the renderer
+    for(auto itr = m_terrains.begin(); itr != m_terrains.end();)
+    {
+        itr = m_world.getComponent<TerrainComponent>(itr->first) ? std::next(itr) : m_terrains.erase(itr);
+    }
+
+    // Chunks are chosen by distance to the camera, so without one there is nothing to draw
+    const auto* camera = findActiveCamera();
+    if(!camera)
+    {
+        return;
+    }
+
+    // Matches the projection the camera passes draw with
+    const auto projection = glm::perspective(camera->fieldOfView, m_renderer.aspectRatio(), camera->nearPlane, camera->farPlane);
+    const auto view = glm::lookAt(camera->position, camera->position + camera->front, camera->up);
+
+    const auto terrainTransform = [this](Entity entity) {
+        const auto* transformComponent = m_world.getComponent<TransformComponent>(entity);
+        return transformComponent ? transformComponent->matrix() : glm::mat4{1.0f};
+    };
+
+    for(auto& [entity, terrainComponent] : m_world.getAllComponents<TerrainComponent>())
+    {
+        auto& terrain = m_terrains[entity];
+        if(!terrain)
+        {
+            terrain = std::make_unique<Terrain>(terrainComponent, m_renderer);
+        }
+
+        terrain->update(terrainTransform(entity), camera->position);
+    }
+
+    // Every chunk is uploaded before any is queued, so no draw is queued while the mesh buffer changes
+    for(const auto& [entity, terrain] : m_terrains)
+    {
+        terrain->queueDraws(terrainTransform(entity), projection * view);
+    }
+}
+
+const Camera* TerrainSystem::findActiveCamera()
+{
+    for(auto& [entity, cameraComponent] : m_world.getAllComponents<CameraComponent>())
+    {
+        if(cameraComponent.active())
+        {
+            return &cameraComponent.camera();
+        }
+    }
+
+    return nullptr;
+}
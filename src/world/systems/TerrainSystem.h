@@ -0,0 +1,39 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "world/Entity.h"
+
+#include <memory>
+#include <unordered_map>
+
+class Renderer;
+class Terrain;
+struct Camera;
+class World;
+
+// Keeps a Terrain for each TerrainComponent and queues its chunks for the active camera
+class TerrainSystem
+{
+    public:
+        TerrainSystem(Renderer& renderer, World& world);
+        ~TerrainSystem();
+
+        TerrainSystem(const TerrainSystem& other) = delete;
+        TerrainSystem(TerrainSystem&& other) = delete;
+
+        TerrainSystem& operator=(const TerrainSystem& other) = delete;
+        TerrainSystem& operator=(TerrainSystem&& other) = delete;
+
+        void update();
+
+    private:
+        const Camera* findActiveCamera();
+
+    private:
+        Renderer& m_renderer;
+        World& m_world;
+
+        std::unordered_map<Entity, std::unique_ptr<Terrain>> m_terrains;
+};
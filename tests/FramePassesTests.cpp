@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include "rendering/FramePasses.h"
+#include "rendering/RenderGraph.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Position of a pass in the scheduled order, or -1 when it does not run
+int passPosition(const std::vector<std::string>& order, const std::string& name)
+{
+    const auto itr = std::find(order.begin(), order.end(), name);
+    return itr == order.end() ? -1 : static_cast<int>(itr - order.begin());
+}
+
+std::vector<std::string> scheduleFramePasses(const FramePassOptions& options)
+{
+    auto graph = RenderGraph{};
+    addFramePasses(graph, options, {});
+    graph.schedule();
+    return graph.executionOrder();
+}
+
+TEST_CASE(clusteredShadingSchedules)
+{
+    auto options = FramePassOptions{1280, 720};
+    options.lightVolumes = false;
+
+    const auto order = scheduleFramePasses(options);
+
+    CHECK(passPosition(order, "PointLightVolumes") < 0);
+    CHECK(passPosition(order, "GBuffer") < passPosition(order, "Lighting"));
+    CHECK(passPosition(order, "Lighting") < passPosition(order, "Skybox"));
+    CHECK(passPosition(order, "Skybox") < passPosition(order, "Present"));
+}
+
+TEST_CASE(lightVolumeShadingSchedules)
+{
+    auto options = FramePassOptions{1280, 720};
+    options.lightVolumes = true;
+
+    const auto order = scheduleFramePasses(options);
+
+    // The volumes add to the lit scene, so they come after the full-screen pass that creates it
+    CHECK(passPosition(order, "Lighting") >= 0);
+    CHECK(passPosition(order, "Lighting") < passPosition(order, "PointLightVolumes"));
+    CHECK(passPosition(order, "PointLightVolumes") < passPosition(order, "Skybox"));
+    CHECK(passPosition(order, "Skybox") < passPosition(order, "Present"));
+}
+
+TEST_CASE(everyOptionCombinationSchedules)
+{
+    for(auto bits = 0; bits < 32; ++bits)
+    {
+        auto options = FramePassOptions{1280, 720};
+        options.lightVolumes = (bits & 1) != 0;
+        options.depthPrePass = (bits & 2) != 0;
+        options.countOverdraw = (bits & 4) != 0;
+        options.gpuCulling = (bits & 8) != 0;
+        options.occlusionCulling = (bits & 16) != 0;
+
+        const auto order = scheduleFramePasses(options);
+
+        CHECK(passPosition(order, "Present") == static_cast<int>(order.size()) - 1);
+        CHECK((passPosition(order, "PointLightVolumes") >= 0) == options.lightVolumes);
+        CHECK((passPosition(order, "HiZ") >= 0) == (options.gpuCulling && options.occlusionCulling));
+        if(options.gpuCulling && options.occlusionCulling)
+        {
+            // The pyramid is built from the finished depth, impostors included
+            CHECK(passPosition(order, "Impostors") < passPosition(order, "HiZ"));
+        }
+    }
+}
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include "data/Material.h"
+#include "data/Mesh.h"
+#include "data/Prefab.h"
+#include "loaders/HlodBuilder.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A flat square of size by size quads in the xz plane from the origin, facing up
+std::unique_ptr<Mesh> gridMesh(int size, Material* material)
+{
+    auto mesh = std::make_unique<Mesh>();
+    mesh->material = material;
+
+    for(auto z = 0; z <= size; ++z)
+    {
+        for(auto x = 0; x <= size; ++x)
+        {
+            auto vertex = Vertex{};
+            vertex.position = {static_cast<float>(x), 0.0f, static_cast<float>(z)};
+            vertex.normal = {0.0f, 1.0f, 0.0f};
+            vertex.textureUV = {static_cast<float>(x) / size, static_cast<float>(z) / size};
+            mesh->vertices.push_back(vertex);
+        }
+    }
+
+    for(auto z = 0; z < size; ++z)
+    {
+        for(auto x = 0; x < size; ++x)
+        {
+            const auto corner = static_cast<GLuint>(z * (size + 1) + x);
+            const auto row = static_cast<GLuint>(size + 1);
+            mesh->indices.insert(mesh->indices.end(), {corner, corner + row, corner + 1, corner + 1, corner + row, corner + row + 1});
+        }
+    }
+
+    return mesh;
+}
+
+std::unique_ptr<Material> flatMaterial(const glm::vec3& diffuse)
+{
+    auto material = std::make_unique<Material>();
+    material->ambient = diffuse;
+    material->diffuse = diffuse;
+    material->specular = glm::vec3{0.0f};
+    return material;
+}
+
+// A prefab of one grid per material
+std::unique_ptr<Prefab> gridPrefab(std::vector<std::unique_ptr<Material>> materials, int size)
+{
+    auto prefab = std::make_unique<Prefab>();
+    for(size_t m = 0; m < materials.size(); ++m)
+    {
+        prefab->addMesh(gridMesh(size, materials[m].get()));
+        prefab->addMaterial("material" + std::to_string(m), std::move(materials[m]));
+    }
+    return prefab;
+}
+
+std::vector<std::unique_ptr<Material>> oneMaterial(const glm::vec3& diffuse)
+{
+    auto materials = std::vector<std::unique_ptr<Material>>{};
+    materials.push_back(flatMaterial(diffuse));
+    return materials;
+}
+
+size_t triangleCount(const std::vector<std::unique_ptr<Mesh>>& meshes)
+{
+    auto count = size_t{0};
+    for(const auto& mesh : meshes)
+    {
+        count += mesh->indices.size() / 3;
+    }
+    return count;
+}
+
+// The atlas texel at x, y as a colour in [0, 255]
+glm::vec3 atlasTexel(const HlodProxy& proxy, int x, int y)
+{
+    const auto* texel = &proxy.atlas[static_cast<size_t>(y * proxy.atlasSize + x) * 4];
+    return {texel[0], texel[1], texel[2]};
+}
+
+TEST_CASE(proxyIsInWorldSpaceWithFewerTriangles)
+{
+    const auto prefab = gridPrefab(oneMaterial({1.0f, 0.0f, 0.0f}), 8);
+    const auto offset = glm::vec3{100.0f, 5.0f, -40.0f};
+
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::translate(glm::mat4{1.0f}, offset)}});
+
+    CHECK(proxy.meshes.size() == 1);
+    CHECK(triangleCount(proxy.meshes) > 0);
+    CHECK(triangleCount(proxy.meshes) < triangleCount(prefab->meshes()));
+
+    for(const auto& mesh : proxy.meshes)
+    {
+        // Left for the caller to point at the uploaded atlas
+        CHECK(mesh->material == nullptr);
+
+        for(const auto& vertex : mesh->vertices)
+        {
+            CHECK(vertex.position.x >= offset.x && vertex.position.x <= offset.x + 8.0f);
+            CHECK(std::abs(vertex.position.y - offset.y) < 1e-4f);
+            CHECK(vertex.position.z >= offset.z && vertex.position.z <= offset.z + 8.0f);
+        }
+    }
+}
+
+TEST_CASE(normalsFollowTheSourceRotation)
+{
+    const auto prefab = gridPrefab(oneMaterial({1.0f, 1.0f, 1.0f}), 2);
+
+    // Turns the up facing grid to face +z, scaled unevenly so the normal matrix matters
+    const auto transform = glm::scale(glm::rotate(glm::mat4{1.0f}, glm::radians(90.0f), glm::vec3{1.0f, 0.0f, 0.0f}),
+                                      glm::vec3{3.0f, 1.0f, 0.5f});
+
+    const auto proxy = buildHlodProxy({{prefab.get(), transform}});
+
+    CHECK(!proxy.meshes.empty());
+    for(const auto& mesh : proxy.meshes)
+    {
+        for(const auto& vertex : mesh->vertices)
+        {
+            CHECK(glm::length(vertex.normal - glm::vec3{0.0f, 0.0f, 1.0f}) < 1e-4f);
+        }
+    }
+}
+
+TEST_CASE(atlasHoldsAFlatTilePerMaterial)
+{
+    auto materials = std::vector<std::unique_ptr<Material>>{};
+    materials.push_back(flatMaterial({1.0f, 0.0f, 0.0f}));
+    materials.push_back(flatMaterial({0.0f, 1.0f, 0.0f}));
+
+    // A textured material is baked down to its texture's average colour rather than its diffuse
+    auto textured = flatMaterial({1.0f, 1.0f, 1.0f});
+    textured->diffuseTexture = nullptr;
+    textured->diffuseTextureMean = {0.0f, 0.0f, 1.0f};
+    materials.push_back(std::move(textured));
+
+    const auto prefab = gridPrefab(std::move(materials), 2);
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::mat4{1.0f}}});
+
+    // Three tiles need a 2x2 grid of them
+    CHECK(proxy.atlasSize > 0 && proxy.atlasSize % 2 == 0);
+    CHECK(proxy.atlas.size() == static_cast<size_t>(proxy.atlasSize * proxy.atlasSize) * 4);
+
+    const auto tileSize = proxy.atlasSize / 2;
+    for(auto y = 0; y < tileSize; ++y)
+    {
+        for(auto x = 0; x < tileSize; ++x)
+        {
+            CHECK(atlasTexel(proxy, x, y) == glm::vec3(255.0f, 0.0f, 0.0f));
+            CHECK(atlasTexel(proxy, tileSize + x, y) == glm::vec3(0.0f, 255.0f, 0.0f));
+            CHECK(atlasTexel(proxy, x, tileSize + y) == glm::vec3(0.0f, 0.0f, 255.0f));
+        }
+    }
+}
+
+TEST_CASE(verticesSampleTheCentreOfTheirMaterialsTile)
+{
+    auto materials = std::vector<std::unique_ptr<Material>>{};
+    materials.push_back(flatMaterial({1.0f, 0.0f, 0.0f}));
+    materials.push_back(flatMaterial({0.0f, 1.0f, 0.0f}));
+    const auto prefab = gridPrefab(std::move(materials), 2);
+
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::mat4{1.0f}}});
+
+    CHECK(!proxy.meshes.empty());
+    for(const auto& mesh : proxy.meshes)
+    {
+        for(const auto& vertex : mesh->vertices)
+        {
+            const auto texel = glm::ivec2(vertex.textureUV * static_cast<float>(proxy.atlasSize));
+            const auto color = atlasTexel(proxy, texel.x, texel.y);
+            CHECK(color == glm::vec3(255.0f, 0.0f, 0.0f) || color == glm::vec3(0.0f, 255.0f, 0.0f));
+
+            // Tile centres of a 2x2 grid
+            CHECK(std::abs(vertex.textureUV.x - 0.25f) < 1e-6f || std::abs(vertex.textureUV.x - 0.75f) < 1e-6f);
+            CHECK(std::abs(vertex.textureUV.y - 0.25f) < 1e-6f);
+        }
+    }
+}
+
+TEST_CASE(sourcesSharingAMaterialShareATile)
+{
+    auto material = flatMaterial({1.0f, 0.0f, 0.0f});
+    auto prefab = std::make_unique<Prefab>();
+    prefab->addMesh(gridMesh(2, material.get()));
+    prefab->addMesh(gridMesh(2, material.get()));
+
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::mat4{1.0f}},
+                                       {prefab.get(), glm::translate(glm::mat4{1.0f}, glm::vec3{10.0f, 0.0f, 0.0f})}});
+
+    // One tile fills the whole atlas
+    for(auto y = 0; y < proxy.atlasSize; ++y)
+    {
+        for(auto x = 0; x < proxy.atlasSize; ++x)
+        {
+            CHECK(atlasTexel(proxy, x, y) == glm::vec3(255.0f, 0.0f, 0.0f));
+        }
+    }
+}
+
+TEST_CASE(proxyIsBuiltFromTheCoarsestLevel)
+{
+    auto prefab = gridPrefab(oneMaterial({1.0f, 1.0f, 1.0f}), 8);
+
+    // A coarser level covering only half the grid, so the proxy shows which level it came from
+    auto lod = std::vector<std::unique_ptr<Mesh>>{};
+    lod.push_back(gridMesh(4, prefab->meshes().front()->material));
+    prefab->addLod(std::move(lod));
+
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::mat4{1.0f}}});
+
+    CHECK(!proxy.meshes.empty());
+    for(const auto& mesh : proxy.meshes)
+    {
+        for(const auto& vertex : mesh->vertices)
+        {
+            CHECK(vertex.position.x <= 4.0f && vertex.position.z <= 4.0f);
+        }
+    }
+}
+
+TEST_CASE(meshesWithoutAMaterialAreLeftOut)
+{
+    auto prefab = std::make_unique<Prefab>();
+    prefab->addMesh(gridMesh(2, nullptr));
+
+    const auto proxy = buildHlodProxy({{prefab.get(), glm::mat4{1.0f}}});
+
+    CHECK(proxy.meshes.empty());
+}
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include "data/Box.h"
+#include "data/OccluderMesh.h"
+#include "rendering/OcclusionRasteriser.h"
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <cstdint>
+
+// The leftmost count pixels of a tile row
+uint32_t leftPixels(int count)
+{
+    return count == 0 ? 0u : ~uint32_t{0} << (OcclusionRasteriser::tileWidth - count);
+}
+
+// A closed box with its faces wound counter-clockwise seen from outside, as occluders must be
+OccluderMesh boxOccluder(const glm::vec3& min, const glm::vec3& max)
+{
+    auto occluder = OccluderMesh{};
+    for (auto i = 0; i < 8; ++i)
+    {
+        occluder.positions.push_back({(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z});
+    }
+
+    occluder.indices = {
+        0, 4, 6, 0, 6, 2,  // -x
+        1, 3, 7, 1, 7, 5,  // +x
+        0, 1, 5, 0, 5, 4,  // -y
+        2, 6, 7, 2, 7, 3,  // +y
+        0, 2, 3, 0, 3, 1,  // -z
+        4, 5, 7, 4, 7, 6   // +z
+    };
+    return occluder;
+}
+
+// A camera at the origin looking down -z, at a 4x4 wall 10 units away filled into the buffer
+OcclusionRasteriser wallRasteriser()
+{
+    const auto projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+    const auto view = glm::lookAt(glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+
+    auto rasteriser = OcclusionRasteriser{256, 128};
+    rasteriser.begin(projection * view);
+    rasteriser.addOccluder(boxOccluder({-2.0f, -2.0f, -11.0f}, {2.0f, 2.0f, -10.0f}), glm::mat4{1.0f});
+    rasteriser.rasteriseTileRows(0, rasteriser.tileRowCount());
+    return rasteriser;
+}
+
+TEST_CASE(triangleCoversPixelCentresInsideItsEdges)
+{
+    // An identity view projection maps x and y in [-1, 1] straight across the 64x8 screen
+    auto rasteriser = OcclusionRasteriser{64, 8};
+    rasteriser.begin(glm::mat4{1.0f});
+
+    // Screen corners (0, 0), (32, 0) and (0, 8), so row y keeps the pixels whose centres are left of 32 - 4 * (y + 0.5)
+    auto triangle = OccluderMesh{};
+    triangle.positions = {{-1.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}};
+    triangle.indices = {0, 1, 2};
+    rasteriser.addOccluder(triangle, glm::mat4{1.0f});
+    CHECK(rasteriser.triangleCount() == 1);
+
+    rasteriser.rasteriseTileRows(0, rasteriser.tileRowCount());
+
+    const auto& bottom = rasteriser.tile(0, 0);
+    CHECK(bottom.coverage[0] == leftPixels(30));
+    CHECK(bottom.coverage[1] == leftPixels(26));
+    CHECK(bottom.coverage[2] == leftPixels(22));
+    CHECK(bottom.coverage[3] == leftPixels(18));
+    CHECK(bottom.workingDepth == 0.5f);
+
+    const auto& top = rasteriser.tile(0, 1);
+    CHECK(top.coverage[0] == leftPixels(14));
+    CHECK(top.coverage[1] == leftPixels(10));
+    CHECK(top.coverage[2] == leftPixels(6));
+    CHECK(top.coverage[3] == leftPixels(2));
+
+    // Nothing reaches the right hand tiles
+    for (auto row = 0; row < 2; ++row)
+    {
+        const auto& right = rasteriser.tile(1, row);
+        CHECK(right.coverage == OcclusionRasteriser::TileCoverage{});
+        CHECK(right.referenceDepth == 1.0f);
+    }
+}
+
+TEST_CASE(backFacingTrianglesAreDropped)
+{
+    auto rasteriser = OcclusionRasteriser{64, 8};
+    rasteriser.begin(glm::mat4{1.0f});
+
+    auto triangle = OccluderMesh{};
+    triangle.positions = {{-1.0f, -1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+    triangle.indices = {0, 1, 2};
+    rasteriser.addOccluder(triangle, glm::mat4{1.0f});
+
+    CHECK(rasteriser.triangleCount() == 0);
+}
+
+TEST_CASE(fullCoverageBecomesReferenceDepth)
+{
+    constexpr auto fullRow = ~uint32_t{0};
+
+    auto tile = OcclusionRasteriser::Tile{};
+    OcclusionRasteriser::mergeIntoTile(tile, {fullRow, fullRow, 0u, 0u}, 0.3f);
+    CHECK(tile.referenceDepth == 1.0f);
+    CHECK(tile.workingDepth == 0.3f);
+    CHECK(tile.coverage[0] == fullRow && tile.coverage[2] == 0u);
+
+    // Completing the tile bounds every pixel by the farthest of the merged depths
+    OcclusionRasteriser::mergeIntoTile(tile, {0u, 0u, fullRow, fullRow}, 0.35f);
+    CHECK(tile.referenceDepth == 0.35f);
+    CHECK(tile.workingDepth == 0.0f);
+    CHECK(tile.coverage == OcclusionRasteriser::TileCoverage{});
+}
+
+TEST_CASE(triangleBehindReferenceIsIgnored)
+{
+    auto tile = OcclusionRasteriser::Tile{};
+    tile.referenceDepth = 0.4f;
+
+    OcclusionRasteriser::mergeIntoTile(tile, {1u, 0u, 0u, 0u}, 0.5f);
+    CHECK(tile.referenceDepth == 0.4f);
+    CHECK(tile.workingDepth == 0.0f);
+    CHECK(tile.coverage == OcclusionRasteriser::TileCoverage{});
+}
+
+TEST_CASE(distantTriangleRestartsWorkingLayer)
+{
+    auto tile = OcclusionRasteriser::Tile{};
+    OcclusionRasteriser::mergeIntoTile(tile, {0xffff0000u, 0u, 0u, 0u}, 0.2f);
+
+    // Far nearer the reference than the working depth, so keeping both would loosen the layer too much
+    OcclusionRasteriser::mergeIntoTile(tile, {0u, 0x0000ffffu, 0u, 0u}, 0.9f);
+    CHECK(tile.workingDepth == 0.9f);
+    CHECK(tile.coverage[0] == 0u);
+    CHECK(tile.coverage[1] == 0x0000ffffu);
+    CHECK(tile.referenceDepth == 1.0f);
+}
+
+TEST_CASE(boxBehindOccluderIsHidden)
+{
+    const auto rasteriser = wallRasteriser();
+    CHECK(!rasteriser.isVisible(Box{{-1.0f, -1.0f, -30.0f}, {1.0f, 1.0f, -28.0f}}));
+}
+
+TEST_CASE(boxPeekingPastOccluderIsVisible)
+{
+    const auto rasteriser = wallRasteriser();
+    CHECK(rasteriser.isVisible(Box{{-1.0f, -1.0f, -30.0f}, {10.0f, 1.0f, -28.0f}}));
+}
+
+TEST_CASE(boxInFrontOfOccluderIsVisible)
+{
+    const auto rasteriser = wallRasteriser();
+    CHECK(rasteriser.isVisible(Box{{-1.0f, -1.0f, -6.0f}, {1.0f, 1.0f, -5.0f}}));
+}
+
+TEST_CASE(boxCrossingNearPlaneIsVisible)
+{
+    const auto rasteriser = wallRasteriser();
+    CHECK(rasteriser.isVisible(Box{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}));
+}
+
+TEST_CASE(boxOffScreenIsHidden)
+{
+    const auto rasteriser = wallRasteriser();
+    CHECK(!rasteriser.isVisible(Box{{100.0f, -1.0f, -30.0f}, {102.0f, 1.0f, -28.0f}}));
+}
+
+TEST_CASE(emptyBufferHidesNothing)
+{
+    auto rasteriser = OcclusionRasteriser{256, 128};
+    rasteriser.begin(glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f));
+    rasteriser.rasteriseTileRows(0, rasteriser.tileRowCount());
+    CHECK(rasteriser.isVisible(Box{{-1.0f, -1.0f, -30.0f}, {1.0f, 1.0f, -28.0f}}));
+}
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include "rendering/RenderGraph.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Passes that do nothing, the tests only care about the order the graph puts them in
+void noExecute(const RenderGraph&)
+{
+}
+
+RenderGraphTextureDesc testTextureDesc()
+{
+    return {GL_RGBA8, 4, 4, GL_NEAREST};
+}
+
+TEST_CASE(readerRunsBeforeLaterModification)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    graph.addPass("Draw", [](RenderGraphBuilder& builder) { builder.create("color", testTextureDesc()); }, noExecute);
+    graph.addPass("Sample", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.write("target");
+    }, noExecute);
+    graph.addPass("Modify", [](RenderGraphBuilder& builder) { builder.write("color"); }, noExecute);
+    graph.addPass("Consume", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.write("target");
+    }, noExecute);
+
+    graph.schedule();
+
+    // Sample must see the colour before Modify touches it, Consume after
+    CHECK((graph.executionOrder() == std::vector<std::string>{"Draw", "Sample", "Modify", "Consume"}));
+}
+
+TEST_CASE(readThenModifyBothResourcesHasNoCycle)
+{
+    // The shape of the lighting passes: one pass reads depth and creates the colour,
+    // the next modifies both
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    graph.addPass("Depth", [](RenderGraphBuilder& builder) { builder.create("depth", testTextureDesc()); }, noExecute);
+    graph.addPass("Shade", [](RenderGraphBuilder& builder) {
+        builder.read("depth");
+        builder.create("color", testTextureDesc());
+    }, noExecute);
+    graph.addPass("Volumes", [](RenderGraphBuilder& builder) {
+        builder.write("depth");
+        builder.write("color");
+    }, noExecute);
+    graph.addPass("Present", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.write("target");
+    }, noExecute);
+
+    graph.schedule();
+
+    CHECK((graph.executionOrder() == std::vector<std::string>{"Depth", "Shade", "Volumes", "Present"}));
+}
+
+TEST_CASE(readDeclaredBeforeCreatorSeesCreatedVersion)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    graph.addPass("Present", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.write("target");
+    }, noExecute);
+    graph.addPass("Draw", [](RenderGraphBuilder& builder) { builder.create("color", testTextureDesc()); }, noExecute);
+
+    graph.schedule();
+
+    CHECK((graph.executionOrder() == std::vector<std::string>{"Draw", "Present"}));
+}
+
+TEST_CASE(passWithUnreadResultsIsCulled)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    graph.addPass("Draw", [](RenderGraphBuilder& builder) { builder.create("color", testTextureDesc()); }, noExecute);
+    graph.addPass("Unused", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.create("scratch", testTextureDesc());
+    }, noExecute);
+    graph.addPass("Present", [](RenderGraphBuilder& builder) {
+        builder.read("color");
+        builder.write("target");
+    }, noExecute);
+
+    graph.schedule();
+
+    CHECK((graph.executionOrder() == std::vector<std::string>{"Draw", "Present"}));
+}
+
+TEST_CASE(dependencyCycleThrows)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    // Each reads what the other creates
+    graph.addPass("First", [](RenderGraphBuilder& builder) {
+        builder.read("b");
+        builder.create("a", testTextureDesc());
+        builder.write("target");
+    }, noExecute);
+    graph.addPass("Second", [](RenderGraphBuilder& builder) {
+        builder.read("a");
+        builder.create("b", testTextureDesc());
+        builder.write("target");
+    }, noExecute);
+
+    auto threw = false;
+    try
+    {
+        graph.schedule();
+    }
+    catch(const std::runtime_error&)
+    {
+        threw = true;
+    }
+
+    CHECK(threw);
+}
+
+// Draw creates the resource, Sample reads it into the output and ends its lifetime
+void addDrawAndSample(RenderGraph& graph, const std::string& name, const RenderGraphTextureDesc& desc)
+{
+    graph.addPass("Draw " + name, [name, desc](RenderGraphBuilder& builder) { builder.create(name, desc); }, noExecute);
+    graph.addPass("Sample " + name, [name](RenderGraphBuilder& builder) {
+        builder.read(name);
+        builder.write("target");
+    }, noExecute);
+}
+
+TEST_CASE(transientsWithDisjointLifetimesShareASlot)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    // Different formats of the same view class and size
+    addDrawAndSample(graph, "first", {GL_RGBA8, 4, 4, GL_LINEAR});
+    addDrawAndSample(graph, "second", {GL_RG16, 4, 4, GL_NEAREST});
+
+    graph.schedule();
+
+    CHECK((graph.executionOrder() == std::vector<std::string>{"Draw first", "Sample first", "Draw second", "Sample second"}));
+    CHECK(graph.transientSlot("first") >= 0);
+    CHECK(graph.transientSlot("first") == graph.transientSlot("second"));
+    CHECK(graph.transientSlot("target") == -1);
+}
+
+TEST_CASE(transientsWithOverlappingLifetimesGetTheirOwnSlots)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    // Shade reads the first while creating the second, so both are alive in that pass
+    graph.addPass("Draw", [](RenderGraphBuilder& builder) { builder.create("first", testTextureDesc()); }, noExecute);
+    graph.addPass("Shade", [](RenderGraphBuilder& builder) {
+        builder.read("first");
+        builder.create("second", testTextureDesc());
+    }, noExecute);
+    graph.addPass("Present", [](RenderGraphBuilder& builder) {
+        builder.read("second");
+        builder.write("target");
+    }, noExecute);
+
+    graph.schedule();
+
+    CHECK(graph.transientSlot("first") >= 0);
+    CHECK(graph.transientSlot("second") >= 0);
+    CHECK(graph.transientSlot("first") != graph.transientSlot("second"));
+}
+
+TEST_CASE(transientsOfIncompatibleFormatsOrSizesGetTheirOwnSlots)
+{
+    auto graph = RenderGraph{};
+    graph.importTexture("target", nullptr);
+    graph.markOutput("target");
+
+    addDrawAndSample(graph, "color", {GL_RGBA8, 4, 4, GL_LINEAR});
+    // Same bytes per pixel, but depth cannot be viewed as colour
+    addDrawAndSample(graph, "depth", {GL_DEPTH24_STENCIL8, 4, 4, GL_NEAREST});
+    addDrawAndSample(graph, "wider", {GL_RGBA8, 8, 4, GL_LINEAR});
+    addDrawAndSample(graph, "wide", {GL_RGBA16F, 4, 4, GL_LINEAR});
+
+    graph.schedule();
+
+    CHECK(graph.transientSlot("color") != graph.transientSlot("depth"));
+    CHECK(graph.transientSlot("color") != graph.transientSlot("wider"));
+    CHECK(graph.transientSlot("color") != graph.transientSlot("wide"));
+    CHECK(graph.transientSlot("depth") != graph.transientSlot("wider"));
+}
+
+TEST_CASE(slotsAreKeptAcrossSchedules)
+{
+    auto graph = RenderGraph{};
+    const auto build = [&graph](GLsizei width) {
+        graph.reset();
+        graph.importTexture("target", nullptr);
+        graph.markOutput("target");
+        addDrawAndSample(graph, "color", {GL_RGBA8, width, 4, GL_LINEAR});
+        graph.schedule();
+    };
+
+    build(4);
+    CHECK(graph.transientSlot("color") == 0);
+    build(4);
+    CHECK(graph.transientSlot("color") == 0);
+
+    // The slot of the old size is dropped rather than kept alongside
+    build(8);
+    CHECK(graph.transientSlot("color") == 0);
+}
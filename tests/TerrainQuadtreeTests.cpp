@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include "data/Box.h"
+#include "world/TerrainQuadtree.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// 256 intervals of one unit, so chunks go from 256 samples across at level 0 down to 32 at level 3
+constexpr auto testSampleCount = 257;
+
+struct TestChunk
+{
+    int level{0};
+    int x{0};
+    int z{0};
+};
+
+TestChunk decodeChunk(uint64_t key)
+{
+    return {static_cast<int>(key >> 48), static_cast<int>((key >> 24) & 0xffffff), static_cast<int>(key & 0xffffff)};
+}
+
+// Bounds of flat ground for every chunk the filter lets through, the rest have not streamed in yet
+class FlatGround
+{
+    public:
+        using Filter = std::function<bool(int level, int x, int z)>;
+
+        explicit FlatGround(const TerrainQuadtree& quadtree, Filter filter = {})
+            : m_quadtree{quadtree}
+            , m_filter{std::move(filter)}
+        {
+        }
+
+        const Box* bounds(int level, int x, int z)
+        {
+            m_asked.insert(TerrainQuadtree::chunkKey(level, x, z));
+            if(m_filter && !m_filter(level, x, z))
+            {
+                return nullptr;
+            }
+
+            const auto size = static_cast<float>(m_quadtree.chunkIntervals(level));
+            const auto key = TerrainQuadtree::chunkKey(level, x, z);
+            return &m_boxes.try_emplace(key, glm::vec3{x * size, 0.0f, z * size}, glm::vec3{(x + 1) * size, 0.0f, (z + 1) * size})
+                        .first->second;
+        }
+
+        bool asked(int level, int x, int z) const
+        {
+            return m_asked.contains(TerrainQuadtree::chunkKey(level, x, z));
+        }
+
+        TerrainQuadtree::ChunkBounds callback()
+        {
+            return [this](int level, int x, int z) { return bounds(level, x, z); };
+        }
+
+    private:
+        const TerrainQuadtree& m_quadtree;
+        Filter m_filter;
+        std::map<uint64_t, Box> m_boxes;
+        std::set<uint64_t> m_asked;
+};
+
+// How many selected chunks cover each cell of the finest level
+std::vector<int> finestCellCoverage(const TerrainQuadtree& quadtree)
+{
+    const auto cellsAcross = 1 << quadtree.maxLevel();
+    auto coverage = std::vector<int>(static_cast<size_t>(cellsAcross * cellsAcross), 0);
+
+    for(const auto key : quadtree.selected())
+    {
+        const auto chunk = decodeChunk(key);
+        const auto span = 1 << (quadtree.maxLevel() - chunk.level);
+        for(auto z = chunk.z * span; z < (chunk.z + 1) * span; ++z)
+        {
+            for(auto x = chunk.x * span; x < (chunk.x + 1) * span; ++x)
+            {
+                coverage[static_cast<size_t>(z * cellsAcross + x)]++;
+            }
+        }
+    }
+
+    return coverage;
+}
+
+int selectedLevelAt(const TerrainQuadtree& quadtree, int sampleX, int sampleZ)
+{
+    for(const auto key : quadtree.selected())
+    {
+        const auto chunk = decodeChunk(key);
+        const auto intervals = quadtree.chunkIntervals(chunk.level);
+        if(sampleX >= chunk.x * intervals && sampleX < (chunk.x + 1) * intervals
+           && sampleZ >= chunk.z * intervals && sampleZ < (chunk.z + 1) * intervals)
+        {
+            return chunk.level;
+        }
+    }
+
+    return -1;
+}
+
+// Sample positions of the vertices a chunk's stitched triangles use on its border
+std::set<std::pair<int, int>> usedBorderVertices(TerrainQuadtree& quadtree, const TestChunk& chunk)
+{
+    constexpr auto resolution = TerrainQuadtree::chunkResolution;
+    const auto intervals = quadtree.chunkIntervals(chunk.level);
+    const auto step = intervals / resolution;
+
+    auto used = std::set<std::pair<int, int>>{};
+    for(const auto index : quadtree.stitchedIndices(quadtree.stitch(chunk.level, chunk.x, chunk.z)))
+    {
+        const auto i = static_cast<int>(index) % (resolution + 1);
+        const auto j = static_cast<int>(index) / (resolution + 1);
+        if(i == 0 || j == 0 || i == resolution || j == resolution)
+        {
+            used.insert({chunk.x * intervals + i * step, chunk.z * intervals + j * step});
+        }
+    }
+
+    return used;
+}
+
+// Both sides of every edge two selected chunks share use the same vertices along it. A vertex one side
+// has and the other does not is a T-junction, where the heights of the two sides can part
+void checkEdgesMatch(TerrainQuadtree& quadtree)
+{
+    auto chunks = std::vector<TestChunk>{};
+    auto borders = std::vector<std::set<std::pair<int, int>>>{};
+    for(const auto key : quadtree.selected())
+    {
+        chunks.push_back(decodeChunk(key));
+        borders.push_back(usedBorderVertices(quadtree, chunks.back()));
+    }
+
+    auto sharedEdges = 0;
+    for(size_t a = 0; a < chunks.size(); ++a)
+    {
+        for(size_t b = 0; b < chunks.size(); ++b)
+        {
+            const auto sizeA = quadtree.chunkIntervals(chunks[a].level);
+            const auto sizeB = quadtree.chunkIntervals(chunks[b].level);
+            const auto minA = std::pair{chunks[a].x * sizeA, chunks[a].z * sizeA};
+            const auto minB = std::pair{chunks[b].x * sizeB, chunks[b].z * sizeB};
+
+            // A's east edge against B's west edge, then A's south edge against B's north edge
+            for(auto axis = 0; axis < 2; ++axis)
+            {
+                const auto lineA = (axis == 0 ? minA.first : minA.second) + sizeA;
+                const auto lineB = axis == 0 ? minB.first : minB.second;
+                const auto alongA = axis == 0 ? minA.second : minA.first;
+                const auto alongB = axis == 0 ? minB.second : minB.first;
+                const auto first = std::max(alongA, alongB);
+                const auto last = std::min(alongA + sizeA, alongB + sizeB);
+                if(lineA != lineB || first >= last)
+                {
+                    continue;
+                }
+
+                const auto onEdge = [&](const std::set<std::pair<int, int>>& vertices) {
+                    auto result = std::set<int>{};
+                    for(const auto& [x, z] : vertices)
+                    {
+                        const auto line = axis == 0 ? x : z;
+                        const auto along = axis == 0 ? z : x;
+                        if(line == lineA && along >= first && along <= last)
+                        {
+                            result.insert(along);
+                        }
+                    }
+                    return result;
+                };
+
+                sharedEdges++;
+                CHECK(onEdge(borders[a]) == onEdge(borders[b]));
+            }
+        }
+    }
+
+    CHECK(sharedEdges > 0);
+}
+
+TEST_CASE(maxLevelDrawsEverySample)
+{
+    const auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+
+    CHECK(quadtree.maxLevel() == 3);
+    CHECK(quadtree.chunkIntervals(quadtree.maxLevel()) == TerrainQuadtree::chunkResolution);
+}
+
+TEST_CASE(selectionCoversTheTerrainOnceAndRefinesNearTheCamera)
+{
+    auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+    auto ground = FlatGround{quadtree};
+
+    quadtree.select({10.0f, 5.0f, 10.0f}, ground.callback());
+
+    const auto coverage = finestCellCoverage(quadtree);
+    CHECK(std::all_of(coverage.begin(), coverage.end(), [](int count) { return count == 1; }));
+
+    CHECK(selectedLevelAt(quadtree, 10, 10) == quadtree.maxLevel());
+    CHECK(selectedLevelAt(quadtree, 250, 250) < quadtree.maxLevel());
+}
+
+TEST_CASE(chunkIsDrawnUntilAllItsChildrenAreIn)
+{
+    auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+
+    // One child of the root still streaming
+    auto ground = FlatGround{quadtree, [](int level, int x, int z) { return !(level == 1 && x == 1 && z == 1); }};
+
+    quadtree.select({10.0f, 5.0f, 10.0f}, ground.callback());
+
+    CHECK(quadtree.selected() == std::vector<uint64_t>{TerrainQuadtree::chunkKey(0, 0, 0)});
+
+    // All four were asked for, so they stream in together
+    CHECK(ground.asked(1, 0, 0) && ground.asked(1, 1, 0) && ground.asked(1, 0, 1) && ground.asked(1, 1, 1));
+}
+
+TEST_CASE(stitchedEdgesMatchTheirNeighbours)
+{
+    auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+    auto ground = FlatGround{quadtree};
+
+    quadtree.select({10.0f, 5.0f, 10.0f}, ground.callback());
+
+    // The camera's corner is finer than the far one, so some edges need stitching
+    auto levels = std::set<int>{};
+    for(const auto key : quadtree.selected())
+    {
+        levels.insert(decodeChunk(key).level);
+    }
+    CHECK(levels.size() > 1);
+
+    checkEdgesMatch(quadtree);
+}
+
+TEST_CASE(stitchedEdgesMatchNeighboursTwoLevelsCoarser)
+{
+    auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+
+    // Only the level 1 chunk at the camera's corner can split, the others stay two levels coarser
+    // than the finest chunks along their edges
+    auto ground = FlatGround{quadtree, [](int level, int x, int z) { return level != 2 || (x < 2 && z < 2); }};
+
+    quadtree.select({10.0f, 5.0f, 10.0f}, ground.callback());
+
+    CHECK(selectedLevelAt(quadtree, 120, 10) == 3);
+    CHECK(selectedLevelAt(quadtree, 130, 10) == 1);
+    CHECK(quadtree.stitch(3, 3, 0) == 2u << 4);
+
+    checkEdgesMatch(quadtree);
+}
+
+TEST_CASE(unstitchedChunkUsesEveryVertexOnce)
+{
+    auto quadtree = TerrainQuadtree{testSampleCount, 1.0f};
+    const auto& indices = quadtree.stitchedIndices(0);
+
+    constexpr auto resolution = TerrainQuadtree::chunkResolution;
+    CHECK(indices.size() == static_cast<size_t>(resolution * resolution * 6));
+
+    auto used = std::set<GLuint>(indices.begin(), indices.end());
+    CHECK(used.size() == static_cast<size_t>((resolution + 1) * (resolution + 1)));
+}
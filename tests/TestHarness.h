@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <vector>
+
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& testCases();
+void reportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, void (*run)())
+    {
+        testCases().push_back({name, run});
+    }
+};
+
+// Defines a test function and registers it with the suite's main, which runs every test in the executable
+#define TEST_CASE(name) \
+    void name(); \
+    const auto name##Registration = TestRegistration{#name, name}; \
+    void name()
+
+// Records a failure and carries on, so one run reports everything that is wrong
+#define CHECK(expression) \
+    do \
+    { \
+        if(!(expression)) \
+        { \
+            reportFailure(__FILE__, __LINE__, #expression); \
+        } \
+    } while(false)
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "TestHarness.h"
+
+#include <exception>
+#include <iostream>
+
+int failureCount = 0;
+
+std::vector<TestCase>& testCases()
+{
+    static auto cases = std::vector<TestCase>{};
+    return cases;
+}
+
+void reportFailure(const char* file, int line, const char* expression)
+{
+    std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed\n";
+    ++failureCount;
+}
+
+int main(int /* argc */, char** /* argv */)
+{
+    for(const auto& test : testCases())
+    {
+        const auto failuresBefore = failureCount;
+        try
+        {
+            test.run();
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << test.name << " threw: " << e.what() << "\n";
+            ++failureCount;
+        }
+
+        std::cout << (failureCount == failuresBefore ? "[pass] " : "[FAIL] ") << test.name << "\n";
+    }
+
+    return failureCount == 0 ? 0 : 1;
+}